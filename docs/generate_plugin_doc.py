@@ -88,6 +88,7 @@ INTEGRATOR_ORDERING = [
     'aov',
     'volpath',
     'volpathmis',
+    'sppm',
     '../src/python/python/ad/integrators/prb.py',
     '../src/python/python/ad/integrators/prb_basic.py',
     '../src/python/python/ad/integrators/direct_reparam.py',
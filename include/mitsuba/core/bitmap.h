@@ -85,11 +85,12 @@ public:
          *   <li>Loading and saving of spectral bitmaps</li>
          *   <li>Loading and saving of XYZ tristimulus bitmaps</li>
          *   <li>Loading and saving of string-valued metadata fields</li>
+         *   <li>Loading and saving of multi-part, tiled, and mip-mapped
+         *   images, and loading of image regions (see \ref EXRRegion)</li>
          * </ul>
          *
          * The following is <em>not</em> supported:
          * <ul>
-         *   <li>Saving of tiled images, tile-based read access</li>
          *   <li>Display windows that are different than the data window</li>
          *   <li>Loading of spectrum-valued bitmaps</li>
          * </ul>
@@ -179,6 +180,29 @@ public:
         Unpremultiply
     };
 
+    /**
+     * \brief Subset of an OpenEXR file that should be loaded
+     *
+     * Only the parts of the file overlapping the requested region are
+     * decoded, which is especially efficient for tiled files (see \ref
+     * write_exr()). By default, the entire first part is loaded.
+     */
+    struct EXRRegion {
+        /// Index of the part (in multi-part files)
+        uint32_t part = 0;
+
+        /// Mip-map level (in tiled and mip-mapped files), 0 is the full resolution
+        uint32_t level = 0;
+
+        /// Offset of the window to be loaded, relative to the data window
+        Vector2u offset = 0;
+
+        /// Size of the window to be loaded, zero extends it to the data window
+        Vector2u size = 0;
+
+        /// Channels to be loaded (all channels when empty)
+        std::vector<std::string> channels;
+    };
 
     // ======================================================================
     //! @{ \name Constructors
@@ -241,6 +265,17 @@ public:
      */
     Bitmap(const fs::path &path, FileFormat = FileFormat::Auto);
 
+    /**
+     * \brief Load a region of an OpenEXR file from a stream
+     *
+     * In contrast to the other constructors, only the specified window,
+     * channels, part, and mip-map level of the file are decoded.
+     */
+    Bitmap(Stream *stream, const EXRRegion &region);
+
+    /// Load a region of an OpenEXR file from the given filename
+    Bitmap(const fs::path &path, const EXRRegion &region);
+
     /// Copy constructor (copies the image contents)
     Bitmap(const Bitmap &bitmap);
 
@@ -388,6 +423,39 @@ public:
     void write_async(const fs::path &path, FileFormat format = FileFormat::Auto,
                      int quality = -1) const;
 
+    /**
+     * \brief Write a multi-part, tiled, and/or mip-mapped OpenEXR file
+     *
+     * \param stream
+     *    Target stream that will receive the encoded output
+     *
+     * \param parts
+     *    Names and contents of the parts of the file (e.g. the output of
+     *    \ref split()). Empty names are replaced by <tt>part<i></tt>.
+     *
+     * \param tile_size
+     *    When nonzero, the parts are stored as square tiles of this size
+     *    instead of scanlines, which makes region reads efficient (see \ref
+     *    EXRRegion).
+     *
+     * \param mipmap
+     *    Additionally store a mip-map pyramid, whose levels are computed using
+     *    a box filter (requires tiles and floating point data)
+     *
+     * \param quality
+     *    Compression quality, see \ref write()
+     */
+    static void write_exr(Stream *stream,
+                          const std::vector<std::pair<std::string, ref<Bitmap>>> &parts,
+                          uint32_t tile_size = 0, bool mipmap = false,
+                          int quality = -1);
+
+    /// Write a multi-part, tiled, and/or mip-mapped OpenEXR file to the given path
+    static void write_exr(const fs::path &path,
+                          const std::vector<std::pair<std::string, ref<Bitmap>>> &parts,
+                          uint32_t tile_size = 0, bool mipmap = false,
+                          int quality = -1);
+
     /**
      * \brief Up- or down-sample this image to a different resolution
      *
@@ -601,8 +669,8 @@ public:
      /// Read a file from a stream
      void read(Stream *stream, FileFormat format);
 
-     /// Read a file encoded using the OpenEXR file format
-     void read_exr(Stream *stream);
+     /// Read (a region of) a file encoded using the OpenEXR file format
+     void read_exr(Stream *stream, const EXRRegion &region);
 
      /// Write a file using the OpenEXR file format
      void write_exr(Stream *stream, int compression = -1) const;
@@ -654,6 +722,76 @@ public:
      Properties m_metadata;
 };
 
+/**
+ * \brief Incrementally writes the tiles of an OpenEXR file
+ *
+ * This class streams images that are too large to be held in memory to disk.
+ * The tiles can be written in arbitrary order as soon as their contents are
+ * available, and only the tile being written needs to be kept in memory.
+ * The file is complete once \ref close() is called or the writer is
+ * destroyed; tiles that were never written are left blank.
+ */
+class MI_EXPORT_LIB TiledEXRWriter : public Object {
+public:
+    using Vector2u = Bitmap::Vector2u;
+
+    /**
+     * \brief Create a new tiled OpenEXR file
+     *
+     * \param path
+     *    Target file path on disk
+     *
+     * \param layout
+     *    Bitmap whose pixel format, channels, component format and metadata
+     *    are used for the output file. Its size and contents are ignored.
+     *
+     * \param size
+     *    Resolution of the output image
+     *
+     * \param tile_size
+     *    Width and height of the (square) tiles
+     *
+     * \param quality
+     *    Compression quality, see \ref Bitmap::write()
+     */
+    TiledEXRWriter(const fs::path &path, const Bitmap *layout,
+                   const Vector2u &size, uint32_t tile_size,
+                   int quality = -1);
+
+    /**
+     * \brief Write the tile with the given integer coordinates
+     *
+     * The bitmap must match the layout specified to the constructor, and its
+     * size must equal the tile size (clipped at the image boundary). Every
+     * tile can only be written once. This function is thread-safe.
+     */
+    void write_tile(const Vector2u &tile, const Bitmap *bitmap);
+
+    /// Return the number of tiles along each axis
+    Vector2u tile_count() const;
+
+    /// Return the width and height of the tiles
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /// Return the resolution of the output image
+    const Vector2u &size() const { return m_size; }
+
+    /// Finish writing the file (called automatically by the destructor)
+    void close();
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~TiledEXRWriter();
+
+private:
+    struct TiledEXRWriterPrivate;
+    Vector2u m_size;
+    uint32_t m_tile_size;
+    std::unique_ptr<TiledEXRWriterPrivate> d;
+};
+
 
 /**
  * \brief Accumulate the contents of a source bitmap into a
@@ -203,14 +203,37 @@ public:                                             \
 
 
 /// Instantiate and export a Mitsuba plugin
+#if defined(MI_STATIC_PLUGIN_NAME)
+/* Plugins linked into the Mitsuba library (MI_STATIC_PLUGINS build option)
+   register themselves under their file name instead of exporting symbols */
+#define MI_EXPORT_PLUGIN(Name, Descr)                                                             \
+    [[maybe_unused]] static bool plugin_registered =                                               \
+        ::mitsuba::detail::register_static_plugin(MI_STATIC_PLUGIN_NAME, #Name, Descr);            \
+    MI_INSTANTIATE_CLASS(Name)
+#else
 #define MI_EXPORT_PLUGIN(Name, Descr)                                                             \
     extern "C" {                                                                                   \
         MI_EXPORT const char *plugin_name() { return #Name; }                                     \
         MI_EXPORT const char *plugin_descr() { return Descr; }                                    \
     }                                                                                              \
     MI_INSTANTIATE_CLASS(Name)
+#endif
 
 NAMESPACE_BEGIN(detail)
+/**
+ * \brief Register a plugin that is linked into the Mitsuba library, so that
+ * the \ref PluginManager finds it without loading a shared library
+ *
+ * \param name
+ *     Name of the plugin (i.e. its file name, e.g. \c "diffuse")
+ *
+ * \param class_name
+ *     Name of the class implementing the plugin
+ */
+extern MI_EXPORT_LIB bool register_static_plugin(const char *name,
+                                                  const char *class_name,
+                                                  const char *descr);
+
 template <typename, typename Arg, typename = void>
 struct is_constructible : std::false_type { };
 
@@ -16,11 +16,19 @@ NAMESPACE_BEGIN(mitsuba)
  * probability mass functions (PMFs) will automatically be normalized during
  * initialization. The associated scale factor can be retrieved using the
  * function \ref normalization().
+ *
+ * By default, sampling performs a binary search over the cumulative
+ * distribution function, which requires a logarithmic number of dependent
+ * memory accesses. Callers that sample large distributions frequently can
+ * instead opt into an alias table (Walker/Vose) that samples in constant time
+ * using two gathers. Both modes expose the same interface and sample the same
+ * distribution, though they map a given uniform variate to different indices.
  */
 template <typename Value> struct DiscreteDistribution {
     using Float = std::conditional_t<dr::is_static_array_v<Value>,
                                      dr::value_t<Value>, Value>;
     using FloatStorage   = DynamicBuffer<Float>;
+    using UInt32Storage  = DynamicBuffer<dr::uint32_array_t<Float>>;
     using Index          = dr::uint32_array_t<Value>;
     using Mask           = dr::mask_t<Value>;
 
@@ -31,21 +39,27 @@ public:
     /// Create an uninitialized DiscreteDistribution instance
     DiscreteDistribution() { }
 
-    /// Initialize from a given probability mass function
-    DiscreteDistribution(const FloatStorage &pmf)
-        : m_pmf(pmf) {
+    /**
+     * \brief Initialize from a given probability mass function
+     *
+     * When \c alias is set to \c true, an alias table is additionally built
+     * and used for sampling.
+     */
+    DiscreteDistribution(const FloatStorage &pmf, bool alias = false)
+        : m_pmf(pmf), m_alias(alias) {
         update();
     }
 
     /// Initialize from a given probability mass function (rvalue version)
-    DiscreteDistribution(FloatStorage &&pmf)
-        : m_pmf(std::move(pmf)) {
+    DiscreteDistribution(FloatStorage &&pmf, bool alias = false)
+        : m_pmf(std::move(pmf)), m_alias(alias) {
         update();
     }
 
     /// Initialize from a given floating point array
-    DiscreteDistribution(const ScalarFloat *values, size_t size)
-        : m_pmf(dr::load<FloatStorage>(values, size)) {
+    DiscreteDistribution(const ScalarFloat *values, size_t size,
+                         bool alias = false)
+        : m_pmf(dr::load<FloatStorage>(values, size)), m_alias(alias) {
         compute_cdf(values, size);
     }
 
@@ -72,6 +86,9 @@ public:
     /// Return the unnormalized cumulative distribution function (const version)
     const FloatStorage &cdf() const { return m_cdf; }
 
+    /// Does this distribution sample using an alias table?
+    bool alias() const { return m_alias; }
+
     /// \brief Return the original sum of PMF entries before normalization
     Float sum() const { return m_sum; }
 
@@ -117,6 +134,9 @@ public:
     Index sample(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias)
+            return sample_alias(value, active).first;
+
         value *= m_sum;
 
         return dr::binary_search<Index>(
@@ -167,6 +187,9 @@ public:
     sample_reuse(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias)
+            return sample_alias(value, active);
+
         Index index = sample(value, active);
 
         Value pmf = eval_pmf_normalized(index, active),
@@ -196,6 +219,11 @@ public:
     sample_reuse_pmf(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias) {
+            auto [index, value_re] = sample_alias(value, active);
+            return { index, value_re, eval_pmf_normalized(index, active) };
+        }
+
         auto [index, pdf] = sample_pmf(value, active);
 
         Value pmf = eval_pmf_normalized(index, active),
@@ -209,10 +237,76 @@ public:
     }
 
 private:
+    /**
+     * \brief Sample the alias table
+     *
+     * The sample selects a table entry and the fractional remainder decides
+     * between the entry and its alias, after which it is re-scaled so that
+     * it can be reused as a uniform variate.
+     */
+    std::pair<Index, Value> sample_alias(Value value, Mask active) const {
+        uint32_t size = (uint32_t) m_pmf.size();
+
+        value = dr::clamp(value, 0.f, 1.f) * (ScalarFloat) size;
+        Index entry = dr::minimum(Index(value), size - 1u);
+        value = dr::minimum(value - Value(entry),
+                            dr::OneMinusEpsilon<ScalarFloat>);
+
+        Value prob  = dr::gather<Value>(m_alias_prob, entry, active);
+        Index alias = dr::gather<Index>(m_alias_index, entry, active);
+
+        Mask keep = value < prob;
+        return {
+            dr::select(keep, entry, alias),
+            dr::select(keep, value / prob, (value - prob) / (1.f - prob))
+        };
+    }
+
+    /// Build the alias table using Vose's O(n) algorithm
+    void compute_alias(const ScalarFloat *pmf, size_t size, double sum) {
+        std::vector<double> scaled(size);
+        std::vector<uint32_t> small, large;
+        std::vector<ScalarFloat> prob(size);
+        std::vector<uint32_t> alias(size);
+
+        double scale = (double) size / sum;
+        for (uint32_t i = 0; i < size; ++i) {
+            scaled[i] = (double) pmf[i] * scale;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            large.pop_back();
+
+            prob[s]  = (ScalarFloat) scaled[s];
+            alias[s] = l;
+
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            (scaled[l] < 1.0 ? small : large).push_back(l);
+        }
+
+        // Remaining entries are (up to round-off) exactly full
+        for (uint32_t i : large) {
+            prob[i] = 1.f;
+            alias[i] = i;
+        }
+        for (uint32_t i : small) {
+            prob[i] = 1.f;
+            alias[i] = i;
+        }
+
+        m_alias_prob  = dr::load<FloatStorage>(prob.data(), size);
+        m_alias_index = dr::load<UInt32Storage>(alias.data(), size);
+    }
+
     void compute_cdf(const ScalarFloat *pmf, size_t size) {
         if (size == 0)
             Throw("DiscreteDistribution: empty distribution!");
 
+        const ScalarFloat *pmf_start = pmf;
+
         std::vector<ScalarFloat> cdf(size);
         m_valid = (uint32_t) -1;
 
@@ -238,14 +332,20 @@ private:
         m_sum = dr::opaque<Float>(sum);
         m_normalization = dr::opaque<Float>(1.0 / sum);
         m_cdf = dr::load<FloatStorage>(cdf.data(), size);
+
+        if (m_alias)
+            compute_alias(pmf_start, size, sum);
     }
 
 private:
     FloatStorage m_pmf;
     FloatStorage m_cdf;
+    FloatStorage m_alias_prob;
+    UInt32Storage m_alias_index;
     Float m_sum = 0.f;
     Float m_normalization = 0.f;
     ScalarVector2u m_valid;
+    bool m_alias = false;
 };
 
 /**
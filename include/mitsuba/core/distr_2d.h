@@ -3,8 +3,13 @@
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
 #include <drjit/dynamic.h>
+#include <drjit/half.h>
+#include <nanothread/nanothread.h>
 #include <array>
 
+/// Approximate number of array entries processed per parallel work unit
+#define MI_DISTR_2D_GRAIN_SIZE 16384u
+
 NAMESPACE_BEGIN(mitsuba)
 
 /** =======================================================================
@@ -278,6 +283,24 @@ protected:
         }
     }
 
+    /**
+     * \brief Invoke \c func(y) for every row <tt>y < rows</tt> of an array
+     * with \c width entries per row, distributing the work over the thread pool
+     */
+    template <typename Func>
+    static void parallel_rows(uint32_t rows, uint32_t width, Func &&func) {
+        uint32_t grain_size =
+            std::max(1u, MI_DISTR_2D_GRAIN_SIZE / std::max(width, 1u));
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0u, rows, grain_size),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t y = range.begin(); y != range.end(); ++y)
+                    func(y);
+            }
+        );
+    }
+
 protected:
 #if !defined(_MSC_VER)
     static constexpr size_t DimensionInt = Dimension;
@@ -363,14 +386,34 @@ public:
      * in ``eval()`` is used). In this case, ``sample()`` and ``invert()``
      * can still be called without triggering undefined behavior, but they
      * will not return meaningful results.
+     *
+     * If \c half_precision is set to \c true, the MIP hierarchy is stored
+     * using 16-bit floating point values, which halves its memory footprint
+     * (the hierarchy accounts for more than half of the total storage
+     * cost). The quantization slightly perturbs
+     * how closely samples follow the input data (the relative error of each
+     * hierarchy entry is bounded by 2^-11 unless it is 2^14 times smaller
+     * than the largest entry of its level), but the densities returned by
+     * ``sample()``, ``invert()``, and ``eval()`` are computed from the
+     * quantized hierarchy and thus remain exactly consistent with the
+     * generated samples. In exchange, ``eval()`` must traverse the hierarchy.
+     * This mode requires \c normalize to be set to \c true.
+     *
+     * The construction is parallelized over the rows of the input array.
      */
     Hierarchical2D(const ScalarFloat *data,
                    const ScalarVector2u &size,
                    const std::array<uint32_t, Dimension> &param_res = { },
                    const std::array<const ScalarFloat *, Dimension> &param_values = { },
                    bool normalize = true,
-                   bool enable_sampling = true)
-        : Base(size, param_res, param_values) {
+                   bool enable_sampling = true,
+                   bool half_precision = false)
+        : Base(size, param_res, param_values),
+          m_half_precision(half_precision && enable_sampling) {
+
+        if (half_precision && !normalize)
+            Throw("Hierarchical2D(): half precision storage requires a "
+                  "normalized distribution!");
 
         // The linear interpolant has 'size-1' patches
         ScalarVector2u n_patches = size - 1;
@@ -390,14 +433,26 @@ public:
 
                 ScalarFloat scale = 1.f;
                 if (normalize) {
+                    std::unique_ptr<double[]> row_sum(new double[size.y()]);
+                    Base::parallel_rows(size.y(), size.x(), [&](uint32_t y) {
+                        const ScalarFloat *in = data + offset + y * size.x();
+                        double sum = 0.0;
+                        for (uint32_t x = 0; x < size.x(); ++x)
+                            sum += (double) in[x];
+                        row_sum[y] = sum;
+                    });
+
                     double sum = 0.0;
-                    for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                        sum += (double) data[offset + i];
+                    for (uint32_t y = 0; y < size.y(); ++y)
+                        sum += row_sum[y];
                     scale = dr::prod(n_patches) / (ScalarFloat) sum;
                 }
 
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    p[offset + i] = data[offset + i] * scale;
+                Base::parallel_rows(size.y(), size.x(), [&](uint32_t y) {
+                    uint32_t i = offset + y * size.x();
+                    for (uint32_t x = 0; x < size.x(); ++x, ++i)
+                        p[i] = data[i] * scale;
+                });
 
                 m_levels[0].ready();
             }
@@ -419,15 +474,17 @@ public:
         ScalarFloat *l0p = m_levels[0].data.data(),
                     *l1p = m_levels[1].data.data();
 
+        std::unique_ptr<double[]> row_sum(new double[n_patches.y()]);
+
         for (uint32_t slice = 0; slice < m_slices; ++slice) {
             uint32_t offset0 = m_levels[0].size * slice,
                      offset1 = m_levels[1].size * slice;
 
             // Integrate linear interpolant
-            const ScalarFloat *in = data + offset0;
+            Base::parallel_rows(n_patches.y(), n_patches.x(), [&](uint32_t y) {
+                const ScalarFloat *in = data + offset0 + y * size.x();
 
-            double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
+                double sum = 0.0;
                 for (uint32_t x = 0; x < n_patches.x(); ++x) {
                     ScalarFloat avg = .25f * (in[0] + in[1] + in[size.x()] +
                                               in[size.x() + 1]);
@@ -435,15 +492,27 @@ public:
                     *(l1p + m_levels[1].index(ScalarVector2u(x, y)) + offset1) = avg;
                     ++in;
                 }
-                ++in;
-            }
+                row_sum[y] = sum;
+            });
+
+            double sum = 0.0;
+            for (uint32_t y = 0; y < n_patches.y(); ++y)
+                sum += row_sum[y];
 
             // Copy and normalize fine resolution interpolant
             ScalarFloat scale = normalize ? (ScalarFloat) (dr::prod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                l0p[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                l1p[offset1 + i] *= scale;
+            Base::parallel_rows(size.y(), size.x(), [&](uint32_t y) {
+                uint32_t i = offset0 + y * size.x();
+                for (uint32_t x = 0; x < size.x(); ++x, ++i)
+                    l0p[i] = data[i] * scale;
+            });
+
+            uint32_t width1 = m_levels[1].width;
+            Base::parallel_rows(m_levels[1].size / width1, width1, [&](uint32_t y) {
+                ScalarFloat *p = l1p + offset1 + y * width1;
+                for (uint32_t x = 0; x < width1; ++x)
+                    p[x] *= scale;
+            });
 
             // Build a MIP hierarchy
             level_size = n_patches;
@@ -458,16 +527,21 @@ public:
                 ScalarFloat *l1p_ = l1.data.data();
 
                 // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
+                Base::parallel_rows(level_size.y(), level_size.x(), [&](uint32_t y) {
                     for (uint32_t x = 0; x < level_size.x(); ++x) {
                         ScalarFloat *d1 = l1p_ + l1.index(ScalarVector2u(x, y)) + offset1;
                         const ScalarFloat *d0 = l0p_ + l0.index(ScalarVector2u(x*2, y*2)) + offset0;
                         *d1 = d0[0] + d0[1] + d0[2] + d0[3];
                     }
-                }
+                });
             }
         }
 
+        if (m_half_precision) {
+            for (size_t i = 1; i < m_levels.size(); ++i)
+                m_levels[i].compress(m_slices);
+        }
+
         for (auto& level : m_levels)
             level.ready();
     }
@@ -492,6 +566,7 @@ public:
 
         // Hierarchical sample warping
         Point2u offset = dr::zeros<Point2u>();
+        Float prob = 1.f;
         for (int l = (int) m_levels.size() - 2; l > 0; --l) {
             const Level &level = m_levels[l];
 
@@ -535,6 +610,10 @@ public:
             dr::masked(sample.x(), mask) -= c0;
             sample.x() /= dr::select(mask, c1, c0);
             dr::masked(offset.x(), mask) += 1u;
+
+            // Track the probability of the quantized hierarchy (if needed)
+            if (m_half_precision)
+                prob *= dr::select(mask, c1, c0) / (r0 + r1);
         }
 
         const Level &level0 = m_levels[0];
@@ -559,6 +638,10 @@ public:
         std::tie(sample, pdf) =
             warp::square_to_bilinear(v00, v10, v01, v11, sample);
 
+        if (m_half_precision)
+            pdf *= prob * dr::prod(m_inv_patch_size) /
+                   (.25f * (v00 + v10 + v01 + v11));
+
         return {
             (Point2f(Point2i(offset)) + sample) * m_patch_size,
             pdf
@@ -605,6 +688,9 @@ public:
         Float pdf;
         std::tie(sample, pdf) = warp::bilinear_to_square(v00, v10, v01, v11, sample);
 
+        if (m_half_precision)
+            pdf *= dr::prod(m_inv_patch_size) / (.25f * (v00 + v10 + v01 + v11));
+
         // Hierarchical sample warping -- reverse direction
         for (int l = 1; l < (int) m_levels.size() - 1; ++l) {
             const Level &level = m_levels[l];
@@ -630,6 +716,12 @@ public:
             Mask x_mask = dr::neq(offset.x() & 1u, 0u),
                  y_mask = dr::neq(offset.y() & 1u, 0u);
 
+            // Account for the probability of the quantized hierarchy (if needed)
+            if (m_half_precision)
+                pdf *= dr::select(y_mask, dr::select(x_mask, v11, v01),
+                                          dr::select(x_mask, v10, v00)) /
+                       (v00 + v10 + v01 + v11);
+
             Float r0 = v00 + v10,
                   r1 = v01 + v11,
                   c0 = dr::select(y_mask, v01, v00),
@@ -686,7 +778,13 @@ public:
         Float v11 = level0.lookup(offset_i + level0.width + 1, m_param_strides,
                                   param_weight, active);
 
-        return warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos);
+        Float pdf = warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos);
+
+        if (m_half_precision)
+            pdf *= patch_probability(offset, slice_offset, param_weight, active) *
+                   dr::prod(m_inv_patch_size) / (.25f * (v00 + v10 + v01 + v11));
+
+        return pdf;
     }
 
     std::string to_string() const {
@@ -715,18 +813,59 @@ public:
         oss << "  storage = { " << m_slices << " slice" << (m_slices > 1 ? "s" : "")
             << ", ";
         for (size_t i = 0; i < m_levels.size(); ++i)
-            size += m_levels[i].size * m_slices;
-        oss << util::mem_string(size * sizeof(ScalarFloat)) << " }" << std::endl
+            size += m_levels[i].nbytes();
+        oss << util::mem_string(size)
+            << (m_half_precision ? " (half precision)" : "") << " }" << std::endl
             << "]";
         return oss.str();
     }
 
 protected:
+    /**
+     * \brief Compute the probability of selecting the bilinear patch at
+     * \c offset by traversing the (quantized) MIP hierarchy
+     */
+    Float patch_probability(Point2u offset, const UInt32 &slice_offset,
+                            const Float *param_weight, const Mask &active) const {
+        Float prob = 1.f;
+
+        for (int l = 1; l < (int) m_levels.size() - 1; ++l) {
+            const Level &level = m_levels[l];
+
+            UInt32 offset_i = level.index(offset & ~1u) + slice_offset * level.size;
+
+            Float v00 = level.lookup(offset_i, m_param_strides,
+                                     param_weight, active),
+                  v10 = level.lookup(offset_i + 1u, m_param_strides,
+                                     param_weight, active),
+                  v01 = level.lookup(offset_i + 2u, m_param_strides,
+                                     param_weight, active),
+                  v11 = level.lookup(offset_i + 3u, m_param_strides,
+                                     param_weight, active);
+
+            Mask x_mask = dr::neq(offset.x() & 1u, 0u),
+                 y_mask = dr::neq(offset.y() & 1u, 0u);
+
+            prob *= dr::select(y_mask, dr::select(x_mask, v11, v01),
+                                       dr::select(x_mask, v10, v00)) /
+                    (v00 + v10 + v01 + v11);
+
+            offset = dr::sr<1>(offset);
+        }
+
+        return prob;
+    }
+
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
     struct Level {
         uint32_t size;
         uint32_t width;
         FloatStorage data;
 
+        /// Pairs of 16-bit floating point values (only used in half precision mode)
+        UInt32Storage data_half;
+
         Level() { }
         Level(ScalarVector2u res, uint32_t slices)
             : size(dr::prod(res)), width(res.x()) {
@@ -743,8 +882,48 @@ protected:
         }
 
         void ready() {
-            if constexpr (dr::is_cuda_v<Float>)
-                data = dr::migrate(data, AllocType::Device);
+            if constexpr (dr::is_cuda_v<Float>) {
+                if (!data.empty())
+                    data = dr::migrate(data, AllocType::Device);
+            }
+        }
+
+        /**
+         * \brief Convert the level into a compact 16-bit representation
+         *
+         * Only ratios of entries within the same level are ever used, hence
+         * the level is first re-scaled so that its largest entry equals 1.
+         * Nonzero entries are never flushed to zero, which would prevent
+         * sampling of the associated region.
+         */
+        void compress(uint32_t slices) {
+            uint32_t n = size * slices;
+            const ScalarFloat *in = data.data();
+
+            ScalarFloat max_value = 0.f;
+            for (uint32_t i = 0; i < n; ++i)
+                max_value = dr::maximum(max_value, in[i]);
+            ScalarFloat scale = max_value > 0.f ? 1.f / max_value : 0.f;
+
+            std::unique_ptr<uint32_t[]> packed(new uint32_t[(n + 1) / 2]);
+            memset(packed.get(), 0, ((n + 1) / 2) * sizeof(uint32_t));
+
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t value = dr::half::float32_to_float16(
+                    (float) (in[i] * scale));
+                if (value == 0 && in[i] > 0.f)
+                    value = 1; // smallest denormal
+                packed[i / 2] |= value << (16 * (i & 1));
+            }
+
+            data_half = dr::load<UInt32Storage>(packed.get(), (n + 1) / 2);
+            data = FloatStorage();
+        }
+
+        /// Storage cost of this level in bytes
+        size_t nbytes() const {
+            return data.empty() ? data_half.size() * sizeof(uint32_t)
+                                : data.size() * sizeof(ScalarFloat);
         }
 
         /**
@@ -776,6 +955,18 @@ protected:
             } else {
                 DRJIT_MARK_USED(param_strides);
                 DRJIT_MARK_USED(param_weight);
+                if (!data_half.empty()) {
+                    UInt32 value = dr::gather<UInt32>(data_half, dr::sr<1>(i0), active);
+                    value = (value >> dr::sl<4>(i0 & 1u)) & 0xFFFFu;
+
+                    /* Convert a non-negative finite half precision value by
+                       moving the exponent and mantissa into place, followed
+                       by a multiplication that adjusts the exponent bias
+                       (this also correctly handles denormals) */
+                    using Float32 = dr::float32_array_t<Float>;
+                    return Float(dr::reinterpret_array<Float32>(dr::sl<13>(value)) *
+                                 0x1p112f);
+                }
                 return dr::gather<Float>(data, i0, active);
             }
         }
@@ -786,6 +977,9 @@ protected:
 
     /// Number of bilinear patches in the X/Y dimension - 1
     ScalarVector2u m_max_patch_index;
+
+    /// Is the MIP hierarchy stored in half precision?
+    bool m_half_precision = false;
 };
 
 /**
@@ -858,6 +1052,8 @@ public:
      * construct the cdf needed for sample warping, which saves memory in case
      * this functionality is not needed (e.g. if only the interpolation in
      * ``eval()`` is used).
+     *
+     * The construction is parallelized over the rows of the input array.
      */
     Marginal2D(const ScalarFloat *data,
                const ScalarVector2u &size,
@@ -881,29 +1077,30 @@ public:
             std::unique_ptr<ScalarFloat[]> marg_cdf(new ScalarFloat[m_slices * n_marg]);
             std::unique_ptr<ScalarFloat[]> cond_cdf(new ScalarFloat[m_slices * n_cond]);
 
-            ScalarFloat *marg_cdf_ptr = marg_cdf.get(),
-                        *cond_cdf_ptr = cond_cdf.get(),
-                        *data_out_ptr = data_out.get();
-
             std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
 
             for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                const ScalarFloat *data_in = data + slice * n_data;
+                ScalarFloat *marg_cdf_ptr = marg_cdf.get() + slice * n_marg,
+                            *cond_cdf_ptr = cond_cdf.get() + slice * n_cond,
+                            *data_out_ptr = data_out.get() + slice * n_data;
+
                 ScalarFloat norm = 1.f;
 
                 /* The marginal/probability distribution computation
                    differs for the Continuous=false/true cases */
                 if constexpr (Continuous) {
                     // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
+                    Base::parallel_rows(h, w, [&](uint32_t y) {
                         double accum = 0.0;
                         uint32_t i = y * w, j = y * (w - 1);
                         for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale_x * ((double) data[i] +
-                                                (double) data[i + 1]);
+                            accum += scale_x * ((double) data_in[i] +
+                                                (double) data_in[i + 1]);
                             cond_cdf_ptr[j] = (ScalarFloat) accum;
                         }
                         cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -918,18 +1115,18 @@ public:
                     double scale = scale_x * scale_y;
 
                     // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
+                    Base::parallel_rows(h - 1, w, [&](uint32_t y) {
                         double accum = 0.0;
                         uint32_t i = y * w, j = y * (w - 1);
                         for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale * ((double) data[i] +
-                                              (double) data[i + 1] +
-                                              (double) data[i + w] +
-                                              (double) data[i + w + 1]);
+                            accum += scale * ((double) data_in[i] +
+                                              (double) data_in[i + 1] +
+                                              (double) data_in[i + w] +
+                                              (double) data_in[i + w + 1]);
                             cond_cdf_ptr[j] = (ScalarFloat) accum;
                         }
                         cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -942,38 +1139,54 @@ public:
                         norm = ScalarFloat(1.0 / accum);
                 }
 
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf_ptr++ *= norm;
+                Base::parallel_rows(n_cond / (w - 1), w - 1, [&](uint32_t y) {
+                    ScalarFloat *p = cond_cdf_ptr + y * (w - 1);
+                    for (uint32_t x = 0; x < w - 1; ++x)
+                        p[x] *= norm;
+                });
                 for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf_ptr++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out_ptr++ = *data++ * norm;
+                    marg_cdf_ptr[i] *= norm;
+                Base::parallel_rows(h, w, [&](uint32_t y) {
+                    uint32_t i = y * w;
+                    for (uint32_t x = 0; x < w; ++x, ++i)
+                        data_out_ptr[i] = data_in[i] * norm;
+                });
             }
 
             m_marg_cdf = dr::load<FloatStorage>(marg_cdf.get(), m_slices * n_marg);
             m_cond_cdf = dr::load<FloatStorage>(cond_cdf.get(), m_slices * n_cond);
         } else {
-            ScalarFloat *data_out_ptr = data_out.get();
+            std::unique_ptr<double[]> row_sum(new double[h - 1]);
 
             for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                const ScalarFloat *data_in = data + slice * n_data;
+                ScalarFloat *data_out_ptr = data_out.get() + slice * n_data;
                 ScalarFloat norm = 1.f;
 
                 if (normalize) {
-                    double sum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
+                    Base::parallel_rows(h - 1, w, [&](uint32_t y) {
+                        double sum = 0.0;
                         size_t i = y * w;
                         for (uint32_t x = 0; x < w - 1; ++x, ++i) {
-                            sum += (double) data[i] +
-                                   (double) data[i + 1] +
-                                   (double) data[i + w] +
-                                   (double) data[i + w + 1];
+                            sum += (double) data_in[i] +
+                                   (double) data_in[i + 1] +
+                                   (double) data_in[i + w] +
+                                   (double) data_in[i + w + 1];
                         }
-                    }
+                        row_sum[y] = sum;
+                    });
+
+                    double sum = 0.0;
+                    for (uint32_t y = 0; y < h - 1; ++y)
+                        sum += row_sum[y];
                     norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
                 }
 
-                for (uint32_t k = 0; k < n_data; ++k)
-                    *data_out_ptr++ = *data++ * norm;
+                Base::parallel_rows(h, w, [&](uint32_t y) {
+                    uint32_t i = y * w;
+                    for (uint32_t x = 0; x < w; ++x, ++i)
+                        data_out_ptr[i] = data_in[i] * norm;
+                });
             }
         }
 
@@ -55,6 +55,16 @@ public:
      */
     static ref<MemoryMappedFile> create_temporary(size_t size);
 
+    /**
+     * \brief Map the specified file into memory using a private
+     * copy-on-write mapping
+     *
+     * The mapped region can be modified, but changes only affect the
+     * process-local copy of the touched pages and are never written back to
+     * the file. Pages that are only read are shared with the page cache.
+     */
+    static ref<MemoryMappedFile> map_private(const fs::path &filename);
+
     MI_DECLARE_CLASS()
 protected:
     /// Internal constructor
@@ -130,7 +130,7 @@ public:
         bool operator==(const Field &f) const {
             return name == f.name && type == f.type && size == f.size &&
                    offset == f.offset && flags == f.flags &&
-                   default_ == f.default_;
+                   default_ == f.default_ && blend == f.blend;
         }
 
         /// Equality operator
@@ -314,6 +314,10 @@ template <typename T> constexpr Struct::Type struct_type_v = detail::struct_type
 
 MI_DECLARE_ENUM_OPERATORS(Struct::Flags)
 
+NAMESPACE_BEGIN(detail)
+struct StructFastPath;
+NAMESPACE_END(detail)
+
 /**
  * \brief This class solves the any-to-any problem: efficiently converting from
  * one kind of structured data representation to another
@@ -362,6 +366,11 @@ MI_DECLARE_ENUM_OPERATORS(Struct::Flags)
  * function is cached and reused in case the same conversion is needed later
  * on. Note that JIT compilation only works on x86_64 processors; other
  * platforms use a slow generic fallback implementation.
+ *
+ * Frequently used conversions to single precision values (e.g. from 8-bit
+ * sRGB-encoded values, half precision values, or byte-swapped single
+ * precision values) bypass both backends and use specialized kernels that
+ * run on all platforms and are parallelized over large inputs.
  */
 class MI_EXPORT_LIB StructConverter : public Object {
     using FuncType = bool (*) (size_t, size_t, const void *, void *);
@@ -388,15 +397,8 @@ public:
      *
      * \return \c true upon success
      */
-#if MI_STRUCTCONVERTER_USE_JIT == 1
-    bool convert_2d(size_t width, size_t height, const void *src,
-                    void *dest) const {
-        return m_func(width, height, src, dest);
-    }
-#else
     bool convert_2d(size_t width, size_t height, const void *src,
                     void *dest) const;
-#endif
 
     /// Return the source \c Struct descriptor
     const Struct *source() const { return m_source.get(); }
@@ -428,11 +430,15 @@ protected:
     bool load(const uint8_t *src, const Struct::Field &f, Value &value) const;
     void linearize(Value &value) const;
     void save(uint8_t *dst, const Struct::Field &f, Value value, size_t x, size_t y) const;
+    bool convert_2d_generic(size_t width, size_t height, const void *src,
+                            void *dest) const;
 #endif
 
 protected:
     ref<const Struct> m_source;
     ref<const Struct> m_target;
+    /// Specialized conversion kernels (if applicable), owned by a global cache
+    const detail::StructFastPath *m_fast_path;
 #if MI_STRUCTCONVERTER_USE_JIT == 1
     FuncType m_func;
 #else
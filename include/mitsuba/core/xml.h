@@ -2,6 +2,7 @@
 
 #include <mitsuba/mitsuba.h>
 #include <mitsuba/core/properties.h>
+#include <memory>
 #include <string>
 
 /// Max level of nested <include> directives
@@ -13,6 +14,48 @@ NAMESPACE_BEGIN(xml)
 /// Used to pass key=value pairs to the parser
 using ParameterList = std::vector<std::tuple<std::string, std::string, bool>>;
 
+/**
+ * \brief Cache of instantiated objects shared between successive scene loads
+ *
+ * When passed to \ref load_file() or \ref load_string(), an object is only
+ * instantiated if the cache does not already contain an object of the same
+ * class with identical properties (nested objects are compared by identity).
+ * Loading a modified version of a scene thus only creates the objects whose
+ * parameters changed along with their ancestors, and reuses all others
+ * (e.g. bitmaps and meshes loaded from disk).
+ *
+ * Objects whose properties contain raw pointers are never cached. Objects
+ * loaded from a file (via a \c filename property) are instantiated again
+ * when the size or modification time of the file changed.
+ */
+class MI_EXPORT_LIB InstanceCache {
+public:
+    InstanceCache();
+    ~InstanceCache();
+
+    /// Look up an object with the given class and properties (or \c nullptr)
+    ref<Object> get(const Class *class_, const Properties &props) const;
+
+    /// Record a newly instantiated object
+    void put(const Class *class_, const Properties &props, Object *object);
+
+    /**
+     * \brief Release the objects that are no longer referenced outside of
+     * the cache, and return how many were removed
+     */
+    size_t prune();
+
+    /// Remove all entries
+    void clear();
+
+    /// Return the number of cached objects
+    size_t size() const;
+
+private:
+    struct InstanceCachePrivate;
+    std::unique_ptr<InstanceCachePrivate> d;
+};
+
 /**
  * Load a Mitsuba scene from an XML file
  *
@@ -29,20 +72,34 @@ using ParameterList = std::vector<std::tuple<std::string, std::string, bool>>;
  * \param update_scene
  *     When Mitsuba updates scene to a newer version, should the
  *     updated XML file be written back to disk?
+ *
+ * \param deduplicate
+ *     When set, anonymous (i.e. nested, without an \c id attribute)
+ *     textures, volumes, BSDFs, phase functions and media with identical
+ *     properties, including the resolved paths of referenced files, are only
+ *     instantiated once and shared. Shared objects only appear once in the
+ *     scene parameters returned by \c traverse().
+ *
+ * \param cache
+ *     Optional cache used to reuse objects created by previous loads
  */
 extern MI_EXPORT_LIB std::vector<ref<Object>> load_file(
                                         const fs::path &path,
                                         const std::string &variant,
                                         ParameterList parameters = ParameterList(),
                                         bool update_scene = false,
-                                        bool parallel = true);
+                                        bool parallel = true,
+                                        bool deduplicate = false,
+                                        InstanceCache *cache = nullptr);
 
 /// Load a Mitsuba scene from an XML string
 extern MI_EXPORT_LIB std::vector<ref<Object>> load_string(
                                         const std::string &string,
                                         const std::string &variant,
                                         ParameterList parameters = ParameterList(),
-                                        bool parallel = true);
+                                        bool parallel = true,
+                                        bool deduplicate = false,
+                                        InstanceCache *cache = nullptr);
 
 
 
@@ -52,7 +109,8 @@ extern MI_EXPORT_LIB ref<Object> create_texture_from_rgb(
                                         const std::string &name,
                                         Color<float, 3> color,
                                         const std::string &variant,
-                                        bool within_emitter);
+                                        bool within_emitter,
+                                        InstanceCache *cache = nullptr);
 
 /// Create a Texture object from a constant value or spectral values if available
 extern MI_EXPORT_LIB ref<Object> create_texture_from_spectrum(
@@ -63,7 +121,8 @@ extern MI_EXPORT_LIB ref<Object> create_texture_from_spectrum(
                                         const std::string &variant,
                                         bool within_emitter,
                                         bool is_spectral_mode,
-                                        bool is_monochromatic_mode);
+                                        bool is_monochromatic_mode,
+                                        InstanceCache *cache = nullptr);
 
 /// Expands a node (if it does not expand it is wrapped into a std::vector)
 extern MI_EXPORT_LIB std::vector<ref<Object>> expand_node(
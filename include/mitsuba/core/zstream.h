@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/stream.h>
+#include <vector>
 
 extern "C" {
     struct z_stream_s;
@@ -62,6 +63,26 @@ public:
     /// Returns the child stream of this compression stream
     Stream *child_stream() { return m_child_stream; }
 
+    /**
+     * \brief Compress a memory region into a self-contained zlib stream
+     *
+     * Unlike the streaming interface, this function does not keep any state
+     * and can be called concurrently, e.g. to compress the chunks of a large
+     * buffer in parallel.
+     */
+    static std::vector<uint8_t> compress(const void *data, size_t size,
+                                         int level = -1);
+
+    /**
+     * \brief Decompress a zlib stream created by \ref compress()
+     *
+     * Throws an exception unless the stream spans all \c data_size bytes
+     * and expands to exactly \c size bytes. Like \ref compress(), this
+     * function is thread-safe.
+     */
+    static void decompress(const void *data, size_t data_size, void *out,
+                           size_t size);
+
     //! @}
     // =========================================================================
 
@@ -880,9 +880,36 @@ Parameter ``path``:
 Parameter ``format``:
     File format to be read (PNG/EXR/Auto-detect ...))doc";
 
-static const char *__doc_mitsuba_Bitmap_Bitmap_4 = R"doc(Copy constructor (copies the image contents))doc";
+static const char *__doc_mitsuba_Bitmap_Bitmap_4 =
+R"doc(Load a region of an OpenEXR file from a stream
 
-static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Move constructor)doc";
+In contrast to the other constructors, only the specified window,
+channels, part, and mip-map level of the file are decoded.)doc";
+
+static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Load a region of an OpenEXR file from the given filename)doc";
+
+static const char *__doc_mitsuba_Bitmap_Bitmap_6 = R"doc(Copy constructor (copies the image contents))doc";
+
+static const char *__doc_mitsuba_Bitmap_Bitmap_7 = R"doc(Move constructor)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion =
+R"doc(Subset of an OpenEXR file that should be loaded
+
+Only the parts of the file overlapping the requested region are
+decoded, which is especially efficient for tiled files (see
+write_exr()). By default, the entire first part is loaded.)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion_channels = R"doc(Channels to be loaded (all channels when empty))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion_level =
+R"doc(Mip-map level (in tiled and mip-mapped files), 0 is the full
+resolution)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion_offset = R"doc(Offset of the window to be loaded, relative to the data window)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion_part = R"doc(Index of the part (in multi-part files))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRRegion_size = R"doc(Size of the window to be loaded, zero extends it to the data window)doc";
 
 static const char *__doc_mitsuba_Bitmap_FileFormat = R"doc(Supported image file formats)doc";
 
@@ -921,9 +948,10 @@ supported RGB/Luminance/Alpha combinations
 
 * Loading and saving of string-valued metadata fields
 
-The following is *not* supported:
+* Loading and saving of multi-part, tiled, and mip-mapped images, and
+loading of image regions (see EXRRegion)
 
-* Saving of tiled images, tile-based read access
+The following is *not* supported:
 
 * Display windows that are different than the data window
 
@@ -1136,7 +1164,7 @@ static const char *__doc_mitsuba_Bitmap_read = R"doc(Read a file from a stream)d
 
 static const char *__doc_mitsuba_Bitmap_read_bmp = R"doc(Read a file encoded using the BMP file format)doc";
 
-static const char *__doc_mitsuba_Bitmap_read_exr = R"doc(Read a file encoded using the OpenEXR file format)doc";
+static const char *__doc_mitsuba_Bitmap_read_exr = R"doc(Read (a region of) a file encoded using the OpenEXR file format)doc";
 
 static const char *__doc_mitsuba_Bitmap_read_jpeg = R"doc(Read a file encoded using the JPEG file format)doc";
 
@@ -1309,7 +1337,33 @@ static const char *__doc_mitsuba_Bitmap_write_async =
 R"doc(Equivalent to write(), but executes asynchronously on a different
 thread)doc";
 
-static const char *__doc_mitsuba_Bitmap_write_exr = R"doc(Write a file using the OpenEXR file format)doc";
+static const char *__doc_mitsuba_Bitmap_write_exr =
+R"doc(Write a multi-part, tiled, and/or mip-mapped OpenEXR file
+
+Parameter ``stream``:
+    Target stream that will receive the encoded output
+
+Parameter ``parts``:
+    Names and contents of the parts of the file (e.g. the output of
+    split()). Empty names are replaced by ``part<i>``.
+
+Parameter ``tile_size``:
+    When nonzero, the parts are stored as square tiles of this size
+    instead of scanlines, which makes region reads efficient (see
+    EXRRegion).
+
+Parameter ``mipmap``:
+    Additionally store a mip-map pyramid, whose levels are computed
+    using a box filter (requires tiles and floating point data)
+
+Parameter ``quality``:
+    Compression quality, see write())doc";
+
+static const char *__doc_mitsuba_Bitmap_write_exr_2 =
+R"doc(Write a multi-part, tiled, and/or mip-mapped OpenEXR file to the
+given path)doc";
+
+static const char *__doc_mitsuba_Bitmap_write_exr_3 = R"doc(Write a file using the OpenEXR file format)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_jpeg = R"doc(Save a file using the JPEG file format)doc";
 
@@ -1860,6 +1914,13 @@ choosing one of several objects (shapes, emitters, ..) on which the
 position lies. In that case, the ``object`` attribute stores a pointer
 to this object.)doc";
 
+static const char *__doc_mitsuba_DirectionSample_prim_index =
+R"doc(Optional: index of the primitive on which the sampled position lies
+(e.g. the triangle of a mesh)
+
+Shapes that sample directions in a primitive-dependent way use this
+field to evaluate the matching density in Shape::pdf_direction().)doc";
+
 static const char *__doc_mitsuba_DirectionSample_operator_array = R"doc()doc";
 
 static const char *__doc_mitsuba_DirectionSample_operator_assign = R"doc()doc";
@@ -1975,18 +2036,26 @@ static const char *__doc_mitsuba_DiscreteDistribution2D_to_string = R"doc()doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution = R"doc(Create an uninitialized DiscreteDistribution instance)doc";
 
-static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_2 = R"doc(Initialize from a given probability mass function)doc";
+static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_2 =
+R"doc(Initialize from a given probability mass function
+
+When ``alias`` is set to ``True``, an alias table is additionally
+built and used for sampling.)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_3 = R"doc(Initialize from a given probability mass function (rvalue version))doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_4 = R"doc(Initialize from a given floating point array)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_alias = R"doc(Does this distribution sample using an alias table?)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_cdf = R"doc(Return the unnormalized cumulative distribution function)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_cdf_2 =
 R"doc(Return the unnormalized cumulative distribution function (const
 version))doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_compute_alias = R"doc(Build the alias table using Vose's O(n) algorithm)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_compute_cdf = R"doc()doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_empty = R"doc(Is the distribution object empty/uninitialized?)doc";
@@ -2731,6 +2800,25 @@ static const char *__doc_mitsuba_Film_prepare =
 R"doc(Configure the film for rendering a specified set of extra channels
 (AOVS). Returns the total number of channels that the film will store)doc";
 
+static const char *__doc_mitsuba_Film_prepare_blocks =
+R"doc(Announce the image blocks that a subsequent rendering will merge into
+the film using put_block()
+
+Block-based renderers (i.e. scalar variants of SamplingIntegrator)
+call this function after prepare(). The image region of size ``size``
+starting at ``offset`` is covered by a grid of square blocks of size
+``block_size``, which are created with a border (see create_block())
+and are each submitted ``passes`` times.
+
+When the integrator only renders a subset of the blocks (see
+SamplingIntegrator::set_block_partition()), ``partition_index`` and
+``partition_count`` specify the corresponding partition of the Spiral
+traversal. Only the blocks of this partition are submitted.
+
+Films can use this information to detect when a region of the image
+has received all of its samples, e.g. to stream it to disk. The
+default implementation does nothing.)doc";
+
 static const char *__doc_mitsuba_Film_prepare_sample =
 R"doc(Prepare spectrum samples to be in the format expected by the film
 
@@ -2809,6 +2897,12 @@ static const char *__doc_mitsuba_Film_size =
 R"doc(Ignoring the crop window, return the resolution of the underlying
 sensor)doc";
 
+static const char *__doc_mitsuba_Film_streams_output =
+R"doc(Is the film written to disk while rendering (see prepare_blocks())?
+
+In this case, bitmap() reads the complete image back from disk, which
+callers that only need a preview should avoid.)doc";
+
 static const char *__doc_mitsuba_Film_to_string = R"doc(//! @})doc";
 
 static const char *__doc_mitsuba_Film_traverse = R"doc()doc";
@@ -4019,6 +4113,14 @@ static const char *__doc_mitsuba_MemoryMappedFile_data_2 = R"doc(Return a pointe
 
 static const char *__doc_mitsuba_MemoryMappedFile_filename = R"doc(Return the associated filename)doc";
 
+static const char *__doc_mitsuba_MemoryMappedFile_map_private =
+R"doc(Map the specified file into memory using a private copy-on-write
+mapping
+
+The mapped region can be modified, but changes only affect the
+process-local copy of the touched pages and are never written back to
+the file. Pages that are only read are shared with the page cache.)doc";
+
 static const char *__doc_mitsuba_MemoryMappedFile_resize =
 R"doc(Resize the memory-mapped file
 
@@ -4182,6 +4284,10 @@ static const char *__doc_mitsuba_Mesh_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_compute_surface_interaction = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_decoded_vertex_normals = R"doc(Return the vertex normals in single precision (decoding compact normals))doc";
+
+static const char *__doc_mitsuba_Mesh_decoded_vertex_texcoords = R"doc(Return the texture coordinates in single precision (decoding compact ones))doc";
+
 static const char *__doc_mitsuba_Mesh_embree_geometry = R"doc(Return the Embree version of this shape)doc";
 
 static const char *__doc_mitsuba_Mesh_ensure_pmf_built = R"doc()doc";
@@ -4204,6 +4310,20 @@ static const char *__doc_mitsuba_Mesh_faces_buffer = R"doc(Return face indices b
 
 static const char *__doc_mitsuba_Mesh_faces_buffer_2 = R"doc(Const variant of faces_buffer.)doc";
 
+static const char *__doc_mitsuba_Mesh_has_compact_normals =
+R"doc(Does this mesh store its vertex normals in a compact encoding?
+
+Compact normals are encoded using the octahedral mapping (4 bytes per
+vertex instead of 12). The single precision buffer exposed via
+traverse() is then empty; assigning new normals to it and calling
+parameters_changed() re-encodes them.)doc";
+
+static const char *__doc_mitsuba_Mesh_has_compact_texcoords =
+R"doc(Does this mesh store its texture coordinates in a compact encoding?
+
+Compact texture coordinates are stored in half precision (4 bytes per
+vertex instead of 8), see has_compact_normals() for details.)doc";
+
 static const char *__doc_mitsuba_Mesh_has_face_normals = R"doc(Does this mesh use face normals?)doc";
 
 static const char *__doc_mitsuba_Mesh_has_mesh_attributes = R"doc(Does this mesh have additional mesh attributes?)doc";
@@ -4220,6 +4340,10 @@ static const char *__doc_mitsuba_Mesh_m_area_pmf = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_bbox = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_compact_normals = R"doc(Store vertex normals/texture coordinates in a compact encoding?)doc";
+
+static const char *__doc_mitsuba_Mesh_m_compact_texcoords = R"doc()doc";
+
 static const char *__doc_mitsuba_Mesh_m_face_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_face_normals =
@@ -4244,10 +4368,14 @@ static const char *__doc_mitsuba_Mesh_m_vertex_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_normals = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_vertex_normals_oct = R"doc(Octahedral vertex normals (only used with compact normals))doc";
+
 static const char *__doc_mitsuba_Mesh_m_vertex_positions = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_texcoords = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_vertex_texcoords_half = R"doc(Pairs of half precision texture coordinates (only used with compact texcoords))doc";
+
 static const char *__doc_mitsuba_Mesh_merge = R"doc(Merge two meshes into one)doc";
 
 static const char *__doc_mitsuba_Mesh_moeller_trumbore =
@@ -4328,6 +4456,14 @@ static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable
 
 static const char *__doc_mitsuba_Mesh_traverse = R"doc(@})doc";
 
+static const char *__doc_mitsuba_Mesh_update_attribute_encoding =
+R"doc(Convert the vertex normals and texture coordinates to the requested
+(compact or single precision) encoding
+
+Called by initialize() and parameters_changed(), since either
+representation may have been provided by the mesh loader or via
+traverse().)doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_count = R"doc(Return the total number of vertices)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_data_bytes = R"doc()doc";
@@ -5974,6 +6110,16 @@ static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_set_block_partition =
+R"doc(Restrict subsequent calls to render() to a subset of the image blocks
+
+The blocks of the spiral traversal are split into ``count`` interleaved
+partitions, of which only partition ``index`` is rendered. Since the
+sampler is seeded per block, the raw film contents of all partitions
+sum up to those of a regular rendering. This is used to distribute the
+rendering of a single image across multiple processes, and is only
+supported in scalar variants. The default (0, 1) renders all blocks.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_sample =
 R"doc(Sample the incident radiance along a ray.
 
@@ -6667,6 +6813,30 @@ static const char *__doc_mitsuba_Sensor_shutter_open_time = R"doc(Return the len
 
 static const char *__doc_mitsuba_Sensor_traverse = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_SerializedFlags = R"doc(Flags that describe the contents of a mesh in a .serialized file)doc";
+
+static const char *__doc_mitsuba_SerializedFlags_DoublePrecision = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_FaceNormals = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_HalfTexcoords = R"doc(Texture coordinates are stored in half precision (version 5))doc";
+
+static const char *__doc_mitsuba_SerializedFlags_HasColors = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_HasNormals = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_HasTangents = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_HasTexcoords = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_OctahedralNormals = R"doc(Vertex normals are stored using the octahedral encoding (version 5))doc";
+
+static const char *__doc_mitsuba_SerializedFlags_SinglePrecision = R"doc()doc";
+
+static const char *__doc_mitsuba_SerializedFlags_Uncompressed =
+R"doc(Buffers are stored without compression at page-aligned offsets
+(version 5))doc";
+
 static const char *__doc_mitsuba_Shape =
 R"doc(Base class of all geometric shapes in Mitsuba
 
@@ -7304,10 +7474,22 @@ R"doc(Return the offset, size, and unique identifier of the next block.
 
 A size of zero indicates that the spiral traversal is done.)doc";
 
+static const char *__doc_mitsuba_Spiral_partition_block_count = R"doc(Return the number of blocks per pass in the current partition)doc";
+
 static const char *__doc_mitsuba_Spiral_reset =
 R"doc(Reset the spiral to its initial state. Does not affect the number of
 passes.)doc";
 
+static const char *__doc_mitsuba_Spiral_set_partition =
+R"doc(Only generate the blocks of one partition of the spiral
+
+Splits the blocks of every pass into ``count`` interleaved partitions
+(block ``i`` belongs to partition ``i % count``) and restricts
+next_block() to those of partition ``index``. Block identifiers are
+unaffected, hence multiple processes can render disjoint sets of
+blocks and merge their results into an image that matches a single-
+process rendering.)doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -9122,6 +9304,19 @@ read or write operations are permitted.
 This function is idempotent. It is called automatically by the
 destructor.)doc";
 
+static const char *__doc_mitsuba_ZStream_compress =
+R"doc(Compress a memory region into a self-contained zlib stream
+
+Unlike the streaming interface, this function does not keep any state
+and can be called concurrently, e.g. to compress the chunks of a large
+buffer in parallel.)doc";
+
+static const char *__doc_mitsuba_ZStream_decompress =
+R"doc(Decompress a zlib stream created by compress()
+
+Throws an exception unless the stream expands to exactly ``size``
+bytes. Like compress(), this function is thread-safe.)doc";
+
 static const char *__doc_mitsuba_ZStream_flush = R"doc(Flushes any buffered data)doc";
 
 static const char *__doc_mitsuba_ZStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
@@ -9224,8 +9419,48 @@ Parameter ``dp_du``:
 Parameter ``frame``:
     Used to return the computed frame)doc";
 
+static const char *__doc_mitsuba_convert_serialized =
+R"doc(Convert a .serialized file to version 5 of the format
+
+Version 5 stores every vertex and index buffer as a sequence of
+independently compressed chunks, which are listed in a per-mesh chunk
+table. This enables the ``serialized`` plugin to decompress them in
+parallel and to skip over buffers that are not needed. When
+``compress`` is ``False``, the buffers are instead stored uncompressed
+at page-aligned offsets so that they can be memory-mapped.
+
+The conversion streams through the meshes of the input file (version 3
+or 4) and compresses batches of chunks in parallel, hence the memory
+usage does not depend on the size of the meshes. Double precision data
+is converted to single precision.
+
+Parameter ``source``:
+    Path of the file to be converted
+
+Parameter ``target``:
+    Path of the resulting file
+
+Parameter ``compress``:
+    Compress the chunks using ``zlib``?
+
+Parameter ``chunk_size``:
+    Amount of uncompressed data per chunk in bytes. Must be a multiple
+    of four.
+
+Parameter ``compact_normals``:
+    Store vertex normals using the octahedral encoding (4 instead of 12
+    bytes per vertex, see encode_octahedral())
+
+Parameter ``compact_texcoords``:
+    Store texture coordinates in half precision (4 instead of 8 bytes
+    per vertex, see encode_half2()))doc";
+
 static const char *__doc_mitsuba_coordinate_system = R"doc(Complete the set {a} to an orthonormal basis {a, b, c})doc";
 
+static const char *__doc_mitsuba_decode_half2 = R"doc(Decode pairs of values created by encode_half2())doc";
+
+static const char *__doc_mitsuba_decode_octahedral = R"doc(Decode unit vectors created by encode_octahedral())doc";
+
 static const char *__doc_mitsuba_depolarizer =
 R"doc(Turn a spectrum into a Mueller matrix representation that only has a
 non-zero (1,1) entry. For all non-polarized modes, this is the
@@ -9443,6 +9678,16 @@ static const char *__doc_mitsuba_emitter =
 R"doc(Return the emitter associated with the intersection (if any) \note
 Defined in scene.h)doc";
 
+static const char *__doc_mitsuba_encode_half2 = R"doc(Pack a pair of values into a 32-bit word as two half precision values)doc";
+
+static const char *__doc_mitsuba_encode_octahedral =
+R"doc(Encode a unit vector using the octahedral mapping
+
+The vector is projected onto the octahedron, whose lower half is
+folded over the upper half. The resulting 2D coordinates are quantized
+to 16-bit signed normalized integers and packed into a 32-bit word
+(maximum angular error: ~0.005 degrees).)doc";
+
 static const char *__doc_mitsuba_eval_reflectance = R"doc()doc";
 
 static const char *__doc_mitsuba_eval_transmittance = R"doc()doc";
@@ -11486,7 +11731,14 @@ Parameter ``variant``:
 
 Parameter ``update_scene``:
     When Mitsuba updates scene to a newer version, should the updated
-    XML file be written back to disk?)doc";
+    XML file be written back to disk?
+
+Parameter ``deduplicate``:
+    When set, anonymous (i.e. nested, without an ``id`` attribute)
+    textures, volumes, BSDFs, phase functions and media with identical
+    properties, including the resolved paths of referenced files, are
+    only instantiated once and shared. Shared objects only appear once
+    in the scene parameters returned by ``traverse()``.)doc";
 
 static const char *__doc_mitsuba_xml_load_string = R"doc(Load a Mitsuba scene from an XML string)doc";
 
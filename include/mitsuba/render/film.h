@@ -131,6 +131,31 @@ public:
                                          bool normalize = false,
                                          bool border = false) = 0;
 
+    /**
+     * \brief Announce the image blocks that a subsequent rendering will merge
+     * into the film using \ref put_block()
+     *
+     * Block-based renderers (i.e. scalar variants of \ref SamplingIntegrator)
+     * call this function after \ref prepare(). The image region of size \c
+     * size starting at \c offset is covered by a grid of square blocks of
+     * size \c block_size, which are created with a border (see \ref
+     * create_block()) and are each submitted \c passes times.
+     *
+     * When the integrator only renders a subset of the blocks (see \ref
+     * SamplingIntegrator::set_block_partition()), \c partition_index and
+     * \c partition_count specify the corresponding partition of the \ref
+     * Spiral traversal. Only the blocks of this partition are submitted.
+     *
+     * Films can use this information to detect when a region of the image
+     * has received all of its samples, e.g. to stream it to disk. The default
+     * implementation does nothing.
+     */
+    virtual void prepare_blocks(const ScalarPoint2i &offset,
+                                const ScalarVector2u &size,
+                                uint32_t block_size, uint32_t passes,
+                                uint32_t partition_index = 0,
+                                uint32_t partition_count = 1);
+
     // =============================================================
     //! @{ \name Accessor functions
     // =============================================================
@@ -142,6 +167,15 @@ public:
      */
     bool sample_border() const { return m_sample_border; }
 
+    /**
+     * \brief Is the film written to disk while rendering (see \ref
+     * prepare_blocks())?
+     *
+     * In this case, \ref bitmap() reads the complete image back from disk,
+     * which callers that only need a preview should avoid.
+     */
+    virtual bool streams_output() const { return false; }
+
     /// Ignoring the crop window, return the resolution of the underlying sensor
     const ScalarVector2u &size() const { return m_size; }
 
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <mitsuba/core/atomic.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <drjit/dynamic.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Spatial-directional radiance distribution for path guiding
+ *
+ * This class implements the SD-tree of "Practical Path Guiding for Efficient
+ * Light-Transport Simulation" by Müller et al. (2017): a binary tree
+ * subdivides the scene bounding box, and each of its leaves stores a quadtree
+ * over the (cylindrically mapped) sphere of directions that approximates the
+ * incident radiance in that region.
+ *
+ * The distribution is learned online over a sequence of training passes. While
+ * training, integrators call \ref record() to splat radiance estimates into
+ * the tree. Afterwards, \ref refine() adapts the spatial and directional
+ * subdivision to the recorded energy, and the result is used for sampling
+ * during the following passes. Guided sampling is combined with BSDF sampling
+ * using a per-leaf selection probability that is optimized with Adam to
+ * minimize the KL divergence to the product of BSDF and incident radiance
+ * (Müller, "Practical Path Guiding in Production", 2019).
+ *
+ * All nodes are stored in flat arrays so that lookups, sampling and recording
+ * work identically in scalar and JIT variants. Refinement always happens on
+ * the host.
+ */
+MI_VARIANT
+class MI_EXPORT_LIB SDTree : public Object {
+public:
+    MI_IMPORT_TYPES(BSDFPtr)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Create an empty SD-tree, parameters are read from \c props
+    SDTree(const Properties &props);
+
+    /// Reset the tree to a single spatial leaf covering \c bbox
+    void reset(const ScalarBoundingBox3f &bbox);
+
+    /// Has the distribution been trained by at least one call to \ref refine()?
+    bool ready() const { return m_iteration > 0; }
+
+    /// Should integrators record radiance samples into the tree?
+    bool training() const { return m_training; }
+
+    /// Enable or disable recording of radiance samples
+    void set_training(bool training) { m_training = training; }
+
+    /// Return the number of completed training iterations
+    uint32_t iteration() const { return m_iteration; }
+
+    /// Fraction of the sample budget used for training passes
+    ScalarFloat budget() const { return m_budget; }
+
+    /**
+     * \brief Enable or disable guided sampling
+     *
+     * When disabled, the tree is still trained but only serves as a radiance
+     * cache (see \ref radiance()), and \ref sample_bsdf() always samples the
+     * BSDF.
+     */
+    void set_guided_sampling(bool value) { m_guided_sampling = value; }
+
+    /// Is guided sampling enabled?
+    bool guided_sampling() const { return m_guided_sampling; }
+
+    // =============================================================
+    //! @{ \name Query interface
+    // =============================================================
+
+    /// Return the index of the directional tree associated with position \c p
+    UInt32 lookup(const Point3f &p, Mask active = true) const;
+
+    /// Sample a world-space direction from the directional tree \c dtree
+    Vector3f sample(const UInt32 &dtree, const Point2f &sample,
+                    Mask active = true) const;
+
+    /// Evaluate the solid angle density of direction \c d in tree \c dtree
+    Float pdf(const UInt32 &dtree, const Vector3f &d,
+              Mask active = true) const;
+
+    /// Return the probability of choosing BSDF sampling over guided sampling
+    Float bsdf_fraction(const UInt32 &dtree, Mask active = true) const;
+
+    /**
+     * \brief Estimate the radiance reflected by \c bsdf at \c si
+     *
+     * The estimate uses a single direction drawn from the learned incident
+     * radiance distribution, whose density cancels with the cached incident
+     * radiance. It is cheap and unbiased with respect to the cache, but not
+     * with respect to the actual solution. Returns zero until the tree has
+     * been trained.
+     */
+    Float reflected_radiance(const BSDFContext &ctx, const BSDFPtr &bsdf,
+                             const SurfaceInteraction3f &si,
+                             const UInt32 &dtree, const Point2f &sample,
+                             Mask active = true) const;
+
+    /**
+     * \brief Determine which lanes can use guided sampling and should record
+     * radiance, i.e. those whose BSDF has no Dirac delta components and no
+     * glossy transmission (which may refract)
+     */
+    Mask guidable(const BSDFPtr &bsdf, Mask active = true) const;
+
+    /**
+     * \brief Sample the one-sample mixture of BSDF and guiding distribution
+     *
+     * Lanes where \c guided is \c false fall back to plain BSDF sampling,
+     * as do all lanes before the distribution has been trained.
+     *
+     * \return A tuple consisting of
+     *
+     *  1. the BSDF sample, whose \c pdf field contains the mixture density,
+     *  2. the BSDF value divided by the mixture density (in the local frame),
+     *  3. a coefficient that, multiplied by the incident radiance found along
+     *     the sampled direction, yields the gradient of the KL divergence with
+     *     respect to the selection parameter. It should be passed to
+     *     \ref record() once that radiance is known.
+     */
+    std::tuple<BSDFSample3f, Spectrum, Float>
+    sample_bsdf(const BSDFContext &ctx, const BSDFPtr &bsdf,
+                const SurfaceInteraction3f &si, const UInt32 &dtree,
+                Float sample1, const Point2f &sample2, Mask guided,
+                Mask active = true) const;
+
+    /**
+     * \brief Convert a BSDF density into the mixture density used by
+     * \ref sample_bsdf() (e.g. to compute MIS weights for emitter samples)
+     */
+    Float mixture_pdf(const UInt32 &dtree, const Vector3f &d,
+                      const Float &bsdf_pdf, Mask guided) const;
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Training interface
+    // =============================================================
+
+    /**
+     * \brief Splat a radiance estimate into the tree (thread-safe)
+     *
+     * \param dtree
+     *     Directional tree index returned by \ref lookup()
+     *
+     * \param d
+     *     World-space direction of the incident radiance
+     *
+     * \param radiance
+     *     Incident radiance divided by the density of sampling \c d
+     *
+     * \param gradient
+     *     Gradient of the selection parameter (see \ref sample_bsdf())
+     */
+    void record(const UInt32 &dtree, const Vector3f &d, const Float &radiance,
+                const Float &gradient, Mask active = true) const;
+
+    /**
+     * \brief Adapt the tree to the samples recorded since the last call, and
+     * use the result for sampling from now on.
+     */
+    void refine();
+
+    //! @}
+    // =============================================================
+
+    /// Return the number of spatial nodes
+    size_t spatial_node_count() const { return m_spatial.size(); }
+
+    /// Return the total number of directional nodes
+    size_t directional_node_count() const { return m_directional.size(); }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    ~SDTree();
+
+    /// Node of the spatial binary tree
+    struct SpatialNode {
+        /// Index of the first of two children (0 for leaf nodes)
+        uint32_t child;
+        /// Split axis for interior nodes, directional tree index for leaves
+        uint32_t data;
+    };
+
+    /// Node of a directional quadtree
+    struct DirectionalNode {
+        /// Indices of the four children (0 for leaf quadrants)
+        uint32_t child[4];
+        /// Energy in each quadrant
+        ScalarFloat sum[4];
+    };
+
+    /// Per-leaf state of the directional trees
+    struct DTree {
+        uint32_t root;
+        /// Parameter of the BSDF selection probability (logit)
+        double theta;
+        /// Adam optimizer state
+        double adam_m, adam_v;
+        uint32_t adam_steps;
+        /// Estimate of the incident radiance integrated over the sphere
+        ScalarFloat flux;
+    };
+
+    /// Duplicate the nodes of directional tree \c root, returning the new root
+    uint32_t copy_directional(uint32_t root);
+
+    /// Build a new directional tree from the records of tree \c root
+    uint32_t build_directional(const ScalarFloat *records, uint32_t root,
+                               std::vector<DirectionalNode> &out) const;
+
+    /// Upload the host-side representation for rendering and clear records
+    void upload();
+
+    /// Map a direction to the canonical [0, 1]^2 domain of the quadtrees
+    Point2f dir_to_canonical(const Vector3f &d) const;
+
+    /// Inverse of \ref dir_to_canonical()
+    Vector3f canonical_to_dir(const Point2f &p) const;
+
+    /// Atomically add \c value to entry \c index of a record buffer
+    void accumulate(FloatStorage &buffer, AtomicFloat<ScalarFloat> *host,
+                    const Float &value, const UInt32 &index, Mask active) const;
+
+protected:
+    ScalarBoundingBox3f m_bbox;
+    ScalarVector3f m_inv_extents;
+
+    // Host-side representation (used for refinement)
+    std::vector<SpatialNode> m_spatial;
+    std::vector<DirectionalNode> m_directional;
+    std::vector<DTree> m_dtrees;
+
+    // Flattened representation used for rendering
+    UInt32Storage m_spatial_child;
+    UInt32Storage m_spatial_data;
+    UInt32Storage m_dir_child;
+    FloatStorage m_dir_sum;
+    UInt32Storage m_dtree_root;
+    FloatStorage m_dtree_alpha;
+    FloatStorage m_dtree_flux;
+
+    /* Record buffers: 4 entries per directional node, and 2 entries (sample
+       count, gradient) per directional tree. JIT variants scatter into the
+       JIT arrays, scalar variants use atomics. */
+    mutable FloatStorage m_dir_record;
+    mutable FloatStorage m_dtree_record;
+    std::unique_ptr<AtomicFloat<ScalarFloat>[]> m_dir_record_host;
+    std::unique_ptr<AtomicFloat<ScalarFloat>[]> m_dtree_record_host;
+
+    uint32_t m_iteration;
+    bool m_training;
+    bool m_guided_sampling;
+
+    // Parameters
+    ScalarFloat m_budget;
+    ScalarFloat m_spatial_threshold;
+    ScalarFloat m_rho;
+    uint32_t m_max_spatial_depth;
+    uint32_t m_max_directional_depth;
+    ScalarFloat m_learning_rate;
+};
+
+/**
+ * \brief Bookkeeping of the vertices of a path for recording radiance into an
+ * \ref SDTree
+ *
+ * The incident radiance at a vertex is only known once the remainder of the
+ * path has been traced. This structure stores the first \c Size guided
+ * vertices of a path along with the path throughput at each of them, so that
+ * every radiance contribution found later on can be attributed to all
+ * preceding vertices. Deeper vertices are not recorded.
+ */
+template <typename Float_, typename Spectrum_> struct GuidingPath {
+    using Float    = Float_;
+    using Spectrum = Spectrum_;
+    MI_IMPORT_RENDER_BASIC_TYPES()
+    using SDTree = mitsuba::SDTree<Float, Spectrum>;
+
+    static constexpr size_t Size = 6;
+
+    using FloatArray  = dr::Array<Float, Size>;
+    using UInt32Array = dr::Array<UInt32, Size>;
+
+    /// Directional tree of each vertex
+    UInt32Array dtree;
+    /// Sampled direction at each vertex
+    dr::Array<Vector3f, Size> d;
+    /// Inverse path throughput after each vertex
+    FloatArray inv_throughput;
+    /// Inverse density of the direction sampled at each vertex
+    FloatArray inv_pdf;
+    /// Gradient coefficient returned by \ref SDTree::sample_bsdf()
+    FloatArray grad;
+    /// Accumulated incident radiance at each vertex
+    FloatArray radiance;
+    /// Number of stored vertices
+    UInt32 size;
+
+    /// Append a vertex (ignored once \c Size vertices have been stored)
+    void add_vertex(const UInt32 &dtree_, const Vector3f &d_,
+                    const Spectrum &throughput, const Float &pdf,
+                    const Float &grad_, Mask active) {
+        Float lum = dr::mean(unpolarized_spectrum(throughput));
+        active &= lum > 0.f && pdf > 0.f;
+        for (size_t i = 0; i < Size; ++i) {
+            Mask m = active && dr::eq(size, (uint32_t) i);
+            dr::masked(dtree[i], m) = dtree_;
+            dr::masked(d[i], m) = d_;
+            dr::masked(inv_throughput[i], m) = dr::rcp(lum);
+            dr::masked(inv_pdf[i], m) = dr::rcp(pdf);
+            dr::masked(grad[i], m) = grad_;
+            dr::masked(radiance[i], m) = 0.f;
+        }
+        dr::masked(size, active && size < (uint32_t) Size) += 1;
+    }
+
+    /// Attribute a contribution that was added to the path estimate
+    void add_radiance(const Spectrum &contrib, Mask active) {
+        Float lum = dr::mean(unpolarized_spectrum(contrib));
+        for (size_t i = 0; i < Size; ++i)
+            dr::masked(radiance[i], active && size > (uint32_t) i) +=
+                lum * inv_throughput[i];
+    }
+
+    /// Splat the radiance of all stored vertices into \c tree
+    void commit(const SDTree *tree, Mask active) const {
+        for (size_t i = 0; i < Size; ++i) {
+            Mask m = active && size > (uint32_t) i;
+            if (dr::none_or<false>(m))
+                break;
+            tree->record(dtree[i], d[i], radiance[i] * inv_pdf[i],
+                         radiance[i] * grad[i], m);
+        }
+    }
+
+    DRJIT_STRUCT(GuidingPath, dtree, d, inv_throughput, inv_pdf, grad,
+                 radiance, size)
+};
+
+MI_EXTERN_CLASS(SDTree)
+NAMESPACE_END(mitsuba)
@@ -8,12 +8,15 @@
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/render/fwd.h>
+#include <mitsuba/render/guiding.h>
 #include <mitsuba/render/imageblock.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/medium.h>
+#include <atomic>
+#include <functional>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -36,7 +39,10 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Integrator : public Object {
 public:
-    MI_IMPORT_TYPES(Scene, Sensor)
+    MI_IMPORT_TYPES(Scene, Sensor, Film)
+
+    /// Function receiving the film of a rendering in progress
+    using PreviewCallback = std::function<void(const Film *)>;
 
     /**
      * \brief Render the scene
@@ -115,6 +121,20 @@ public:
      */
     virtual std::vector<std::string> aov_names() const;
 
+    /**
+     * \brief Register a function that periodically receives the film of a
+     * rendering in progress, e.g. to show it in an external image viewer
+     *
+     * Sampling integrators invoke the callback at most every \c interval
+     * seconds: scalar variants on the rendering thread that just merged an
+     * image block into the film, JIT variants after every separately
+     * evaluated pass (which are then merged into the film one at a time). The
+     * calling thread is delayed until the callback returns, hence it should
+     * defer expensive work. An empty function disables the previews.
+     */
+    void set_preview_callback(const PreviewCallback &callback,
+                              float interval = 1.f);
+
     MI_DECLARE_CLASS()
 protected:
     /// Create an integrator
@@ -123,6 +143,17 @@ protected:
     /// Virtual destructor
     virtual ~Integrator() { }
 
+    /// Restart the preview interval (called at the beginning of rendering)
+    void reset_preview();
+
+    /**
+     * \brief Invoke the preview callback if the preview interval has elapsed
+     *
+     * This function is thread-safe and does not block: when several threads
+     * call it concurrently, only one of them invokes the callback.
+     */
+    void preview(const Film *film);
+
 protected:
     /// Integrators should stop all work when this flag is set to true.
     bool m_stop;
@@ -139,6 +170,15 @@ protected:
 
     /// Flag for disabling direct visibility of emitters
     bool m_hide_emitters;
+
+    /// Function receiving the film during rendering (see \ref preview())
+    PreviewCallback m_preview_callback;
+
+    /// Minimum time between two invocations of the preview callback (in ms)
+    size_t m_preview_interval;
+
+    /// Value of \ref m_render_timer at which the next preview is due
+    std::atomic<size_t> m_next_preview;
 };
 
 /** \brief Abstract integrator that performs Monte Carlo sampling starting from
@@ -154,8 +194,9 @@ protected:
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB SamplingIntegrator : public Integrator<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(Integrator, should_stop, aov_names,
-                    m_stop, m_timeout, m_render_timer, m_hide_emitters)
+    MI_IMPORT_BASE(Integrator, should_stop, aov_names, reset_preview, preview,
+                    m_stop, m_timeout, m_render_timer, m_hide_emitters,
+                    m_preview_callback)
     MI_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler)
 
     /**
@@ -204,6 +245,32 @@ public:
                                              Float *aovs = nullptr,
                                              Mask active = true) const;
 
+    /**
+     * \brief Sample the incident radiance along a ray whose first
+     * intersection with the scene has already been computed.
+     *
+     * This is an optimization for wrappers like the AOV integrator that
+     * intersect the primary ray themselves: integrators that override this
+     * function reuse \c si instead of tracing the ray again. The default
+     * implementation ignores \c si and calls \ref sample().
+     *
+     * \param si
+     *    The result of <tt>scene->ray_intersect(ray)</tt> with (at least) the
+     *    \ref RayFlags::All flags. Lanes with invalid intersections
+     *    (i.e. rays that escaped the scene) must be left as returned by \ref
+     *    Scene::ray_intersect().
+     *
+     * See \ref sample() for a description of the other parameters.
+     */
+    virtual std::pair<Spectrum, Mask>
+    sample_primary(const Scene *scene,
+                   Sampler *sampler,
+                   const RayDifferential3f &ray,
+                   const SurfaceInteraction3f &si,
+                   const Medium *medium = nullptr,
+                   Float *aovs = nullptr,
+                   Mask active = true) const;
+
     // =========================================================================
     //! @{ \name Integrator interface implementation
     // =========================================================================
@@ -215,6 +282,19 @@ public:
                     bool develop = true,
                     bool evaluate = true) override;
 
+    /**
+     * \brief Restrict subsequent calls to \ref render() to a subset of the
+     * image blocks
+     *
+     * The blocks of the spiral traversal are split into \c count interleaved
+     * partitions, of which only partition \c index is rendered. Since the
+     * sampler is seeded per block, the raw film contents of all partitions
+     * sum up to those of a regular rendering. This is used to distribute the
+     * rendering of a single image across multiple processes, and is only
+     * supported in scalar variants. The default (0, 1) renders all blocks.
+     */
+    void set_block_partition(uint32_t index, uint32_t count);
+
     //! @}
     // =========================================================================
 
@@ -254,6 +334,28 @@ protected:
      * If set to (uint32_t) -1, all the work is done in a single pass (default).
      */
     uint32_t m_samples_per_pass;
+
+    /**
+     * \brief Maximum number of samples per wavefront (in JIT modes).
+     *
+     * Larger renderings are automatically split into multiple passes and,
+     * if needed, into multiple image chunks that are rendered by the same
+     * kernel. This bounds the peak memory usage irrespective of the image
+     * resolution and sample count. If set to 0, the backend limit is used.
+     */
+    uint32_t m_max_wavefront_size;
+
+    /**
+     * \brief Record all passes of a JIT rendering into a single kernel
+     *
+     * When set, the passes are expressed as a symbolic loop around \ref
+     * render_sample(), which is traced only once instead of once per pass.
+     * Requires loop recording (\c JitFlag::LoopRecord) to be enabled.
+     */
+    bool m_record_passes;
+
+    /// Block partition rendered by \ref render() (see \ref set_block_partition())
+    uint32_t m_partition_index = 0, m_partition_count = 1;
 };
 
 /** \brief Abstract integrator that performs *recursive* Monte Carlo sampling
@@ -269,6 +371,24 @@ class MI_EXPORT_LIB MonteCarloIntegrator
     : public SamplingIntegrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(SamplingIntegrator)
+    MI_IMPORT_TYPES(Scene, Sensor, SDTree)
+
+    /**
+     * \brief Render the scene
+     *
+     * When path guiding is enabled, this function first renders a sequence of
+     * training passes with 1, 2, 4, ... samples per pixel (using up to a
+     * fraction \ref SDTree::budget() of the sample count), refining the
+     * guiding distribution after each of them. The final image is then
+     * rendered using the trained distribution and the remaining samples,
+     * so that the total sample count does not exceed \c spp.
+     */
+    TensorXf render(Scene *scene,
+                    Sensor *sensor,
+                    uint32_t seed = 0,
+                    uint32_t spp = 0,
+                    bool develop = true,
+                    bool evaluate = true) override;
 
 protected:
     /// Create an integrator
@@ -277,10 +397,70 @@ protected:
     /// Virtual destructor
     virtual ~MonteCarloIntegrator();
 
+    /**
+     * \brief Parse the path guiding and Russian roulette parameters
+     *
+     * Integrators that support path guiding and adjoint-driven Russian
+     * roulette and splitting call this from their constructor. It creates
+     * \ref m_guide when either of them was requested, since the latter uses
+     * the learned distribution as a radiance cache.
+     */
+    void init_guiding(const Properties &props);
+
+    /**
+     * \brief Compute the survival probability and split factor of a path
+     * vertex using a weight window (adjoint-driven Russian roulette and
+     * splitting)
+     *
+     * \param expected
+     *    Expected contribution of the path continuation, i.e. the product of
+     *    the path throughput and the estimated reflected radiance
+     *
+     * \param pixel
+     *    Estimate of the pixel value the path contributes to
+     *
+     * \return
+     *    The survival probability and the number of branches. Both are one
+     *    when the expected contribution lies inside the window, or when there
+     *    is no pixel estimate to compare against.
+     */
+    std::pair<Float, UInt32> adrrs_factors(const Float &expected,
+                                           const Float &pixel,
+                                           Mask active) const {
+        Float c_min = pixel * (2.f / (1.f + m_adrrs_window)),
+              c_max = c_min * m_adrrs_window;
+        active &= pixel > 0.f;
+
+        Float survival = dr::select(active && expected < c_min,
+                                    dr::maximum(expected / c_min, .05f), 1.f);
+        UInt32 split = dr::select(
+            active && expected > c_max,
+            UInt32(dr::minimum(dr::ceil(expected / c_max),
+                               (ScalarFloat) m_adrrs_max_split)),
+            1u);
+
+        return { survival, split };
+    }
+
     MI_DECLARE_CLASS()
 protected:
     uint32_t m_max_depth;
     uint32_t m_rr_depth;
+
+    /**
+     * \brief Path guiding distribution
+     *
+     * Integrators that support path guiding create this in their constructor
+     * when it was requested. It is \c nullptr otherwise.
+     */
+    ref<SDTree> m_guide;
+
+    /// Use adjoint-driven Russian roulette and splitting?
+    bool m_adrrs;
+    /// Ratio between the upper and lower bound of the weight window
+    ScalarFloat m_adrrs_window;
+    /// Maximum number of branches created at a single vertex
+    uint32_t m_adrrs_max_split;
 };
 
 /** \brief Abstract adjoint integrator that performs Monte Carlo sampling
@@ -10,9 +10,94 @@
 #include <unordered_map>
 #include <mutex>
 #include <drjit/dynamic.h>
+#include <drjit/half.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+// =========================================================================
+//! @{ \name Compact encodings of vertex attributes
+// =========================================================================
+
+/**
+ * \brief Encode a unit vector using the octahedral mapping
+ *
+ * The vector is projected onto the octahedron, whose lower half is folded
+ * over the upper half. The resulting 2D coordinates are quantized to 16-bit
+ * signed normalized integers and packed into a 32-bit word (maximum angular
+ * error: ~0.005 degrees).
+ */
+inline uint32_t encode_octahedral(const Normal<float, 3> &n) {
+    float l1 = dr::abs(n.x()) + dr::abs(n.y()) + dr::abs(n.z());
+    if (l1 == 0.f)
+        return 0u;
+
+    float x = n.x() / l1, y = n.y() / l1;
+    if (n.z() < 0.f) {
+        float x2 = dr::copysign(1.f - dr::abs(y), x),
+              y2 = dr::copysign(1.f - dr::abs(x), y);
+        x = x2; y = y2;
+    }
+
+    auto quantize = [](float value) {
+        return (uint32_t) (uint16_t) (int16_t) std::lrint(
+            dr::clamp(value, -1.f, 1.f) * 32767.f);
+    };
+
+    return quantize(x) | (quantize(y) << 16);
+}
+
+/// Decode unit vectors created by \ref encode_octahedral()
+template <typename UInt32>
+MI_INLINE Normal<dr::float32_array_t<UInt32>, 3> decode_octahedral(const UInt32 &value) {
+    using Float32 = dr::float32_array_t<UInt32>;
+    using Int32   = dr::int32_array_t<UInt32>;
+
+    // Sign-extend the two 16-bit components
+    Float32 x = Float32(dr::sr<16>(dr::reinterpret_array<Int32>(dr::sl<16>(value)))),
+            y = Float32(dr::sr<16>(dr::reinterpret_array<Int32>(value)));
+    x *= 1.f / 32767.f;
+    y *= 1.f / 32767.f;
+
+    // Unfold the lower half of the octahedron
+    Float32 z = 1.f - dr::abs(x) - dr::abs(y),
+            t = dr::maximum(-z, 0.f);
+    x -= dr::copysign(t, x);
+    y -= dr::copysign(t, y);
+
+    return dr::normalize(Normal<Float32, 3>(x, y, z));
+}
+
+/// Pack a pair of values into a 32-bit word as two half precision values
+inline uint32_t encode_half2(float a, float b) {
+    auto quantize = [](float value) {
+        // Clamp to the largest finite half precision value
+        return (uint32_t) dr::half::float32_to_float16(
+            dr::clamp(value, -65504.f, 65504.f));
+    };
+    return quantize(a) | (quantize(b) << 16);
+}
+
+/// Decode pairs of values created by \ref encode_half2()
+template <typename UInt32>
+MI_INLINE Point<dr::float32_array_t<UInt32>, 2> decode_half2(const UInt32 &value) {
+    using Float32 = dr::float32_array_t<UInt32>;
+
+    /* Convert a finite half precision value by moving the exponent and
+       mantissa into place, followed by a multiplication that adjusts the
+       exponent bias (this also correctly handles denormals) */
+    auto decode = [](const UInt32 &h) {
+        Float32 magnitude =
+            dr::reinterpret_array<Float32>(dr::sl<13>(h & 0x7FFFu)) * 0x1p112f;
+        return dr::reinterpret_array<Float32>(
+            dr::reinterpret_array<UInt32>(magnitude) | dr::sl<16>(h & 0x8000u));
+    };
+
+    return Point<Float32, 2>(decode(value & 0xFFFFu), decode(dr::sr<16>(value)));
+}
+
+//! @}
+// =========================================================================
+
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Mesh : public Shape<Float, Spectrum> {
 public:
@@ -102,6 +187,9 @@ public:
     MI_INLINE auto vertex_normal(Index index,
                                  dr::mask_t<Index> active = true) const {
         using Result = Normal<dr::replace_scalar_t<Index, InputFloat>, 3>;
+        if (dr::width(m_vertex_normals_oct) != 0)
+            return Result(decode_octahedral(dr::gather<dr::uint32_array_t<Index>>(
+                m_vertex_normals_oct, index, active)));
         return dr::gather<Result>(m_vertex_normals, index, active);
     }
 
@@ -110,14 +198,42 @@ public:
     MI_INLINE auto vertex_texcoord(Index index,
                                    dr::mask_t<Index> active = true) const {
         using Result = Point<dr::replace_scalar_t<Index, InputFloat>, 2>;
+        if (dr::width(m_vertex_texcoords_half) != 0)
+            return Result(decode_half2(dr::gather<dr::uint32_array_t<Index>>(
+                m_vertex_texcoords_half, index, active)));
         return dr::gather<Result>(m_vertex_texcoords, index, active);
     }
 
     /// Does this mesh have per-vertex normals?
-    bool has_vertex_normals() const { return dr::width(m_vertex_normals) != 0; }
+    bool has_vertex_normals() const {
+        return dr::width(m_vertex_normals) != 0 ||
+               dr::width(m_vertex_normals_oct) != 0;
+    }
 
     /// Does this mesh have per-vertex texture coordinates?
-    bool has_vertex_texcoords() const { return dr::width(m_vertex_texcoords) != 0; }
+    bool has_vertex_texcoords() const {
+        return dr::width(m_vertex_texcoords) != 0 ||
+               dr::width(m_vertex_texcoords_half) != 0;
+    }
+
+    /**
+     * \brief Does this mesh store its vertex normals in a compact encoding?
+     *
+     * Compact normals are encoded using the octahedral mapping (4 bytes per
+     * vertex instead of 12). The single precision buffer exposed via \ref
+     * traverse() is then empty; assigning new normals to it and calling \ref
+     * parameters_changed() re-encodes them.
+     */
+    bool has_compact_normals() const { return m_compact_normals; }
+
+    /**
+     * \brief Does this mesh store its texture coordinates in a compact
+     * encoding?
+     *
+     * Compact texture coordinates are stored in half precision (4 bytes per
+     * vertex instead of 8), see \ref has_compact_normals() for details.
+     */
+    bool has_compact_texcoords() const { return m_compact_texcoords; }
 
     /// Does this mesh have additional mesh attributes?
     bool has_mesh_attributes() const { return m_mesh_attributes.size() > 0; }
@@ -140,6 +256,12 @@ public:
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /// Return the vertex normals in single precision (decoding compact normals)
+    FloatStorage decoded_vertex_normals() const;
+
+    /// Return the texture coordinates in single precision (decoding compact ones)
+    FloatStorage decoded_vertex_texcoords() const;
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -160,6 +282,31 @@ public:
 
     virtual Float pdf_position(const PositionSample3f &ps, Mask active = true) const override;
 
+    /**
+     * \brief Sample a direction towards the mesh
+     *
+     * Depending on the \c emitter_sampling parameter, the triangle chosen
+     * proportionally to its surface area is either sampled uniformly by area
+     * (the default), uniformly within the spherical triangle it subtends as
+     * seen from the reference point, or with an additional bilinear warp
+     * approximating the cosine foreshortening at the reference point.
+     * Triangles subtending a very small or very large solid angle always fall
+     * back to area sampling.
+     */
+    virtual DirectionSample3f sample_direction(const Interaction3f &it,
+                                               const Point2f &sample,
+                                               Mask active = true) const override;
+
+    /**
+     * \brief Query the probability density of \ref sample_direction()
+     *
+     * When sampling by solid angle, the density depends on the triangle
+     * identified by the \c prim_index field of \c ds.
+     */
+    virtual Float pdf_direction(const Interaction3f &it,
+                                const DirectionSample3f &ds,
+                                Mask active = true) const override;
+
     virtual Point3f
     barycentric_coordinates(const SurfaceInteraction3f &si,
                             Mask active = true) const;
@@ -310,6 +457,10 @@ protected:
      */
     void build_parameterization();
 
+    /// Interpolate the position, normal and UV coordinates of a point on a face
+    PositionSample3f face_position_sample(const Vector3u &fi, const Point2f &b,
+                                          Mask active) const;
+
     // Ensures that the sampling table are ready.
     DRJIT_INLINE void ensure_pmf_built() const {
         if (unlikely(m_area_pmf.empty()))
@@ -423,6 +574,16 @@ protected:
         }
     }
 
+    /**
+     * \brief Convert the vertex normals and texture coordinates to the
+     * requested (compact or single precision) encoding
+     *
+     * Called by \ref initialize() and \ref parameters_changed(), since either
+     * representation may have been provided by the mesh loader or via \ref
+     * traverse().
+     */
+    void update_attribute_encoding();
+
 protected:
     std::string m_name;
     ScalarBoundingBox3f m_bbox;
@@ -436,6 +597,11 @@ protected:
 
     mutable DynamicBuffer<UInt32> m_faces;
 
+    /// Octahedral vertex normals (only used with compact normals)
+    mutable DynamicBuffer<UInt32> m_vertex_normals_oct;
+    /// Pairs of half precision texture coordinates (only used with compact texcoords)
+    mutable DynamicBuffer<UInt32> m_vertex_texcoords_half;
+
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
     /* Data pointer to ensure triangle intersection routine doesn't rely on
        drjit-core when called from an LLVM kernel */
@@ -453,6 +619,19 @@ protected:
     bool m_face_normals = false;
     bool m_flip_normals = false;
 
+    /// Store vertex normals/texture coordinates in a compact encoding?
+    bool m_compact_normals = false;
+    bool m_compact_texcoords = false;
+
+    /// Sample triangles using an alias table instead of the CDF?
+    bool m_alias_sampling = false;
+
+    /// Strategy used by \ref sample_direction() to sample a triangle
+    enum class EmitterSampling : uint32_t {
+        Area, SolidAngle, ProjectedSolidAngle
+    };
+    EmitterSampling m_emitter_sampling = EmitterSampling::Area;
+
     /* Surface area distribution -- generated on demand when \ref
        prepare_area_pmf() is first called. */
     DiscreteDistribution<Float> m_area_pmf;
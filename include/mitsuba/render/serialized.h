@@ -0,0 +1,83 @@
+#pragma once
+
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/core/filesystem.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Identifier stored at the beginning of every mesh in a .serialized file
+#define MI_FILEFORMAT_HEADER     0x041C
+#define MI_FILEFORMAT_VERSION_V3 0x0003
+#define MI_FILEFORMAT_VERSION_V4 0x0004
+#define MI_FILEFORMAT_VERSION_V5 0x0005
+
+/// Default amount of uncompressed data per chunk of a version 5 file
+#define MI_SERIALIZED_CHUNK_SIZE (4u * 1024u * 1024u)
+
+/// Alignment of the buffers of an uncompressed version 5 file
+#define MI_SERIALIZED_PAGE_SIZE 4096u
+
+/// Flags that describe the contents of a mesh in a .serialized file
+enum class SerializedFlags : uint32_t {
+    HasNormals      = 0x0001,
+    HasTexcoords    = 0x0002,
+    HasTangents     = 0x0004, // unused
+    HasColors       = 0x0008,
+    FaceNormals     = 0x0010,
+    SinglePrecision = 0x1000,
+    DoublePrecision = 0x2000,
+
+    /// Buffers are stored without compression at page-aligned offsets (version 5)
+    Uncompressed      = 0x4000,
+
+    /// Vertex normals are stored using the octahedral encoding (version 5)
+    OctahedralNormals = 0x8000,
+
+    /// Texture coordinates are stored in half precision (version 5)
+    HalfTexcoords     = 0x10000
+};
+
+/**
+ * \brief Convert a .serialized file to version 5 of the format
+ *
+ * Version 5 stores every vertex and index buffer as a sequence of
+ * independently compressed chunks, which are listed in a per-mesh chunk
+ * table. This enables the \c serialized plugin to decompress them in parallel
+ * and to skip over buffers that are not needed. When \c compress is \c false,
+ * the buffers are instead stored uncompressed at page-aligned offsets so that
+ * they can be memory-mapped.
+ *
+ * The conversion streams through the meshes of the input file (version 3 or
+ * 4) and compresses batches of chunks in parallel, hence the memory usage
+ * does not depend on the size of the meshes. Double precision data is
+ * converted to single precision.
+ *
+ * \param source
+ *     Path of the file to be converted
+ *
+ * \param target
+ *     Path of the resulting file
+ *
+ * \param compress
+ *     Compress the chunks using \c zlib?
+ *
+ * \param chunk_size
+ *     Amount of uncompressed data per chunk in bytes. Must be a multiple of
+ *     four.
+ *
+ * \param compact_normals
+ *     Store vertex normals using the octahedral encoding (4 instead of 12
+ *     bytes per vertex, see \ref encode_octahedral())
+ *
+ * \param compact_texcoords
+ *     Store texture coordinates in half precision (4 instead of 8 bytes per
+ *     vertex, see \ref encode_half2())
+ */
+extern MI_EXPORT_LIB void convert_serialized(const fs::path &source,
+                                             const fs::path &target,
+                                             bool compress = true,
+                                             uint32_t chunk_size = MI_SERIALIZED_CHUNK_SIZE,
+                                             bool compact_normals = false,
+                                             bool compact_texcoords = false);
+
+NAMESPACE_END(mitsuba)
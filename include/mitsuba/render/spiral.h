@@ -43,6 +43,21 @@ public:
     /// Reset the spiral to its initial state. Does not affect the number of passes.
     void reset();
 
+    /**
+     * \brief Only generate the blocks of one partition of the spiral
+     *
+     * Splits the blocks of every pass into \c count interleaved partitions
+     * (block \c i belongs to partition <tt>i % count</tt>) and restricts
+     * \ref next_block() to those of partition \c index. Block identifiers
+     * are unaffected, hence multiple processes can render disjoint sets of
+     * blocks and merge their results into an image that matches a
+     * single-process rendering.
+     */
+    void set_partition(uint32_t index, uint32_t count);
+
+    /// Return the number of blocks per pass in the current partition
+    uint32_t partition_block_count() const;
+
     /**
      * \brief Return the offset, size, and unique identifier of the next block.
      *
@@ -51,6 +66,10 @@ public:
     std::tuple<Vector2i, Vector2u, uint32_t> next_block();
 
     MI_DECLARE_CLASS()
+protected:
+    /// Generate the next block of the spiral (the mutex must be held)
+    std::tuple<Vector2i, Vector2u, uint32_t> next_block_unlocked();
+
 protected:
     enum class Direction { Right, Down, Left, Up };
 
@@ -66,6 +85,8 @@ protected:
     uint32_t m_block_size;    //< Size of the (square) blocks (in pixels)
     uint32_t m_steps_left;    //< Steps before next change of direction
     uint32_t m_spiral_size;   //< Current spiral size in blocks
+    uint32_t m_partition_index; //< Index of the partition to be generated
+    uint32_t m_partition_count; //< Total number of partitions
 };
 
 NAMESPACE_END(mitsuba)
@@ -147,6 +147,13 @@ if __name__ == '__main__':
         if platform.system() == 'Darwin' and 'cuda' in name:
             continue
         item = configurations[name]
+        if name.startswith('packet') or 'Packet' in item['float']:
+            raise ValueError('mitsuba.conf: configuration "%s" uses static '
+                             'Dr.Jit packets as "float" type, which is not '
+                             'supported by the renderer. Use an "llvm_*" '
+                             'variant for vectorized CPU rendering (the '
+                             'vector width can be set using "mitsuba -V").'
+                             % name)
         spectrum = item['spectrum'].replace('Float', item['float'])
         float_types.add(item['float'])
         enabled.append((name, item['float'], spectrum))
@@ -1,4 +1,6 @@
+#include <mitsuba/core/hash.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/render/bsdf.h>
@@ -26,6 +28,22 @@ Blended material (:monosp:`blendbsdf`)
    - Two nested BSDF instances that should be mixed according to the specified blending weight
    - |exposed|, |differentiable|
 
+ * - stochastic
+   - |bool|
+   - If set to |true|, every evaluation and sampling query only involves a single nested BSDF
+     that is selected randomly according to the blending weights, instead of evaluating all of
+     them. (Default: |false|)
+
+ * - flatten
+   - |bool|
+   - Collapse nested :monosp:`blendbsdf` instances into a single list of weighted lobes.
+     (Default: |true|)
+
+ * - salt
+   - |int|
+   - Seed of the stochastic lobe selection, which decorrelates the selections of different
+     blends at the same shading point. (Default: a hash of the object identifier)
+
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/bsdf_blendbsdf.jpg
    :caption: A material created by blending between rough plastic and smooth metal based on a binary bitmap texture
@@ -38,6 +56,18 @@ rough, reflecting, or transmitting) can be mixed with others in this manner to s
 The association of nested BSDF plugins with the two positions in the interpolation is based on the
 alphanumeric order of their identifiers.
 
+Blends can be nested to mix more than two materials. By default, such trees are collapsed at
+load time into a single list of leaf BSDFs whose weights are the products of the blending weights
+along the way, which avoids redundant evaluations of the intermediate nodes. The parameters of
+the nested blends remain accessible through :py:func:`mitsuba.traverse`.
+
+When :monosp:`stochastic` is enabled, each query selects a single leaf BSDF per shading point
+with probability equal to its weight, and scales its contribution accordingly. This yields an
+unbiased estimate of the blend whose cost is independent of the number of leaves, at the price
+of some additional noise. The selection is derived from a hash of the shading point and incident
+direction, so that sampling and evaluation at the same surface interaction always agree. In
+nested trees, the setting of the outermost blend applies to all collapsed nodes.
+
 The following XML snippet describes the material shown above:
 
 .. tabs::
@@ -93,10 +123,30 @@ public:
         if (bsdf_index != 2)
             Throw("BlendBSDF: Two child BSDFs must be specified!");
 
+        m_stochastic = props.get<bool>("stochastic", false);
+        m_flatten = props.get<bool>("flatten", true);
+
+        /* Derive the salt from the object identifier rather than the order in
+           which plugins are instantiated, which may vary between runs */
+        if (props.has_property("salt"))
+            m_salt = props.get<uint32_t>("salt");
+        else
+            m_salt = (uint32_t) hash(props.id());
+
+        // Gather the lobes of this node and any collapsed nested blends
+        collect_lobes(m_lobes);
+
         m_components.clear();
-        for (size_t i = 0; i < 2; ++i)
-            for (size_t j = 0; j < m_nested_bsdf[i]->component_count(); ++j)
-                m_components.push_back(m_nested_bsdf[i]->flags(j));
+        m_lobe_offsets.clear();
+        for (auto &lobe : m_lobes) {
+            m_lobe_offsets.push_back(m_components.size());
+            for (size_t j = 0; j < lobe->component_count(); ++j)
+                m_components.push_back(lobe->flags(j));
+        }
+        m_lobe_offsets.push_back(m_components.size());
+
+        // Registry of the lobes, used to dispatch queries to a single selected lobe
+        m_lobes_dr = dr::load<DynamicBuffer<BSDFPtr>>(m_lobes.data(), m_lobes.size());
 
         m_flags = m_nested_bsdf[0]->flags() | m_nested_bsdf[1]->flags();
         dr::set_attr(this, "flags", m_flags);
@@ -115,38 +165,27 @@ public:
                                              Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
 
-        Float weight = eval_weight(si, active);
+        std::vector<Float> weights = lobe_weights(si, active);
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            else
-                weight = 1.f - weight;
-            auto [bs, result] = m_nested_bsdf[sample_first ? 0 : 1]->sample(ctx2, si, sample1, sample2, active);
-            result *= weight;
+            auto [lobe, ctx2] = component_lobe(ctx);
+            auto [bs, result] = m_lobes[lobe]->sample(ctx2, si, sample1, sample2, active);
+            result *= weights[lobe];
             return { bs, result };
         }
 
-        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
-        Spectrum result(0.f);
+        /* In stochastic mode, the lobe is chosen using a sample that is
+           derived from the shading point, so that eval() and pdf() select
+           the same one. Otherwise, 'sample1' is split into subintervals. */
+        Float u = m_stochastic ? selection_sample(si) : sample1;
+        auto [lobe, weight, offset] = select_lobe(weights, u, active);
 
-        Mask m0 = active && sample1 >  weight,
-             m1 = active && sample1 <= weight;
+        if (dr::none_or<false>(active))
+            return { dr::zeros<BSDFSample3f>(), 0.f };
 
-        if (dr::any_or<true>(m0)) {
-            auto [bs0, result0] = m_nested_bsdf[0]->sample(
-                ctx, si, (sample1 - weight) / (1 - weight), sample2, m0);
-            dr::masked(bs, m0) = bs0;
-            dr::masked(result, m0) = result0;
-        }
-
-        if (dr::any_or<true>(m1)) {
-            auto [bs1, result1] = m_nested_bsdf[1]->sample(
-                ctx, si, sample1 / weight, sample2, m1);
-            dr::masked(bs, m1) = bs1;
-            dr::masked(result, m1) = result1;
-        }
+        Float sample1_k = m_stochastic ? sample1 : (sample1 - offset) / weight;
+        auto [bs, result] = lobe->sample(ctx, si, sample1_k, sample2, active);
+        if (m_stochastic)
+            result *= selection_weight(weight);
 
         return { bs, result };
     }
@@ -155,19 +194,24 @@ public:
                   const Vector3f &wo, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
 
-        Float weight = eval_weight(si, active);
+        std::vector<Float> weights = lobe_weights(si, active);
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            else
-                weight = 1.f - weight;
-            return weight * m_nested_bsdf[sample_first ? 0 : 1]->eval(ctx2, si, wo, active);
+            auto [lobe, ctx2] = component_lobe(ctx);
+            return weights[lobe] * m_lobes[lobe]->eval(ctx2, si, wo, active);
         }
 
-        return m_nested_bsdf[0]->eval(ctx, si, wo, active) * (1 - weight) +
-               m_nested_bsdf[1]->eval(ctx, si, wo, active) * weight;
+        if (m_stochastic) {
+            auto [lobe, weight, offset] =
+                select_lobe(weights, selection_sample(si), active);
+            if (dr::none_or<false>(active))
+                return 0.f;
+            return lobe->eval(ctx, si, wo, active) * selection_weight(weight);
+        }
+
+        Spectrum result(0.f);
+        for (size_t k = 0; k < m_lobes.size(); ++k)
+            result += m_lobes[k]->eval(ctx, si, wo, active) * weights[k];
+        return result;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -175,16 +219,24 @@ public:
         MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
 
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            return m_nested_bsdf[sample_first ? 0 : 1]->pdf(ctx2, si, wo, active);
+            auto [lobe, ctx2] = component_lobe(ctx);
+            return m_lobes[lobe]->pdf(ctx2, si, wo, active);
         }
 
-        Float weight = eval_weight(si, active);
-        return m_nested_bsdf[0]->pdf(ctx, si, wo, active) * (1 - weight) +
-               m_nested_bsdf[1]->pdf(ctx, si, wo, active) * weight;
+        std::vector<Float> weights = lobe_weights(si, active);
+
+        if (m_stochastic) {
+            auto [lobe, weight, offset] =
+                select_lobe(weights, selection_sample(si), active);
+            if (dr::none_or<false>(active))
+                return 0.f;
+            return lobe->pdf(ctx, si, wo, active);
+        }
+
+        Float result = 0.f;
+        for (size_t k = 0; k < m_lobes.size(); ++k)
+            result += m_lobes[k]->pdf(ctx, si, wo, active) * weights[k];
+        return result;
     }
 
     std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
@@ -193,24 +245,32 @@ public:
                                         Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
 
-        Float weight = eval_weight(si, active);
+        std::vector<Float> weights = lobe_weights(si, active);
         if (unlikely(ctx.component != (uint32_t) -1)) {
-            bool sample_first = ctx.component < m_nested_bsdf[0]->component_count();
-            BSDFContext ctx2(ctx);
-            if (!sample_first)
-                ctx2.component -= (uint32_t) m_nested_bsdf[0]->component_count();
-            else
-                weight = 1.f - weight;
+            auto [lobe, ctx2] = component_lobe(ctx);
+            auto [val, pdf] = m_lobes[lobe]->eval_pdf(ctx2, si, wo, active);
+            return { weights[lobe] * val, pdf };
+        }
 
-            auto [val, pdf] = m_nested_bsdf[sample_first ? 0 : 1]->eval_pdf(ctx2, si, wo, active);
-            return { weight * val, pdf };
+        if (m_stochastic) {
+            auto [lobe, weight, offset] =
+                select_lobe(weights, selection_sample(si), active);
+            if (dr::none_or<false>(active))
+                return { 0.f, 0.f };
+            auto [val, pdf] = lobe->eval_pdf(ctx, si, wo, active);
+            return { val * selection_weight(weight), pdf };
         }
 
-        auto [val_0, pdf_0] = m_nested_bsdf[0]->eval_pdf(ctx, si, wo, active);
-        auto [val_1, pdf_1] = m_nested_bsdf[1]->eval_pdf(ctx, si, wo, active);
+        Spectrum val(0.f);
+        Float pdf = 0.f;
 
-        return { val_0 * (1 - weight) + val_1 * weight,
-                 pdf_0 * (1 - weight) + pdf_1 * weight };
+        for (size_t k = 0; k < m_lobes.size(); ++k) {
+            auto [val_k, pdf_k] = m_lobes[k]->eval_pdf(ctx, si, wo, active);
+            val += val_k * weights[k];
+            pdf += pdf_k * weights[k];
+        }
+
+        return { val, pdf };
     }
 
     MI_INLINE Float eval_weight(const SurfaceInteraction3f &si, const Mask &active) const {
@@ -221,6 +281,8 @@ public:
         std::ostringstream oss;
         oss << "BlendBSDF[" << std::endl
             << "  weight = " << string::indent(m_weight) << "," << std::endl
+            << "  stochastic = " << m_stochastic << "," << std::endl
+            << "  lobes = " << m_lobes.size() << "," << std::endl
             << "  nested_bsdf[0] = " << string::indent(m_nested_bsdf[0]) << "," << std::endl
             << "  nested_bsdf[1] = " << string::indent(m_nested_bsdf[1]) << std::endl
             << "]";
@@ -228,9 +290,135 @@ public:
     }
 
     MI_DECLARE_CLASS()
+protected:
+    /// Return nested child \c i if it is a blend that should be collapsed into this one
+    const BlendBSDF *flattened_child(size_t i) const {
+        if (!m_flatten)
+            return nullptr;
+        return dynamic_cast<const BlendBSDF *>(m_nested_bsdf[i].get());
+    }
+
+    /// Append the leaves of the (flattened) blend tree below this node
+    void collect_lobes(std::vector<ref<Base>> &lobes) const {
+        for (size_t i = 0; i < 2; ++i) {
+            if (const BlendBSDF *nested = flattened_child(i))
+                nested->collect_lobes(lobes);
+            else
+                lobes.push_back(m_nested_bsdf[i]);
+        }
+    }
+
+    /// Append the weights of the lobes found by \ref collect_lobes()
+    void append_weights(const SurfaceInteraction3f &si, const Mask &active,
+                        const Float &scale, std::vector<Float> &weights) const {
+        Float weight = eval_weight(si, active);
+        for (size_t i = 0; i < 2; ++i) {
+            Float w = scale * (i == 0 ? 1.f - weight : weight);
+            if (const BlendBSDF *nested = flattened_child(i))
+                nested->append_weights(si, active, w, weights);
+            else
+                weights.push_back(w);
+        }
+    }
+
+    /// Evaluate the blending weights of all lobes, which sum to one
+    std::vector<Float> lobe_weights(const SurfaceInteraction3f &si,
+                                    const Mask &active) const {
+        std::vector<Float> weights;
+        weights.reserve(m_lobes.size());
+        append_weights(si, active, 1.f, weights);
+        return weights;
+    }
+
+    /// Find the lobe that provides the component requested by \c ctx
+    std::pair<size_t, BSDFContext> component_lobe(const BSDFContext &ctx) const {
+        size_t lobe = 0;
+        while (ctx.component >= m_lobe_offsets[lobe + 1])
+            ++lobe;
+        BSDFContext ctx2(ctx);
+        ctx2.component -= (uint32_t) m_lobe_offsets[lobe];
+        return { lobe, ctx2 };
+    }
+
+    /**
+     * \brief Pseudorandom number used for stochastic lobe selection
+     *
+     * It is a hash of the shading point and incident direction, which differs
+     * between the samples of a pixel while being consistent between the
+     * sample(), eval() and pdf() queries at the same surface interaction.
+     */
+    Float selection_sample(const SurfaceInteraction3f &si) const {
+        auto bits = [](const Float &value) {
+            return dr::reinterpret_array<UInt32>(dr::float32_array_t<Float>(value));
+        };
+
+        auto [v0, v1] = sample_tea_32(bits(si.p.x()) ^ m_salt,
+                                      bits(si.p.y()) ^ bits(si.wi.x()), 2);
+        return Float(sample_tea_float32(v0 ^ bits(si.p.z()) ^ bits(si.wi.y()),
+                                        v1 ^ bits(si.wi.z())));
+    }
+
+    /**
+     * \brief Select a lobe with probability equal to its weight
+     *
+     * Returns a pointer to the lobe whose interval contains the sample \c u,
+     * along with its weight and the start of its interval. The lobe is looked
+     * up in the registry, so that the caller can dispatch the query with a
+     * single virtual function call. Lanes that select no lobe are disabled in
+     * \c active.
+     */
+    std::tuple<BSDFPtr, Float, Float> select_lobe(const std::vector<Float> &weights,
+                                                  const Float &u, Mask &active) const {
+        UInt32 index = 0;
+        Float weight = 0.f, offset = 0.f, lo = 0.f;
+        Mask selected = false;
+        for (size_t k = m_lobes.size(); k-- > 0; ) {
+            Float hi = lo + weights[k];
+            Mask mk = selects(k, u, lo, hi);
+            dr::masked(index, mk) = (uint32_t) k;
+            dr::masked(weight, mk) = weights[k];
+            dr::masked(offset, mk) = lo;
+            selected |= mk;
+            lo = hi;
+        }
+        active &= selected;
+        return { dr::gather<BSDFPtr>(m_lobes_dr, index, active), weight, offset };
+    }
+
+    /**
+     * \brief Lanes whose sample \c u falls into the interval <tt>[lo, hi)</tt>
+     * of lobe \c k
+     *
+     * Empty intervals (lobes with a zero weight) are never selected. The
+     * interval of the lobe that is visited last (<tt>k == 0</tt>) extends to
+     * one to account for rounding errors in the sum of the weights.
+     */
+    static Mask selects(size_t k, const Float &u, const Float &lo, const Float &hi) {
+        Mask result = hi > lo && u >= lo;
+        if (k != 0)
+            result &= u < hi;
+        return result;
+    }
+
+    /* Stochastic selection cancels the lobe weight, but its derivative must
+       still be propagated to the weight texture */
+    static Float selection_weight(const Float &weight) {
+        Float weight_d = dr::detach(weight);
+        return dr::select(weight_d > 0.f, weight / weight_d, 0.f);
+    }
+
 protected:
     ref<Texture> m_weight;
     ref<Base> m_nested_bsdf[2];
+
+    /// Leaves of the flattened blend tree, and offsets of their components
+    std::vector<ref<Base>> m_lobes;
+    std::vector<size_t> m_lobe_offsets;
+    DynamicBuffer<BSDFPtr> m_lobes_dr;
+
+    bool m_stochastic;
+    bool m_flatten;
+    uint32_t m_salt;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(BlendBSDF, BSDF)
@@ -184,3 +184,112 @@ def test05_sample_components(variant_scalar_rgb):
     expected_b = weight*1.0    # InvPi will cancel out with sampling pdf, but still need to apply weight
     bs_b, weight_b = bsdf.sample(ctx, si, 0.3, [0.5, 0.5])
     assert dr.allclose(weight_b, expected_b)
+
+
+def nested_blend_dict(**kwargs):
+    def diffuse(value):
+        return { 'type': 'diffuse', 'reflectance': { 'type': 'rgb', 'value': value } }
+
+    d = {
+        'type': 'blendbsdf',
+        'weight': 0.25,
+        'nested1': diffuse(0.2),
+        'nested2': {
+            'type': 'blendbsdf',
+            'weight': 0.4,
+            'nested1': diffuse(0.5),
+            'nested2': { 'type': 'roughconductor' },
+        }
+    }
+    d.update(kwargs)
+    d['nested2'].update(kwargs)
+    return d
+
+
+def test06_flatten(variant_scalar_rgb):
+    bsdf = mi.load_dict(nested_blend_dict())
+    assert 'lobes = 3' in str(bsdf)
+    assert bsdf.component_count() == 3
+    assert bsdf.flags(2) == mi.BSDFFlags.GlossyReflection | mi.BSDFFlags.FrontSide
+
+    ref = mi.load_dict(nested_blend_dict(flatten=False))
+    assert 'lobes = 2' in str(ref)
+
+    si = mi.SurfaceInteraction3f()
+    si.p = [0, 0, 0]
+    si.n = [0, 0, 1]
+    si.sh_frame = mi.Frame3f(si.n)
+    si.wi = dr.normalize(mi.Vector3f(0.3, 0.1, 1))
+    wo = dr.normalize(mi.Vector3f(-0.2, 0.1, 1))
+    ctx = mi.BSDFContext()
+
+    assert dr.allclose(bsdf.eval(ctx, si, wo), ref.eval(ctx, si, wo))
+    assert dr.allclose(bsdf.pdf(ctx, si, wo), ref.pdf(ctx, si, wo))
+
+    # Individual components carry the product of the weights along the tree
+    ctx.component = 1
+    assert dr.allclose(bsdf.eval(ctx, si, wo), 0.25 * 0.6 * 0.5 * dr.inv_pi * wo.z)
+
+    # Sampling maps 'sample1' onto the same lobes
+    ctx = mi.BSDFContext()
+    for sample1 in [0.05, 0.2, 0.5, 0.9]:
+        bs, weight = bsdf.sample(ctx, si, sample1, [0.3, 0.6])
+        bs_ref, weight_ref = ref.sample(ctx, si, sample1, [0.3, 0.6])
+        assert dr.allclose(bs.wo, bs_ref.wo)
+        assert dr.allclose(weight, weight_ref)
+
+
+def test07_stochastic(variants_vec_rgb):
+    bsdf = mi.load_dict(nested_blend_dict(stochastic=True))
+    ref = mi.load_dict(nested_blend_dict())
+
+    n = 1000000
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.p = mi.Point3f(dr.linspace(mi.Float, 0, 1, n), 0.5, 0)
+    si.n = mi.Normal3f(0, 0, 1)
+    si.sh_frame = mi.Frame3f(si.n)
+    si.wi = dr.normalize(mi.Vector3f(0.3, 0.1, 1))
+    wo = dr.normalize(mi.Vector3f(-0.2, 0.1, 1))
+    ctx = mi.BSDFContext()
+
+    # Each lane picks a single lobe, the average matches the full blend
+    value = bsdf.eval(ctx, si, wo)
+    assert dr.allclose(dr.mean(value), dr.mean(ref.eval(ctx, si, wo)), rtol=1e-2)
+
+    # Sampling and evaluation select the same lobe
+    bs, weight = bsdf.sample(ctx, si, 0.5, [0.3, 0.6])
+    value, pdf = bsdf.eval_pdf(ctx, si, bs.wo)
+    active = bs.pdf > 0
+    assert dr.allclose(dr.select(active, pdf, 0), dr.select(active, bs.pdf, 0), rtol=1e-3)
+    assert dr.allclose(dr.select(active, weight, 0),
+                       dr.select(active, value / pdf, 0), rtol=1e-3)
+
+
+def test08_stochastic_zero_weight(variants_vec_rgb):
+    # Lobes with a zero weight are never selected, and the selection does
+    # not depend on the order in which the plugins were instantiated
+    n = 100000
+    si = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.p = mi.Point3f(dr.linspace(mi.Float, 0, 1, n), 0.5, 0)
+    si.n = mi.Normal3f(0, 0, 1)
+    si.sh_frame = mi.Frame3f(si.n)
+    si.wi = dr.normalize(mi.Vector3f(0.3, 0.1, 1))
+    wo = dr.normalize(mi.Vector3f(-0.2, 0.1, 1))
+    ctx = mi.BSDFContext()
+
+    for weight in [0.0, 1.0]:
+        bsdf = mi.load_dict(nested_blend_dict(stochastic=True, weight=weight))
+        ref = mi.load_dict(nested_blend_dict(weight=weight))
+
+        value, pdf = bsdf.eval_pdf(ctx, si, wo)
+        value_ref, pdf_ref = ref.eval_pdf(ctx, si, wo)
+        assert dr.all_nested(dr.isfinite(value)) and dr.all(dr.isfinite(pdf))
+        assert dr.allclose(value, value_ref)
+        assert dr.allclose(pdf, pdf_ref)
+
+        bs, bs_weight = bsdf.sample(ctx, si, 0.5, [0.3, 0.6])
+        assert dr.all_nested(dr.isfinite(bs_weight))
+
+    bsdf_1 = mi.load_dict(nested_blend_dict(stochastic=True))
+    bsdf_2 = mi.load_dict(nested_blend_dict(stochastic=True))
+    assert dr.all_nested(dr.eq(bsdf_1.eval(ctx, si, wo), bsdf_2.eval(ctx, si, wo)))
@@ -8,6 +8,7 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/profiler.h>
 #include <unordered_map>
+#include <mutex>
 
 #include <nanothread/nanothread.h>
 #include <drjit/half.h>
@@ -36,9 +37,18 @@ extern "C" {
 #endif
 
 #include <ImfInputFile.h>
+#include <ImfInputPart.h>
+#include <ImfTiledInputPart.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfMultiPartOutputFile.h>
+#include <ImfOutputPart.h>
+#include <ImfTiledOutputPart.h>
+#include <ImfPartType.h>
 #include <ImfStandardAttributes.h>
 #include <ImfRgbaYca.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
+#include <ImfTileDescription.h>
 #include <ImfChannelList.h>
 #include <ImfStringAttribute.h>
 #include <ImfIntAttribute.h>
@@ -115,6 +125,15 @@ Bitmap::Bitmap(const fs::path &filename, FileFormat format) {
     read(fs, format);
 }
 
+Bitmap::Bitmap(Stream *stream, const EXRRegion &region) {
+    read_exr(stream, region);
+}
+
+Bitmap::Bitmap(const fs::path &filename, const EXRRegion &region) {
+    ref<FileStream> fs = new FileStream(filename);
+    read_exr(fs, region);
+}
+
 Bitmap::~Bitmap() {
     if (!m_owns_data)
         m_data.release();
@@ -688,7 +707,7 @@ void Bitmap::read(Stream *stream, FileFormat format) {
     switch (format) {
         case FileFormat::BMP:     read_bmp(stream);   break;
         case FileFormat::JPEG:    read_jpeg(stream);  break;
-        case FileFormat::OpenEXR: read_exr(stream);   break;
+        case FileFormat::OpenEXR: read_exr(stream, EXRRegion()); break;
         case FileFormat::RGBE:    read_rgbe(stream);  break;
         case FileFormat::PFM:     read_pfm(stream);   break;
         case FileFormat::PPM:     read_ppm(stream);   break;
@@ -927,24 +946,117 @@ public:
     void finish() override { }
 };
 
-void Bitmap::read_exr(Stream *stream) {
+/**
+ * Read the pixels within \c window (a subset of the data window of the given
+ * part and mip-map level) into \c target, whose pixels have the layout
+ * \c struct_. OpenEXR decodes entire tiles and scanlines, hence they are first
+ * written to a staging buffer that covers one row of tiles or a band of
+ * scanlines at a time.
+ */
+static void read_exr_window(Imf::MultiPartInputFile &file, int part_index,
+                            int level, const Imath::Box2i &data_window,
+                            const Imath::Box2i &window, const Struct *struct_,
+                            Imf::PixelType pixel_type, uint8_t *target) {
+    size_t pixel_stride = struct_->size(),
+           window_row = (size_t) (window.max.x - window.min.x + 1) * pixel_stride;
+    std::unique_ptr<uint8_t[]> buffer;
+
+    // Frame buffer for a staging area of width 'width' that starts at (x0, y0)
+    auto staging_framebuffer = [&](int x0, int y0, size_t width) {
+        ptrdiff_t row_stride = (ptrdiff_t) (width * pixel_stride);
+        uint8_t *ptr = buffer.get() - x0 * (ptrdiff_t) pixel_stride - y0 * row_stride;
+
+        Imf::FrameBuffer framebuffer;
+        for (auto const &field : *struct_)
+            framebuffer.insert(field.name,
+                               Imf::Slice(pixel_type, (char *) (ptr + field.offset),
+                                          pixel_stride, (size_t) row_stride));
+        return framebuffer;
+    };
+
+    // Copy the rows [y_begin, y_end] of the window from the staging area
+    auto copy_rows = [&](int x0, int y0, size_t width, int y_begin, int y_end) {
+        for (int y = y_begin; y <= y_end; ++y)
+            memcpy(target + (size_t) (y - window.min.y) * window_row,
+                   buffer.get() + ((size_t) (y - y0) * width +
+                                   (size_t) (window.min.x - x0)) * pixel_stride,
+                   window_row);
+    };
+
+    if (file.header(part_index).hasTileDescription()) {
+        Imf::TiledInputPart part(file, part_index);
+        int tile_width  = (int) part.tileXSize(),
+            tile_height = (int) part.tileYSize(),
+            tx0 = (window.min.x - data_window.min.x) / tile_width,
+            tx1 = (window.max.x - data_window.min.x) / tile_width,
+            ty0 = (window.min.y - data_window.min.y) / tile_height,
+            ty1 = (window.max.y - data_window.min.y) / tile_height;
+
+        size_t width = (size_t) (tx1 - tx0 + 1) * tile_width;
+        buffer.reset(new uint8_t[width * tile_height * pixel_stride]);
+
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            int x0 = data_window.min.x + tx0 * tile_width,
+                y0 = data_window.min.y + ty * tile_height;
+            part.setFrameBuffer(staging_framebuffer(x0, y0, width));
+            part.readTiles(tx0, tx1, ty, ty, level, level);
+            copy_rows(x0, y0, width, std::max(y0, window.min.y),
+                      std::min(y0 + tile_height - 1, window.max.y));
+        }
+    } else {
+        /* Number of scanlines decoded at once. This is a multiple of the
+           block size of all compression methods except for DWAB, hence the
+           bands (which are aligned to the data window) rarely share blocks */
+        const int band = 64;
+
+        Imf::InputPart part(file, part_index);
+        size_t width = (size_t) (data_window.max.x - data_window.min.x + 1);
+        buffer.reset(new uint8_t[width * band * pixel_stride]);
+
+        for (int y0 = window.min.y; y0 <= window.max.y; ) {
+            int y1 = std::min(data_window.min.y +
+                                  ((y0 - data_window.min.y) / band + 1) * band - 1,
+                              window.max.y);
+            part.setFrameBuffer(staging_framebuffer(data_window.min.x, y0, width));
+            part.readPixels(y0, y1);
+            copy_rows(data_window.min.x, y0, width, y0, y1);
+            y0 = y1 + 1;
+        }
+    }
+}
+
+void Bitmap::read_exr(Stream *stream, const EXRRegion &region) {
     ScopedPhase phase(ProfilerPhase::BitmapRead);
 
     EXRIStream istr(stream);
-    Imf::InputFile file(istr);
+    Imf::MultiPartInputFile file(istr);
 
-    const Imf::Header &header = file.header();
+    if (region.part >= (uint32_t) file.parts())
+        Throw("read_exr(): Invalid part index %u (the image has %i parts)!",
+              region.part, file.parts());
+
+    const Imf::Header &header = file.header((int) region.part);
     const Imf::ChannelList &channels = header.channels();
 
     if (channels.begin() == channels.end())
         Throw("read_exr(): Image does not contain any channels!");
 
+    for (const std::string &name : region.channels) {
+        if (!channels.findChannel(name))
+            Throw("read_exr(): Image does not contain a channel named \"%s\"!",
+                  name);
+    }
+
     // Load metadata if present
     for (auto it = header.begin(); it != header.end(); ++it) {
         std::string name = it.name();
         const Imf::Attribute *attr = &it.attribute();
         std::string type_name = attr->typeName();
 
+        // Skip attributes describing the layout of multi-part files
+        if (name == "name" || name == "type" || name == "chunkCount")
+            continue;
+
         if (type_name == "string") {
             auto v = static_cast<const Imf::StringAttribute *>(attr);
             m_metadata.set_string(name, v->value());
@@ -976,7 +1088,9 @@ void Bitmap::read_exr(Stream *stream) {
     m_premultiplied_alpha = true;
     m_pixel_format = PixelFormat::MultiChannel;
     m_struct = new Struct();
-    Imf::PixelType pixel_type = channels.begin().channel().type;
+    Imf::PixelType pixel_type = region.channels.empty()
+                                    ? channels.begin().channel().type
+                                    : channels[region.channels[0]].type;
 
     switch (pixel_type) {
         case Imf::HALF:  m_component_format = Struct::Type::Float16; break;
@@ -1024,6 +1138,10 @@ void Bitmap::read_exr(Stream *stream) {
     std::vector<std::string> channels_sorted;
     for (auto it = channels.begin(); it != channels.end(); ++it) {
         std::string name(it.name());
+        if (!region.channels.empty() &&
+            std::find(region.channels.begin(), region.channels.end(), name) ==
+                region.channels.end())
+            continue;
         found[channel_class(name)] = true;
         channels_sorted.push_back(name);
     }
@@ -1078,8 +1196,8 @@ void Bitmap::read_exr(Stream *stream) {
 
     // Check if there is a chromaticity header entry
     Imf::Chromaticities file_chroma;
-    if (Imf::hasChromaticities(file.header()))
-        file_chroma = Imf::chromaticities(file.header());
+    if (Imf::hasChromaticities(header))
+        file_chroma = Imf::chromaticities(header);
 
     auto chroma_eq = [](const Imf::Chromaticities &a,
                         const Imf::Chromaticities &b) {
@@ -1096,9 +1214,41 @@ void Bitmap::read_exr(Stream *stream) {
         return name;
     };
 
-    Imath::Box2i data_window = file.header().dataWindow();
-    m_size = Vector2u(data_window.max.x - data_window.min.x + 1,
-                      data_window.max.y - data_window.min.y + 1);
+    Imath::Box2i data_window = header.dataWindow();
+    if (region.level > 0) {
+        if (!header.hasTileDescription())
+            Throw("read_exr(): Mip-map level %u was requested, but the image "
+                  "is not tiled!", region.level);
+        Imf::TiledInputPart part(file, (int) region.part);
+        if (!part.isValidLevel((int) region.level, (int) region.level))
+            Throw("read_exr(): Invalid mip-map level %u (the image has %i "
+                  "levels)!", region.level, part.numXLevels());
+        data_window = part.dataWindowForLevel((int) region.level,
+                                              (int) region.level);
+    }
+
+    Vector2u full_size(data_window.max.x - data_window.min.x + 1,
+                       data_window.max.y - data_window.min.y + 1);
+
+    // Determine the window to be loaded (by default, the entire data window)
+    m_size = region.size;
+    for (size_t i = 0; i < 2; ++i) {
+        if (m_size[i] == 0 && region.offset[i] < full_size[i])
+            m_size[i] = full_size[i] - region.offset[i];
+    }
+
+    if (dr::any(m_size == 0u) || dr::any(region.offset + m_size > full_size))
+        Throw("read_exr(): The requested window (offset %s, size %s) is not "
+              "contained in the data window (size %s)!", region.offset,
+              m_size, full_size);
+
+    Imath::Box2i window(
+        Imath::V2i(data_window.min.x + (int) region.offset.x(),
+                   data_window.min.y + (int) region.offset.y()),
+        Imath::V2i(data_window.min.x + (int) (region.offset.x() + m_size.x()) - 1,
+                   data_window.min.y + (int) (region.offset.y() + m_size.y()) - 1));
+
+    bool partial = region.level > 0 || window != data_window;
 
     // Compute pixel / row strides
     size_t pixel_stride = bytes_per_pixel(),
@@ -1122,6 +1272,10 @@ void Bitmap::read_exr(Stream *stream) {
         Vector2i sampling(channel.xSampling, channel.ySampling);
         Imf::Slice slice;
 
+        if (partial && sampling != Vector2i(1))
+            Throw("read_exr(): Loading a region of an image with sub-sampled "
+                  "channels is unsupported!");
+
         if (sampling == Vector2i(1)) {
             // This is a full resolution channel. Load the ordinary way
             slice = Imf::Slice(pixel_type, (char *) (ptr + field.offset),
@@ -1151,8 +1305,14 @@ void Bitmap::read_exr(Stream *stream) {
         fs ? fs->path().string() : "<stream>", m_size.x(), m_size.y(),
         m_pixel_format, m_component_format);
 
-    file.setFrameBuffer(framebuffer);
-    file.readPixels(data_window.min.y, data_window.max.y);
+    if (partial) {
+        read_exr_window(file, (int) region.part, (int) region.level,
+                        data_window, window, m_struct, pixel_type, m_data.get());
+    } else {
+        Imf::InputPart part(file, (int) region.part);
+        part.setFrameBuffer(framebuffer);
+        part.readPixels(data_window.min.y, data_window.max.y);
+    }
 
     for (auto &buf: resample_buffers) {
         Log(Debug, "Upsampling layer \"%s\" from %ix%i to %ix%i pixels",
@@ -1221,7 +1381,7 @@ void Bitmap::read_exr(Stream *stream) {
         }
     }
 
-    if (Imf::hasChromaticities(file.header()) &&
+    if (Imf::hasChromaticities(header) &&
         (m_pixel_format == PixelFormat::RGB || m_pixel_format == PixelFormat::RGBA)) {
 
         Imf::Chromaticities itu_rec_b_709;
@@ -1288,24 +1448,36 @@ void Bitmap::read_exr(Stream *stream) {
     }
 }
 
-void Bitmap::write_exr(Stream *stream, int quality) const {
-    ScopedPhase phase(ProfilerPhase::BitmapWrite);
+/// Map a component format onto the corresponding OpenEXR pixel type
+static Imf::PixelType exr_pixel_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Float32: return Imf::FLOAT;
+        case Struct::Type::Float16: return Imf::HALF;
+        case Struct::Type::UInt32: return Imf::UINT;
+        default: Throw("Unexpected field type!");
+    }
+}
 
-    PixelFormat pixel_format = m_pixel_format;
+/// Create an OpenEXR header describing the metadata and channels of a bitmap
+static Imf::Header exr_header(const Bitmap *bitmap, const Bitmap::Vector2u &size,
+                              Imf::LineOrder line_order, int quality) {
+    using Vector3f = Bitmap::Vector3f;
+    using Matrix4f = Bitmap::Matrix4f;
+    using ScalarTransform4f = Bitmap::ScalarTransform4f;
 
-    Properties metadata(m_metadata);
+    Properties metadata(bitmap->metadata());
     if (!metadata.has_property("generatedBy"))
         metadata.set_string("generatedBy", "Mitsuba version " MI_VERSION);
 
     std::vector<std::string> keys = metadata.property_names();
 
     Imf::Header header(
-        (int) m_size.x(),  // width
-        (int) m_size.y(),  // height,
+        (int) size.x(),    // width
+        (int) size.y(),    // height,
         1.f,               // pixelAspectRatio
         Imath::V2f(0, 0),  // screenWindowCenter,
         1.f,               // screenWindowWidth
-        Imf::INCREASING_Y, // lineOrder
+        line_order,        // lineOrder
         quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
     );
 
@@ -1320,6 +1492,10 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
             *it == "screenWindowCenter")
             continue;
 
+        // Attributes describing the layout of multi-part files
+        if (*it == "name" || *it == "type" || *it == "chunkCount")
+            continue;
+
         switch (type) {
             case Type::String:
                 header.insert(it->c_str(), Imf::StringAttribute(metadata.string(*it)));
@@ -1355,7 +1531,9 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
         }
     }
 
-    if (pixel_format == PixelFormat::XYZ || pixel_format == PixelFormat::XYZA) {
+    Bitmap::PixelFormat pixel_format = bitmap->pixel_format();
+    if (pixel_format == Bitmap::PixelFormat::XYZ ||
+        pixel_format == Bitmap::PixelFormat::XYZA) {
         Imf::addChromaticities(header, Imf::Chromaticities(
             Imath::V2f(1.f, 0.f),
             Imath::V2f(0.f, 1.f),
@@ -1363,32 +1541,209 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
             Imath::V2f(1.f / 3.f, 1.f / 3.f)));
     }
 
-    size_t pixel_stride = m_struct->size(),
-           row_stride = pixel_stride * m_size.x();
-
     Imf::ChannelList &channels = header.channels();
-    Imf::FrameBuffer framebuffer;
-    const uint8_t *ptr = uint8_data();
-    for (auto field : *m_struct) {
-        Imf::PixelType comp_type;
-        switch (field.type) {
-            case Struct::Type::Float32: comp_type = Imf::FLOAT; break;
-            case Struct::Type::Float16: comp_type = Imf::HALF; break;
-            case Struct::Type::UInt32: comp_type = Imf::UINT; break;
-            default: Throw("Unexpected field type!");
-        }
+    for (auto field : *bitmap->struct_())
+        channels.insert(field.name, Imf::Channel(exr_pixel_type(field.type)));
+
+    return header;
+}
 
-        Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
-        channels.insert(field.name, Imf::Channel(comp_type));
+/**
+ * Create an OpenEXR frame buffer referencing the pixels of a bitmap, whose
+ * top left corner is located at position \c offset of the data window
+ */
+static Imf::FrameBuffer exr_framebuffer(const Bitmap *bitmap,
+                                        const Bitmap::Vector2u &offset = 0) {
+    size_t pixel_stride = bitmap->struct_()->size(),
+           row_stride = pixel_stride * bitmap->width();
+
+    /* OpenEXR addresses pixels relative to the origin of the data window,
+       shift the base pointer accordingly (this may leave the buffer) */
+    const char *ptr = (const char *) bitmap->uint8_data() -
+                      offset.x() * pixel_stride - offset.y() * row_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (auto field : *bitmap->struct_()) {
+        Imf::Slice slice(exr_pixel_type(field.type),
+                         (char *) (ptr + field.offset), pixel_stride,
+                         row_stride);
         framebuffer.insert(field.name, slice);
     }
 
+    return framebuffer;
+}
+
+void Bitmap::write_exr(Stream *stream, int quality) const {
+    ScopedPhase phase(ProfilerPhase::BitmapWrite);
+
+    Imf::Header header = exr_header(this, m_size, Imf::INCREASING_Y, quality);
+
     EXROStream ostr(stream);
     Imf::OutputFile file(ostr, header);
-    file.setFrameBuffer(framebuffer);
+    file.setFrameBuffer(exr_framebuffer(this));
     file.writePixels((int) m_size.y());
 }
 
+void Bitmap::write_exr(Stream *stream,
+                       const std::vector<std::pair<std::string, ref<Bitmap>>> &parts,
+                       uint32_t tile_size, bool mipmap, int quality) {
+    ScopedPhase phase(ProfilerPhase::BitmapWrite);
+
+    if (parts.empty())
+        Throw("write_exr(): at least one part must be specified!");
+    if (mipmap && tile_size == 0)
+        Throw("write_exr(): mip-maps can only be stored in tiled files!");
+
+    std::vector<Imf::Header> headers;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const Bitmap *bitmap = parts[i].second.get();
+        if (mipmap && !Struct::is_float(bitmap->component_format()))
+            Throw("write_exr(): mip-maps require floating point data!");
+
+        Imf::Header header = exr_header(bitmap, bitmap->size(),
+                                        Imf::INCREASING_Y, quality);
+
+        const std::string &name = parts[i].first;
+        header.setName(name.empty() ? tfm::format("part%zu", i) : name);
+
+        if (tile_size > 0) {
+            header.setType(Imf::TILEDIMAGE);
+            header.setTileDescription(Imf::TileDescription(
+                tile_size, tile_size,
+                mipmap ? Imf::MIPMAP_LEVELS : Imf::ONE_LEVEL,
+                Imf::ROUND_DOWN));
+        } else {
+            header.setType(Imf::SCANLINEIMAGE);
+        }
+
+        headers.push_back(header);
+    }
+
+    EXROStream ostr(stream);
+    Imf::MultiPartOutputFile file(ostr, headers.data(), (int) headers.size());
+
+    // Box filter used to compute the mip-map pyramid
+    ref<ReconstructionFilter> box;
+    if (mipmap)
+        box = PluginManager::instance()->create_object<ReconstructionFilter>(
+            Properties("box"));
+
+    for (size_t i = 0; i < parts.size(); ++i) {
+        ref<const Bitmap> bitmap = parts[i].second;
+
+        if (tile_size == 0) {
+            Imf::OutputPart part(file, (int) i);
+            part.setFrameBuffer(exr_framebuffer(bitmap));
+            part.writePixels((int) bitmap->height());
+            continue;
+        }
+
+        Imf::TiledOutputPart part(file, (int) i);
+        for (int level = 0; level < part.numLevels(); ++level) {
+            // Each level is downsampled from the previous one
+            if (level > 0)
+                bitmap = bitmap->resample(
+                    ScalarVector2u(part.levelWidth(level), part.levelHeight(level)),
+                    box);
+
+            part.setFrameBuffer(exr_framebuffer(bitmap));
+            part.writeTiles(0, part.numXTiles(level) - 1,
+                            0, part.numYTiles(level) - 1, level);
+        }
+    }
+}
+
+void Bitmap::write_exr(const fs::path &path,
+                       const std::vector<std::pair<std::string, ref<Bitmap>>> &parts,
+                       uint32_t tile_size, bool mipmap, int quality) {
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    write_exr(fs, parts, tile_size, mipmap, quality);
+}
+
+// -----------------------------------------------------------------------------
+//   Tiled OpenEXR output
+// -----------------------------------------------------------------------------
+
+struct TiledEXRWriter::TiledEXRWriterPrivate {
+    fs::path path;
+    ref<Stream> stream;
+    std::unique_ptr<EXROStream> ostr;
+    std::unique_ptr<Imf::TiledOutputFile> file;
+    std::mutex mutex;
+};
+
+TiledEXRWriter::TiledEXRWriter(const fs::path &path, const Bitmap *layout,
+                               const Vector2u &size, uint32_t tile_size,
+                               int quality)
+    : m_size(size), m_tile_size(tile_size), d(new TiledEXRWriterPrivate()) {
+    if (tile_size == 0 || dr::any(size == 0u))
+        Throw("TiledEXRWriter: invalid image (%s) or tile size (%u)!", size,
+              tile_size);
+
+    Imf::Header header = exr_header(layout, size, Imf::RANDOM_Y, quality);
+    header.setTileDescription(
+        Imf::TileDescription(tile_size, tile_size, Imf::ONE_LEVEL));
+
+    d->path = path;
+    d->stream = new FileStream(path, FileStream::ETruncReadWrite);
+    d->ostr.reset(new EXROStream(d->stream));
+    d->file.reset(new Imf::TiledOutputFile(*d->ostr, header));
+}
+
+TiledEXRWriter::~TiledEXRWriter() {
+    try {
+        close();
+    } catch (const std::exception &e) {
+        Log(Warn, "TiledEXRWriter: could not finish \"%s\": %s",
+            d->path.string(), e.what());
+    }
+}
+
+TiledEXRWriter::Vector2u TiledEXRWriter::tile_count() const {
+    return (m_size + m_tile_size - 1u) / m_tile_size;
+}
+
+void TiledEXRWriter::write_tile(const Vector2u &tile, const Bitmap *bitmap) {
+    ScopedPhase phase(ProfilerPhase::BitmapWrite);
+
+    Vector2u offset = tile * m_tile_size,
+             size   = dr::minimum(m_tile_size, m_size - offset);
+
+    if (dr::any(tile >= tile_count()))
+        Throw("TiledEXRWriter::write_tile(): tile %s is out of bounds!", tile);
+    if (bitmap->size() != size)
+        Throw("TiledEXRWriter::write_tile(): expected a bitmap of size %s, "
+              "got %s!", size, bitmap->size());
+
+    std::lock_guard<std::mutex> lock(d->mutex);
+    if (!d->file)
+        Throw("TiledEXRWriter::write_tile(): the file was already closed!");
+
+    d->file->setFrameBuffer(exr_framebuffer(bitmap, offset));
+    d->file->writeTile((int) tile.x(), (int) tile.y());
+}
+
+void TiledEXRWriter::close() {
+    std::lock_guard<std::mutex> lock(d->mutex);
+    if (!d->file)
+        return;
+
+    // Tiles that were never written are left blank by OpenEXR
+    d->file.reset();
+    d->ostr.reset();
+    d->stream->close();
+}
+
+std::string TiledEXRWriter::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledEXRWriter[" << std::endl
+        << "  path = \"" << d->path.string() << "\"," << std::endl
+        << "  size = " << m_size << "," << std::endl
+        << "  tile_size = " << m_tile_size << std::endl
+        << "]";
+    return oss.str();
+}
+
 // -----------------------------------------------------------------------------
 //   JPEG bitmap I/O
 // -----------------------------------------------------------------------------
@@ -2504,5 +2859,6 @@ void Bitmap::static_initialization() {
 void Bitmap::static_shutdown() { }
 
 MI_IMPLEMENT_CLASS(Bitmap, Object)
+MI_IMPLEMENT_CLASS(TiledEXRWriter, Object)
 
 NAMESPACE_END(mitsuba)
@@ -133,6 +133,19 @@ size_t file_size(const path& p) {
     return (size_t) sb.st_size;
 }
 
+int64_t last_write_time(const path& p) {
+#if defined(_WIN32)
+    struct _stati64 sb;
+    if (_wstati64(p.native().c_str(), &sb) != 0)
+        throw std::runtime_error("filesystem::last_write_time(): cannot stat file \"" + p.string() + "\"!");
+#else
+    struct stat sb;
+    if (stat(p.native().c_str(), &sb) != 0)
+        throw std::runtime_error("filesystem::last_write_time(): cannot stat file \"" + p.string() + "\"!");
+#endif
+    return (int64_t) sb.st_mtime;
+}
+
 bool equivalent(const path& p1, const path& p2) {
 #if defined(_WIN32)
     struct _stati64 sb1, sb2;
@@ -16,8 +16,33 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+
+struct StaticPlugin {
+    const char *class_name;
+    const char *descr;
+};
+
+/// Registry of the plugins linked into the library (filled during static initialization)
+static std::unordered_map<std::string, StaticPlugin> &static_plugins() {
+    static std::unordered_map<std::string, StaticPlugin> plugins;
+    return plugins;
+}
+
+bool register_static_plugin(const char *name, const char *class_name,
+                            const char *descr) {
+    static_plugins()[name] = { class_name, descr };
+    return true;
+}
+
+NAMESPACE_END(detail)
+
 class Plugin {
 public:
+    /// Wrap a plugin that was linked into the library
+    Plugin(const char *name, const char *descr)
+        : plugin_name(name), plugin_descr(descr), m_handle(nullptr) { }
+
     Plugin(const fs::path &path) : m_path(path) {
         #if defined(_WIN32)
             m_handle = LoadLibraryW(path.native().c_str());
@@ -46,6 +71,8 @@ public:
     }
 
     ~Plugin() {
+        if (!m_handle)
+            return;
         #if defined(_WIN32)
             FreeLibrary(m_handle);
         #else
@@ -95,6 +122,14 @@ struct PluginManager::PluginManagerPrivate {
         if (it != m_plugins.end())
             return it->second;
 
+        // Plugins linked into the library take precedence over shared libraries
+        auto it2 = detail::static_plugins().find(name);
+        if (it2 != detail::static_plugins().end()) {
+            Plugin *plugin = new Plugin(it2->second.class_name, it2->second.descr);
+            m_plugins[name] = plugin;
+            return plugin;
+        }
+
         // Build the full plugin file name
         fs::path filename = fs::path("plugins") / name;
 
@@ -147,8 +182,14 @@ const Class *PluginManager::get_plugin_class(const std::string &name,
     if (it != d->m_python_plugins.end()) {
         plugin_class = Class::for_name(name, variant);
     } else {
-        const Plugin *plugin = d->plugin(name);
-        plugin_class = Class::for_name(plugin->plugin_name, variant);
+        // Avoid the plugin lock for plugins linked into the library
+        auto it2 = detail::static_plugins().find(name);
+        if (it2 != detail::static_plugins().end()) {
+            plugin_class = Class::for_name(it2->second.class_name, variant);
+        } else {
+            const Plugin *plugin = d->plugin(name);
+            plugin_class = Class::for_name(plugin->plugin_name, variant);
+        }
     }
 
     return plugin_class;
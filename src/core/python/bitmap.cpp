@@ -45,6 +45,20 @@ MI_PY_EXPORT(Bitmap) {
         .value("Unpremultiply", Bitmap::AlphaTransform::Unpremultiply,
                 D(Bitmap, AlphaTransform, Unpremultiply));
 
+    py::class_<Bitmap::EXRRegion>(bitmap, "EXRRegion", D(Bitmap, EXRRegion))
+        .def(py::init([](uint32_t part, uint32_t level, const Vector2u &offset,
+                         const Vector2u &size,
+                         const std::vector<std::string> &channels) {
+                 return Bitmap::EXRRegion{ part, level, offset, size, channels };
+             }),
+             "part"_a = 0, "level"_a = 0, "offset"_a = Vector2u(0),
+             "size"_a = Vector2u(0), "channels"_a = std::vector<std::string>())
+        .def_readwrite("part", &Bitmap::EXRRegion::part, D(Bitmap, EXRRegion, part))
+        .def_readwrite("level", &Bitmap::EXRRegion::level, D(Bitmap, EXRRegion, level))
+        .def_readwrite("offset", &Bitmap::EXRRegion::offset, D(Bitmap, EXRRegion, offset))
+        .def_readwrite("size", &Bitmap::EXRRegion::size, D(Bitmap, EXRRegion, size))
+        .def_readwrite("channels", &Bitmap::EXRRegion::channels, D(Bitmap, EXRRegion, channels));
+
     bitmap
         .def(py::init<Bitmap::PixelFormat, Struct::Type, const Vector2u &, size_t, std::vector<std::string>>(),
              "pixel_format"_a, "component_format"_a, "size"_a, "channel_count"_a = 0, "channel_names"_a = std::vector<std::string>(),
@@ -149,6 +163,26 @@ MI_PY_EXPORT(Bitmap) {
         .def(py::init<Stream *, Bitmap::FileFormat>(), "stream"_a,
             "format"_a = Bitmap::FileFormat::Auto,
             py::call_guard<py::gil_scoped_release>())
+        .def(py::init<const fs::path &, const Bitmap::EXRRegion &>(), "path"_a,
+            "region"_a, D(Bitmap, Bitmap, 5),
+            py::call_guard<py::gil_scoped_release>())
+        .def(py::init<Stream *, const Bitmap::EXRRegion &>(), "stream"_a,
+            "region"_a, D(Bitmap, Bitmap, 4),
+            py::call_guard<py::gil_scoped_release>())
+        .def_static("write_exr",
+            py::overload_cast<const fs::path &,
+                              const std::vector<std::pair<std::string, ref<Bitmap>>> &,
+                              uint32_t, bool, int>(&Bitmap::write_exr),
+            "path"_a, "parts"_a, "tile_size"_a = 0, "mipmap"_a = false,
+            "quality"_a = -1, D(Bitmap, write_exr, 2),
+            py::call_guard<py::gil_scoped_release>())
+        .def_static("write_exr",
+            py::overload_cast<Stream *,
+                              const std::vector<std::pair<std::string, ref<Bitmap>>> &,
+                              uint32_t, bool, int>(&Bitmap::write_exr),
+            "stream"_a, "parts"_a, "tile_size"_a = 0, "mipmap"_a = false,
+            "quality"_a = -1, D(Bitmap, write_exr),
+            py::call_guard<py::gil_scoped_release>())
         .def("write",
             py::overload_cast<Stream *, Bitmap::FileFormat, int>(
                 &Bitmap::write, py::const_),
@@ -10,7 +10,7 @@ MI_PY_EXPORT(DiscreteDistribution) {
     MI_PY_STRUCT(DiscreteDistribution, py::module_local())
         .def(py::init<>(), D(DiscreteDistribution))
         .def(py::init<const DiscreteDistribution &>(), "Copy constructor")
-        .def(py::init<const FloatStorage &>(), "pmf"_a,
+        .def(py::init<const FloatStorage &, bool>(), "pmf"_a, "alias"_a = false,
              D(DiscreteDistribution, DiscreteDistribution, 2))
         .def("__len__", &DiscreteDistribution::size)
         .def("size", &DiscreteDistribution::size, D(DiscreteDistribution, size))
@@ -28,6 +28,7 @@ MI_PY_EXPORT(DiscreteDistribution) {
         .def("eval_cdf_normalized", &DiscreteDistribution::eval_cdf_normalized,
              "index"_a, "active"_a = true, D(DiscreteDistribution, eval_cdf_normalized))
         .def_method(DiscreteDistribution, update)
+        .def_method(DiscreteDistribution, alias)
         .def_method(DiscreteDistribution, sum)
         .def_method(DiscreteDistribution, normalization)
         .def("sample",
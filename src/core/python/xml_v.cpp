@@ -39,7 +39,8 @@ MI_PY_EXPORT(xml) {
 
     m.def(
         "load_file",
-        [](const std::string &name, bool update_scene, bool parallel, py::kwargs kwargs) {
+        [](const std::string &name, bool update_scene, bool parallel,
+           bool deduplicate, py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -53,16 +54,17 @@ MI_PY_EXPORT(xml) {
             py::gil_scoped_release release;
 
             std::vector<ref<Object>> objects = xml::load_file(
-                name, GET_VARIANT(), param, update_scene, parallel);
+                name, GET_VARIANT(), param, update_scene, parallel, deduplicate);
 
             return single_object_or_list(objects);
         },
         "path"_a, "update_scene"_a = false, "parallel"_a = !dr::is_jit_v<Float>,
-        D(xml, load_file));
+        "deduplicate"_a = false, D(xml, load_file));
 
     m.def(
         "load_string",
-        [](const std::string &name, bool parallel, py::kwargs kwargs) {
+        [](const std::string &name, bool parallel, bool deduplicate,
+           py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -76,12 +78,12 @@ MI_PY_EXPORT(xml) {
             py::gil_scoped_release release;
 
             std::vector<ref<Object>> objects = xml::load_string(
-                name, GET_VARIANT(), param, parallel);
+                name, GET_VARIANT(), param, parallel, deduplicate);
 
             return single_object_or_list(objects);
         },
         "string"_a, "parallel"_a = !dr::is_jit_v<Float>,
-        D(xml, load_string));
+        "deduplicate"_a = false, D(xml, load_string));
 
     m.def(
         "load_dict",
@@ -7,8 +7,11 @@
 #include <drjit/array.h>
 #include <drjit/half.h>
 #include <drjit/color.h>
+#include <nanothread/nanothread.h>
 #include <unordered_map>
 #include <ostream>
+#include <cstring>
+#include <mutex>
 #include <map>
 
 /// Set this to '1' to view generated conversion code
@@ -1023,6 +1026,238 @@ private:
 
 #endif
 
+/// Number of values processed per parallel work unit by \ref StructFastPath
+#define MI_STRUCT_GRAIN_SIZE 65536u
+
+/**
+ * \brief Specialized conversion kernels for frequently used layouts
+ *
+ * These apply when each target field is a single precision value (in host
+ * byte order) that is directly obtained from a source field containing an
+ * 8-bit unsigned integer, or a half/single precision value. Blending,
+ * weights, alpha (un)premultiplication, assertions, and default values are
+ * left to the generic implementations.
+ */
+struct StructFastPath {
+    enum class Op : uint8_t {
+        /// Copy a single precision value
+        Copy,
+        /// Copy a byte-swapped single precision value
+        Swap,
+        /// Convert a half precision value
+        Half,
+        /// Convert a byte-swapped half precision value
+        HalfSwap,
+        /// Look up an 8-bit value (normalization, sRGB decoding)
+        Table
+    };
+
+    struct Field {
+        Op op;
+        size_t src_offset;
+        size_t dst_offset;
+        std::vector<float> table;
+    };
+
+    std::vector<Field> fields;
+
+    /// Number of bytes between consecutive records
+    size_t src_stride, dst_stride;
+
+    /// Number of values per record (if the fields were merged, see \ref create())
+    size_t values_per_record = 1;
+
+    /// Analyze the given layouts, returns \c nullptr if they aren't supported
+    static std::unique_ptr<StructFastPath> create(const Struct *source,
+                                                  const Struct *target);
+
+    /// Convert \c count records, parallelizing over large inputs
+    void convert(size_t count, const void *src, void *dst) const;
+};
+
+std::unique_ptr<StructFastPath> StructFastPath::create(const Struct *source,
+                                                       const Struct *target) {
+    const uint32_t flag_mask = Struct::Flags::Normalized | Struct::Flags::Gamma,
+                   special_channels_mask = Struct::Flags::Weight | Struct::Flags::Alpha;
+
+    if (target->field_count() == 0 ||
+        target->byte_order() != Struct::host_byte_order())
+        return nullptr;
+
+    bool source_swap = source->byte_order() != Struct::host_byte_order(),
+         has_alpha = false;
+
+    for (const Struct::Field &f : *source) {
+        if (has_flag(f.flags, Struct::Flags::Assert) ||
+            has_flag(f.flags, Struct::Flags::Weight))
+            return nullptr;
+        has_alpha |= has_flag(f.flags, Struct::Flags::Alpha);
+    }
+
+    std::unique_ptr<StructFastPath> result(new StructFastPath());
+    result->src_stride = source->size();
+    result->dst_stride = target->size();
+
+    for (const Struct::Field &t : *target) {
+        if (t.type != Struct::Type::Float32 || !t.blend.empty() ||
+            !source->has_field(t.name))
+            return nullptr;
+
+        const Struct::Field &s = source->field(t.name);
+
+        if (has_alpha && (t.flags & special_channels_mask) == 0 &&
+            has_flag(s.flags, Struct::Flags::PremultipliedAlpha) !=
+            has_flag(t.flags, Struct::Flags::PremultipliedAlpha))
+            return nullptr;
+
+        /* Like the generic implementation, keep the value as is if it is
+           loaded in the target representation, and linearize it otherwise.
+           The sRGB curve is only supported as part of the lookup tables. */
+        Struct::Type loaded_type =
+            s.type == Struct::Type::Float16 ? Struct::Type::Float32 : s.type;
+        bool linearize = loaded_type != t.type ||
+                         (s.flags & flag_mask) != (t.flags & flag_mask);
+        if (linearize && (has_flag(t.flags, Struct::Flags::Gamma) ||
+                          (has_flag(s.flags, Struct::Flags::Gamma) &&
+                           s.type != Struct::Type::UInt8)))
+            return nullptr;
+
+        Field field { Op::Copy, s.offset, t.offset, { } };
+        switch (s.type) {
+            case Struct::Type::UInt8: {
+                    field.op = Op::Table;
+                    field.table.resize(256);
+                    for (uint32_t i = 0; i < 256; ++i) {
+                        Float value = (Float) i;
+                        if (has_flag(s.flags, Struct::Flags::Normalized))
+                            value *= Float(1 / Struct::range(s.type).second);
+                        if (has_flag(s.flags, Struct::Flags::Gamma))
+                            value = dr::srgb_to_linear(value);
+                        field.table[i] = (float) value;
+                    }
+                }
+                break;
+
+            case Struct::Type::Float16:
+                field.op = source_swap ? Op::HalfSwap : Op::Half;
+                break;
+
+            case Struct::Type::Float32:
+                field.op = source_swap ? Op::Swap : Op::Copy;
+                break;
+
+            default:
+                return nullptr;
+        }
+
+        result->fields.push_back(std::move(field));
+    }
+
+    /* Fields that are densely packed in both records and use the same
+       operation (e.g. RGBA values) are merged into a single array */
+    const Field &first = result->fields[0];
+    size_t value_size = first.op == Op::Table ? 1 :
+                        (first.op == Op::Half || first.op == Op::HalfSwap) ? 2 : 4,
+           field_count = result->fields.size();
+
+    bool dense = field_count > 1 &&
+                 result->src_stride == field_count * value_size &&
+                 result->dst_stride == field_count * sizeof(float);
+
+    for (size_t i = 0; i < field_count && dense; ++i) {
+        const Field &f = result->fields[i];
+        dense = f.op == first.op && f.table == first.table &&
+                f.src_offset == i * value_size &&
+                f.dst_offset == i * sizeof(float);
+    }
+
+    if (dense) {
+        result->fields.resize(1);
+        result->src_stride = value_size;
+        result->dst_stride = sizeof(float);
+        result->values_per_record = field_count;
+    }
+
+    return result;
+}
+
+/// Apply \c func to \c count values stored at the given strides
+template <typename Value, typename Func>
+static void convert_values(size_t count, const uint8_t *src, size_t src_stride,
+                           uint8_t *dst, size_t dst_stride, Func func) {
+    if (src_stride == sizeof(Value) && dst_stride == sizeof(float)) {
+        // Dense arrays: fixed strides that enable auto-vectorization
+        for (size_t i = 0; i < count; ++i) {
+            Value value;
+            std::memcpy(&value, src + i * sizeof(Value), sizeof(Value));
+            float result = func(value);
+            std::memcpy(dst + i * sizeof(float), &result, sizeof(float));
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            Value value;
+            std::memcpy(&value, src + i * src_stride, sizeof(Value));
+            float result = func(value);
+            std::memcpy(dst + i * dst_stride, &result, sizeof(float));
+        }
+    }
+}
+
+void StructFastPath::convert(size_t count, const void *src_, void *dst_) const {
+    const uint8_t *src = (const uint8_t *) src_;
+    uint8_t *dst = (uint8_t *) dst_;
+    count *= values_per_record;
+
+    auto convert_range = [&](size_t begin, size_t end) {
+        for (const Field &f : fields) {
+            const uint8_t *s = src + begin * src_stride + f.src_offset;
+            uint8_t *d = dst + begin * dst_stride + f.dst_offset;
+            size_t n = end - begin;
+
+            switch (f.op) {
+                case Op::Copy:
+                    convert_values<float>(n, s, src_stride, d, dst_stride,
+                        [](float v) { return v; });
+                    break;
+
+                case Op::Swap:
+                    convert_values<uint32_t>(n, s, src_stride, d, dst_stride,
+                        [](uint32_t v) { return dr::memcpy_cast<float>(detail::swap(v)); });
+                    break;
+
+                case Op::Half:
+                    convert_values<uint16_t>(n, s, src_stride, d, dst_stride,
+                        [](uint16_t v) { return dr::half::float16_to_float32(v); });
+                    break;
+
+                case Op::HalfSwap:
+                    convert_values<uint16_t>(n, s, src_stride, d, dst_stride,
+                        [](uint16_t v) { return dr::half::float16_to_float32(detail::swap(v)); });
+                    break;
+
+                case Op::Table: {
+                        const float *table = f.table.data();
+                        convert_values<uint8_t>(n, s, src_stride, d, dst_stride,
+                            [table](uint8_t v) { return table[v]; });
+                    }
+                    break;
+            }
+        }
+    };
+
+    if (count < 2 * MI_STRUCT_GRAIN_SIZE) {
+        convert_range(0, count);
+        return;
+    }
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, count, MI_STRUCT_GRAIN_SIZE),
+        [&](const dr::blocked_range<size_t> &range) {
+            convert_range(range.begin(), range.end());
+        }
+    );
+}
+
 NAMESPACE_END(detail)
 
 Struct::Struct(bool pack, Struct::ByteOrder byte_order)
@@ -1230,29 +1465,32 @@ size_t hash(const Struct &s) {
                         hash(s.m_byte_order));
 }
 
-static std::unordered_map<
-           std::pair<ref<const Struct>, ref<const Struct>>, void *,
-    hasher<std::pair<ref<const Struct>, ref<const Struct>>>,
-    comparator<std::pair<ref<const Struct>, ref<const Struct>>>> __cache;
+/// Conversion routines shared by all converters between the same layouts
+struct StructConverterCacheEntry {
+    /// Routine generated by the JIT compiler (if needed)
+    void *func = nullptr;
+    /// Specialized kernels (if applicable)
+    std::unique_ptr<detail::StructFastPath> fast_path;
+};
+
+/// Cache key: source and target layout, and whether dithering is enabled
+using StructConverterCacheKey =
+    std::pair<std::pair<ref<const Struct>, ref<const Struct>>, bool>;
+
+static std::unordered_map<StructConverterCacheKey, StructConverterCacheEntry,
+                          hasher<StructConverterCacheKey>,
+                          comparator<StructConverterCacheKey>> __cache;
+static std::mutex __cache_mutex;
 
-StructConverter::StructConverter(const Struct *source, const Struct *target, bool dither)
- : m_source(source), m_target(target) {
 #if MI_STRUCTCONVERTER_USE_JIT == 1
+/// Generate a conversion routine using the JIT compiler
+static void *compile_struct_converter(const Struct *source, const Struct *target,
+                                      bool dither) {
     using namespace asmjit;
 
-    // Use the Jit instance to cache structure converters
     auto jit = Jit::get_instance();
     std::lock_guard<std::mutex> guard(jit->mutex);
 
-    auto key = std::make_pair(ref<const Struct>(source), ref<const Struct>(target));
-    auto it = __cache.find(key);
-
-    if (it != __cache.end()) {
-        // Cache hit
-        m_func = ptr_as_func<FuncType>(it->second);
-        return;
-    }
-
     CodeHolder code;
     code.init(jit->runtime.getCodeInfo());
     #if MI_JIT_LOG_ASSEMBLY == 1
@@ -1478,18 +1716,61 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
     if (err != asmjit::kErrorOk)
         Throw("asmjit failed: %s", asmjit::DebugUtils::errorAsString(err));
 
-    jit->runtime.add((void **) &m_func, &code);
+    void *func = nullptr;
+    jit->runtime.add(&func, &code);
 
     #if MI_JIT_LOG_ASSEMBLY == 1
        Log(Info, "Assembly:\n%s", logger.getString());
     #endif
 
-    __cache[key] = (void *) m_func;
+    return func;
+}
+#endif
+
+StructConverter::StructConverter(const Struct *source, const Struct *target, bool dither)
+ : m_source(source), m_target(target), m_fast_path(nullptr) {
+    std::lock_guard<std::mutex> guard(__cache_mutex);
+
+    auto key = std::make_pair(
+        std::make_pair(ref<const Struct>(source), ref<const Struct>(target)),
+        dither);
+    auto it = __cache.find(key);
+
+    if (it == __cache.end()) {
+        // Cache miss: the specialized kernels take precedence over the JIT
+        StructConverterCacheEntry entry;
+        entry.fast_path = detail::StructFastPath::create(source, target);
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+        if (!entry.fast_path)
+            entry.func = compile_struct_converter(source, target, dither);
+#endif
+        // Store copies of the layouts, which callers might modify later on
+        key.first = std::make_pair(ref<const Struct>(new Struct(*source)),
+                                   ref<const Struct>(new Struct(*target)));
+        it = __cache.emplace(std::move(key), std::move(entry)).first;
+    }
+
+    m_fast_path = it->second.fast_path.get();
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+    m_func = asmjit::ptr_as_func<FuncType>(it->second.func);
 #else
     m_dither = dither;
 #endif
 }
 
+bool StructConverter::convert_2d(size_t width, size_t height, const void *src,
+                                 void *dest) const {
+    if (m_fast_path) {
+        m_fast_path->convert(width * height, src, dest);
+        return true;
+    }
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+    return m_func(width, height, src, dest);
+#else
+    return convert_2d_generic(width, height, src, dest);
+#endif
+}
+
 #if MI_STRUCTCONVERTER_USE_JIT == 0
 
 bool StructConverter::load(const uint8_t *src, const Struct::Field &f, Value &value) const {
@@ -1744,7 +2025,8 @@ void StructConverter::save(uint8_t *dst, const Struct::Field &f, Value value, si
     }
 }
 
-bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_) const {
+bool StructConverter::convert_2d_generic(size_t width, size_t height,
+                                         const void *src_, void *dest_) const {
     using namespace mitsuba::detail;
 
     size_t source_size = m_source->size();
@@ -390,3 +390,54 @@ def test_check_weight_division(variant_scalar_rgb):
     assert np.all(x[0, 0, :] == (2, 0, 0, 0))
     assert np.all(x[1, 0, :] == (1, 0, 0, 0))
     assert np.all(x[2, 0, :] == (2, 0, 0, 0))
+
+
+@pytest.mark.parametrize('tile_size', [0, 16])
+def test_read_exr_region(variant_scalar_rgb, tmpdir, np_rng, tile_size):
+    # Tests multi-part files and reading windows/channels of individual parts
+    b1 = mi.Bitmap(np_rng.random((45, 70, 3)).astype(np.float32))
+    b2 = mi.Bitmap(np_rng.random((20, 10, 1)).astype(np.float32))
+    tmp_file = os.path.join(str(tmpdir), "out.exr")
+    mi.Bitmap.write_exr(tmp_file, [('first', b1), ('second', b2)],
+                        tile_size=tile_size)
+
+    b = mi.Bitmap(tmp_file)
+    assert np.array_equal(np.array(b), np.array(b1))
+
+    region = mi.Bitmap.EXRRegion(offset=[13, 7], size=[30, 35])
+    b = mi.Bitmap(tmp_file, region)
+    assert b.width() == 30 and b.height() == 35
+    assert np.array_equal(np.array(b), np.array(b1)[7:42, 13:43, :])
+
+    region = mi.Bitmap.EXRRegion(offset=[69, 44], channels=['G'])
+    b = mi.Bitmap(tmp_file, region)
+    assert np.array_equal(np.array(b)[..., 0], np.array(b1)[44:, 69:, 1])
+
+    b = mi.Bitmap(tmp_file, mi.Bitmap.EXRRegion(part=1, offset=[0, 5]))
+    assert np.array_equal(np.array(b), np.array(b2)[5:, ...])
+
+    with pytest.raises(RuntimeError, match='not contained'):
+        mi.Bitmap(tmp_file, mi.Bitmap.EXRRegion(offset=[60, 0], size=[20, 1]))
+    with pytest.raises(RuntimeError, match='part index'):
+        mi.Bitmap(tmp_file, mi.Bitmap.EXRRegion(part=2))
+    os.remove(tmp_file)
+
+
+def test_read_exr_mipmap(variant_scalar_rgb, tmpdir, np_rng):
+    # Tests writing and reading the levels of a tiled and mip-mapped file
+    b1 = mi.Bitmap(np_rng.random((32, 64, 4)).astype(np.float32))
+    tmp_file = os.path.join(str(tmpdir), "out.exr")
+    mi.Bitmap.write_exr(tmp_file, [('', b1)], tile_size=16, mipmap=True)
+
+    ref = np.array(b1)
+    for level in range(7):
+        b = mi.Bitmap(tmp_file, mi.Bitmap.EXRRegion(level=level))
+        assert np.allclose(np.array(b), ref, atol=1e-5)
+        if level < 6:
+            # Box-filtered version of the previous level
+            ref = ref.reshape(ref.shape[0] // 2 if ref.shape[0] > 1 else 1,
+                              -1, ref.shape[1] // 2, 2, 4).mean(axis=(1, 3))
+
+    with pytest.raises(RuntimeError, match='mip-map level'):
+        mi.Bitmap(tmp_file, mi.Bitmap.EXRRegion(level=7))
+    os.remove(tmp_file)
@@ -265,3 +265,30 @@ def test18_irrcont_simple_function(variants_vec_backends_once):
                 0.48734, 0.654313, 0.786607, 0.899653, 1.])
          * d.normalization())
     )
+
+
+def test19_discr_alias(variants_vec_backends_once):
+    # The alias table must reproduce the same distribution as the CDF inversion
+    pmf = [0, 1, 3, 0, 2, 10, 0.5]
+    x = mi.DiscreteDistribution(pmf, alias=True)
+    assert x.alias()
+    assert not mi.DiscreteDistribution(pmf).alias()
+
+    n = 1000000
+    sample = (dr.arange(mi.Float, n) + .5) / n
+    index, sample_re, pmf_re = x.sample_reuse_pmf(sample)
+
+    hist = dr.zeros(mi.Float, len(pmf))
+    dr.scatter_reduce(dr.ReduceOp.Add, hist, 1.0 / n, index)
+    assert dr.allclose(hist, mi.Float(pmf) / sum(pmf), atol=1e-4)
+    assert dr.allclose(pmf_re, x.eval_pmf_normalized(index))
+
+    # Re-scaled samples must be uniformly distributed in each bucket
+    assert dr.all((sample_re >= 0) & (sample_re < 1))
+    mean = dr.zeros(mi.Float, len(pmf))
+    dr.scatter_reduce(dr.ReduceOp.Add, mean, sample_re / n, index)
+    mask = hist > 0
+    assert dr.allclose(dr.select(mask, mean / hist, 0.5), 0.5, atol=1e-3)
+
+    # Out of range samples are clamped
+    assert dr.all(x.sample(mi.Float([-100, 100])) < len(pmf))
@@ -443,3 +443,39 @@ def test19_alpha_4():
     dst_data = (src_data_float[0], src_data_float[1], src_data[2])
     check_conversion(s, '@BBB', '@BBB',
                      src_data, dst_data)
+
+
+@pytest.mark.parametrize('byte_order', ['<', '>'])
+@pytest.mark.parametrize('param', [('u1', Struct.Type.UInt8),
+                                   ('f2', Struct.Type.Float16),
+                                   ('f4', Struct.Type.Float32)])
+def test20_large_input(param, byte_order):
+    # Large inputs are converted in parallel by the specialized kernels
+    bo = Struct.ByteOrder.LittleEndian if byte_order == '<' else Struct.ByteOrder.BigEndian
+    src_struct = Struct(byte_order=bo)
+    for name in 'rgba':
+        if param[1] == Struct.Type.UInt8:
+            src_struct.append(name, param[1],
+                              Struct.Flags.Normalized | Struct.Flags.Gamma)
+        else:
+            src_struct.append(name, param[1])
+
+    rng = np.random.default_rng(0)
+    values = rng.integers(0, 256, size=(300000, 4))
+    if param[1] == Struct.Type.UInt8:
+        ref = np.vectorize(from_srgb)(values / 255.0)
+    else:
+        values = values / 255.0
+        ref = values
+    src_data = values.astype(byte_order + param[0]).tobytes()
+
+    # Densely packed target, and a target with reordered fields
+    for names in ['rgba', 'bgr']:
+        dst_struct = Struct()
+        for name in names:
+            dst_struct.append(name, Struct.Type.Float32)
+        s = StructConverter(src_struct, dst_struct)
+        result = np.frombuffer(s.convert(src_data), dtype=np.float32)
+        result = result.reshape(-1, len(names))
+        idx = ['rgba'.index(name) for name in names]
+        assert np.allclose(result, ref[:, idx], rtol=1e-3, atol=1e-6)
@@ -410,4 +410,86 @@ def test30_invalid_parameter_name(variant_scalar_rgb):
             <default name="test_2," value="2"/>
         </scene>
         """)
-    e.match('Invalid character in parameter name')
\ No newline at end of file
+    e.match('Invalid character in parameter name')
+
+def test31_deduplicate_anonymous_objects(variant_scalar_rgb):
+    def load(bsdf_1, bsdf_2, deduplicate=True):
+        scene = mi.load_string(f"""
+        <scene version="3.0.0">
+            <shape type="sphere">{bsdf_1}</shape>
+            <shape type="sphere">{bsdf_2}</shape>
+        </scene>
+        """, deduplicate=deduplicate)
+        return [shape.bsdf() for shape in scene.shapes()]
+
+    diffuse = '<bsdf type="diffuse"><rgb name="reflectance" value="{}"/></bsdf>'
+
+    # Objects are only shared on request
+    b = load(diffuse.format(0.5), diffuse.format(0.5), deduplicate=False)
+    assert b[0] is not b[1]
+
+    # Identical anonymous objects are shared
+    b = load(diffuse.format(0.5), diffuse.format(0.5))
+    assert b[0] is b[1]
+
+    b = load(diffuse.format(0.5), diffuse.format(0.25))
+    assert b[0] is not b[1]
+
+    # Objects with an explicit id are kept separate
+    b = load('<bsdf type="diffuse" id="a"/>', '<bsdf type="diffuse" id="b"/>')
+    assert b[0] is not b[1]
+
+
+def test32_parallel_includes(variant_scalar_rgb, tmp_path):
+    # Nested includes are loaded on worker threads, and processed in order
+    for i in range(8):
+        (tmp_path / f'shape_{i}.xml').write_text(f"""
+        <scene version="3.0.0">
+            <shape type="sphere" id="sphere_{i}">
+                <float name="radius" value="{i + 1}"/>
+            </shape>
+            {'<include filename="nested.xml"/>' if i == 0 else ''}
+        </scene>
+        """)
+    (tmp_path / 'nested.xml').write_text("""
+        <shape version="3.0.0" type="sphere" id="nested"/>
+    """)
+    includes = ''.join(f'<include filename="shape_{i}.xml"/>' for i in range(8))
+    filepath = tmp_path / 'scene.xml'
+    filepath.write_text(f'<scene version="3.0.0">{includes}</scene>')
+
+    for parallel in [False, True]:
+        scene = mi.load_file(str(filepath), parallel=parallel)
+        ids = sorted(shape.id() for shape in scene.shapes())
+        assert ids == sorted(['nested'] + [f'sphere_{i}' for i in range(8)])
+
+
+def test33_deduplicate_traverse_keys(variant_scalar_rgb):
+    def keys(value_1, value_2, **kwargs):
+        scene = mi.load_string(f"""
+        <scene version="3.0.0">
+            <shape type="sphere" id="s1">
+                <bsdf type="diffuse">
+                    <rgb name="reflectance" value="{value_1}"/>
+                </bsdf>
+            </shape>
+            <shape type="sphere" id="s2">
+                <bsdf type="diffuse">
+                    <rgb name="reflectance" value="{value_2}"/>
+                </bsdf>
+            </shape>
+        </scene>
+        """, **kwargs)
+        return set(mi.traverse(scene).keys())
+
+    # By default, the scene parameters do not depend on which objects
+    # happen to be identical
+    ref = keys(0.5, 0.25)
+    assert keys(0.5, 0.5) == ref
+    assert keys(0.5, 0.5, deduplicate=False) == ref
+    assert any(k.startswith('s1.bsdf') for k in ref)
+    assert any(k.startswith('s2.bsdf') for k in ref)
+
+    # Shared objects only appear once
+    assert keys(0.5, 0.5, deduplicate=True) != ref
+    assert keys(0.5, 0.25, deduplicate=True) == ref
@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <fstream>
 #include <set>
 #include <unordered_map>
 #include <mutex>
 #include <map>
+#include <memory>
 
 #include <mitsuba/core/class.h>
 #include <mitsuba/core/config.h>
@@ -86,8 +89,158 @@ bool is_unbounded_spectrum(const std::string &name) {
     return name == "eta" || name == "k" || name == "int_ior" || name == "ext_ior";
 }
 
+// -----------------------------------------------------------------------------
+
+/// Modification stamp of a file referenced by an object
+struct FileStamp {
+    fs::path path;
+    size_t size = 0;
+    int64_t mtime = 0;
+
+    bool operator==(const FileStamp &s) const {
+        return path == s.path && size == s.size && mtime == s.mtime;
+    }
+};
+
+/// Resolve the file named by the "filename" property of an object (if any)
+static fs::path referenced_file(const Properties &props) {
+    if (!props.has_property("filename") ||
+        props.type("filename") != Properties::Type::String)
+        return fs::path();
+
+    // Query a copy, so that the original property remains unqueried
+    Properties tmp(props);
+    return Thread::thread()->file_resolver()->resolve(tmp.string("filename"));
+}
+
+static FileStamp file_stamp(const Properties &props) {
+    FileStamp stamp;
+    stamp.path = referenced_file(props);
+    if (!stamp.path.empty() && fs::is_regular_file(stamp.path)) {
+        stamp.size = fs::file_size(stamp.path);
+        stamp.mtime = fs::last_write_time(stamp.path);
+    }
+    return stamp;
+}
+
+struct InstanceCache::InstanceCachePrivate {
+    struct Entry {
+        Properties props;
+        ref<Object> object;
+        FileStamp file;
+    };
+    std::unordered_map<const Class *, std::vector<Entry>> entries;
+    mutable std::mutex mutex;
+};
+
+/// Properties referencing raw memory cannot be compared safely across loads
+static bool is_cacheable(const Properties &props) {
+    for (const std::string &name : props.property_names()) {
+        if (props.type(name) == Properties::Type::Pointer)
+            return false;
+    }
+    return true;
+}
+
+InstanceCache::InstanceCache() : d(new InstanceCachePrivate()) { }
+
+InstanceCache::~InstanceCache() { }
+
+ref<Object> InstanceCache::get(const Class *class_, const Properties &props) const {
+    if (!is_cacheable(props))
+        return nullptr;
+
+    FileStamp file = file_stamp(props);
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    auto it = d->entries.find(class_);
+    if (it == d->entries.end())
+        return nullptr;
+
+    // Objects loaded from files that were modified since are not reused
+    for (const auto &entry : it->second) {
+        if (entry.props == props)
+            return entry.file == file ? entry.object : nullptr;
+    }
+    return nullptr;
+}
+
+void InstanceCache::put(const Class *class_, const Properties &props, Object *object) {
+    if (!is_cacheable(props))
+        return;
+
+    FileStamp file = file_stamp(props);
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    auto &entries = d->entries[class_];
+    for (auto &entry : entries) {
+        if (entry.props == props) {
+            entry.object = object;
+            entry.file = file;
+            return;
+        }
+    }
+    entries.push_back({ props, object, file });
+}
+
+size_t InstanceCache::prune() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    size_t removed = 0;
+
+    /* Releasing an object can make its children unreferenced, as they may
+       only be held by the cached properties of the parent. Iterate until
+       nothing else can be removed. */
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto &[class_, entries] : d->entries) {
+            size_t size = entries.size();
+            entries.erase(std::remove_if(entries.begin(), entries.end(),
+                [](const InstanceCachePrivate::Entry &e) {
+                    return e.object->ref_count() == 1;
+                }), entries.end());
+            if (entries.size() != size) {
+                removed += size - entries.size();
+                changed = true;
+            }
+        }
+    }
+
+    return removed;
+}
+
+void InstanceCache::clear() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->entries.clear();
+}
+
+size_t InstanceCache::size() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    size_t size = 0;
+    for (const auto &[class_, entries] : d->entries)
+        size += entries.size();
+    return size;
+}
+
 NAMESPACE_BEGIN(detail)
 
+/// Create an object, or fetch an identical one from the cache (if provided)
+static ref<Object> create_object(const Properties &props, const Class *class_,
+                                 InstanceCache *cache) {
+    if (cache) {
+        ref<Object> object = cache->get(class_, props);
+        if (object)
+            return object;
+    }
+
+    ref<Object> object = PluginManager::instance()->create_object(props, class_);
+
+    if (cache)
+        cache->put(class_, props, object);
+
+    return object;
+}
+
 using Float = Properties::Float;
 MI_IMPORT_CORE_TYPES()
 
@@ -245,19 +398,52 @@ ColorMode variant_to_color_mode() {
         static_assert(false_v<Float, Spectrum>, "This should never happen!");
 }
 
+/// Included XML document that is loaded ahead of time by a worker thread
+struct PrefetchedDocument {
+    pugi::xml_document doc;
+    pugi::xml_parse_result result;
+    Task *task = nullptr;
+};
+
 struct XMLParseContext {
     std::unordered_map<std::string, XMLObject> instances;
+    std::unordered_map<std::string, std::shared_ptr<PrefetchedDocument>> prefetched;
+    std::recursive_mutex prefetch_mutex;
     Transform4f transform;
     size_t id_counter = 0;
     ColorMode color_mode;
     std::string variant;
     bool parallel;
-
-    XMLParseContext(const std::string &variant, bool parallel)
-        : variant(variant), parallel(parallel) {
+    InstanceCache *cache;
+    bool deduplicate;
+    size_t shared_count = 0;
+    std::atomic<size_t> cached_count { 0 }, created_count { 0 };
+
+    XMLParseContext(const std::string &variant, bool parallel,
+                    InstanceCache *cache = nullptr, bool deduplicate = false)
+        : variant(variant), parallel(parallel), cache(cache),
+          deduplicate(deduplicate) {
         color_mode = MI_INVOKE_VARIANT(variant, variant_to_color_mode);
     }
 
+    ~XMLParseContext() {
+        // Wait for included documents that were not consumed (e.g. on errors)
+        while (true) {
+            std::shared_ptr<PrefetchedDocument> entry;
+            {
+                std::lock_guard<std::recursive_mutex> guard(prefetch_mutex);
+                if (prefetched.empty())
+                    break;
+                entry = prefetched.begin()->second;
+                prefetched.erase(prefetched.begin());
+            }
+            try {
+                task_wait(entry->task);
+            } catch (...) { }
+            task_release(entry->task);
+        }
+    }
+
     bool is_cuda() const { return string::starts_with(variant, "cuda_"); }
     bool is_llvm() const { return string::starts_with(variant, "llvm_"); }
     bool is_jit()  const { return is_cuda() || is_llvm(); }
@@ -422,6 +608,63 @@ void upgrade_tree(XMLSource &src, pugi::xml_node &node, const Version &version)
             Version(MI_VERSION));
 }
 
+/**
+ * \brief Start loading the files included by the children of \c node on
+ * worker threads
+ *
+ * Only the file I/O and XML parsing run in parallel, the documents are still
+ * processed in order by \ref parse_xml(). Files whose names contain
+ * parameters or that resolve differently by the time they are processed are
+ * loaded again on demand.
+ */
+static void prefetch_includes(XMLParseContext &ctx, const pugi::xml_node &node,
+                              ref<FileResolver> fs) {
+    if (!ctx.parallel)
+        return;
+
+    for (pugi::xml_node ch : node.children("include")) {
+        std::string value = ch.attribute("filename").value();
+        if (value.empty() || value.find('$') != std::string::npos)
+            continue;
+
+        fs::path filename = fs->resolve(value);
+        std::lock_guard<std::recursive_mutex> guard(ctx.prefetch_mutex);
+        if (ctx.prefetched.find(filename.string()) != ctx.prefetched.end())
+            continue;
+
+        auto entry = std::make_shared<PrefetchedDocument>();
+        ctx.prefetched[filename.string()] = entry;
+        entry->task = dr::do_async([&ctx, entry, filename, fs]() {
+            entry->result = entry->doc.load_file(filename.native().c_str());
+            if (entry->result && std::string(entry->doc.begin()->name()) == "scene")
+                prefetch_includes(ctx, *entry->doc.begin(), fs);
+        });
+    }
+}
+
+/// Fetch a document loaded by \ref prefetch_includes() (or \c nullptr)
+static std::shared_ptr<PrefetchedDocument> take_prefetched(XMLParseContext &ctx,
+                                                           const fs::path &filename) {
+    std::shared_ptr<PrefetchedDocument> entry;
+    {
+        std::lock_guard<std::recursive_mutex> guard(ctx.prefetch_mutex);
+        auto it = ctx.prefetched.find(filename.string());
+        if (it == ctx.prefetched.end())
+            return nullptr;
+        entry = it->second;
+        ctx.prefetched.erase(it);
+    }
+
+    try {
+        task_wait(entry->task);
+    } catch (...) {
+        task_release(entry->task);
+        throw;
+    }
+    task_release(entry->task);
+    return entry;
+}
+
 static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseContext &ctx,
                                                      pugi::xml_node &node, Tag parent_tag,
                                                      Properties &props, ParameterList &param,
@@ -544,6 +787,9 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     Properties props_nested(type);
                     props_nested.set_id(id);
 
+                    if (node_name == "scene")
+                        prefetch_includes(ctx, node, Thread::thread()->file_resolver());
+
                     auto it_inst = ctx.instances.find(id);
                     if (it_inst != ctx.instances.end())
                         src.throw_error(node, "\"%s\" has duplicate id \"%s\" (previous was at %s)",
@@ -658,8 +904,16 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
 
                     Log(Info, "Loading included XML file \"%s\" ..", filename);
 
-                    pugi::xml_document doc;
-                    pugi::xml_parse_result result = doc.load_file(filename.native().c_str());
+                    // Use the copy loaded in parallel, if available
+                    std::shared_ptr<PrefetchedDocument> prefetched =
+                        take_prefetched(ctx, filename);
+                    pugi::xml_document local_doc;
+                    pugi::xml_parse_result result;
+                    if (prefetched)
+                        result = prefetched->result;
+                    else
+                        result = local_doc.load_file(filename.native().c_str());
+                    pugi::xml_document &doc = prefetched ? prefetched->doc : local_doc;
 
                     detail::XMLSource nested_src {
                         filename.string(), doc,
@@ -690,6 +944,10 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                                 doc.begin()->remove_attribute(version_attr_incl);
                             }
 
+                            if (!prefetched)
+                                prefetch_includes(ctx, *doc.begin(),
+                                                  Thread::thread()->file_resolver());
+
                             for (pugi::xml_node &ch: doc.begin()->children()) {
                                 auto [arg_name, nested_id] = parse_xml(nested_src, ctx, ch, parent_tag,
                                           props, param, arg_counter, 1);
@@ -794,7 +1052,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                     if (!within_spectrum) {
                         std::string name = node.attribute("name").value();
                         ref<Object> obj = detail::create_texture_from_rgb(
-                            name, color, ctx.variant, within_emitter);
+                            name, color, ctx.variant, within_emitter, ctx.cache);
                         props.set_object(name, obj);
                     } else {
                         props.set_color("color", color);
@@ -854,7 +1112,8 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         name, const_value, wavelengths, values, ctx.variant,
                         within_emitter,
                         ctx.color_mode == ColorMode::Spectral,
-                        ctx.color_mode == ColorMode::Monochromatic);
+                        ctx.color_mode == ColorMode::Monochromatic,
+                        ctx.cache);
 
                     props.set_object(name, obj);
                 }
@@ -1094,6 +1353,17 @@ static Task *instantiate_node(XMLParseContext &ctx,
             }
         }
 
+        // Reuse an identical object created by a previous load
+        if (ctx.cache) {
+            inst.object = ctx.cache->get(inst.class_, props);
+            if (inst.object) {
+                ctx.cached_count++;
+                return;
+            }
+        }
+
+        ctx.created_count++;
+
         try {
             inst.object = PluginManager::instance()->create_object(props, inst.class_);
             #if defined(MI_ENABLE_CUDA) || defined(MI_ENABLE_LLVM)
@@ -1132,6 +1402,9 @@ static Task *instantiate_node(XMLParseContext &ctx,
                   unqueried.size() > 1 ? "properties" : "property", unqueried,
                   string::to_lower(inst.class_->name()), props.plugin_name());
         }
+
+        if (ctx.cache)
+            ctx.cache->put(inst.class_, props, inst.object);
     };
 
     if (top_node) {
@@ -1162,25 +1435,114 @@ static Task *instantiate_node(XMLParseContext &ctx,
     }
 }
 
+/// Classes whose anonymous instances can be shared when their properties match
+static bool is_shareable(const Class *class_) {
+    const std::string &name = class_->name();
+    return name == "Texture" || name == "Volume" || name == "BSDF" ||
+           name == "PhaseFunction" || name == "Medium";
+}
+
+using DedupBuckets =
+    std::unordered_map<std::string, std::vector<std::pair<Properties, std::string>>>;
+
+/**
+ * \brief Redirect references to anonymous objects that are identical to a
+ * previously visited object, and return the id that should be used in place
+ * of \c id
+ *
+ * Objects are identical when they have the same class and properties, where
+ * nested objects are compared after their own deduplication and file names
+ * are compared after resolving them. Objects that are no longer referenced
+ * are never instantiated.
+ */
+static std::string deduplicate_node(XMLParseContext &ctx, const std::string &id,
+                                    std::unordered_map<std::string, std::string> &canonical,
+                                    DedupBuckets &buckets) {
+    auto it = canonical.find(id);
+    if (it != canonical.end())
+        return it->second;
+    canonical[id] = id;
+
+    auto it_inst = ctx.instances.find(id);
+    if (it_inst == ctx.instances.end())
+        return id; // Reported during instantiation
+
+    XMLObject &inst = it_inst->second;
+    if (!inst.alias.empty()) {
+        deduplicate_node(ctx, inst.alias, canonical, buckets);
+        return id;
+    }
+
+    for (auto &[name, child_id] : inst.props.named_references()) {
+        std::string shared_id = deduplicate_node(ctx, child_id, canonical, buckets);
+        if (shared_id != (const std::string &) child_id)
+            inst.props.set_named_reference(name, shared_id, false);
+    }
+
+    // Objects with a user-specified id are never merged
+    if (!is_shareable(inst.class_) || !string::starts_with(id, "_unnamed_"))
+        return id;
+
+    Properties key(inst.props);
+    key.set_id("");
+    fs::path file = referenced_file(key);
+    if (!file.empty())
+        key.set_string("filename", file.string(), false);
+
+    // Group candidates by a textual summary, then compare them exactly
+    std::ostringstream oss;
+    oss << inst.class_->name() << ":" << key.plugin_name();
+    for (const std::string &name : key.property_names())
+        oss << ";" << name << "=" << key.as_string(name);
+
+    auto &bucket = buckets[oss.str()];
+    for (const auto &[other_key, other_id] : bucket) {
+        if (other_key == key) {
+            ctx.shared_count++;
+            canonical[id] = other_id;
+            return other_id;
+        }
+    }
+
+    bucket.emplace_back(key, id);
+    return id;
+}
+
 static ref<Object> instantiate_top_node(XMLParseContext &ctx, const std::string &id) {
+    if (ctx.deduplicate) {
+        std::unordered_map<std::string, std::string> canonical;
+        DedupBuckets buckets;
+        deduplicate_node(ctx, id, canonical, buckets);
+    }
+
     ThreadEnvironment env;
     std::unordered_map<std::string, Task*> task_map;
     instantiate_node(ctx, id, env, task_map, true);
+
+    if (ctx.shared_count > 0)
+        Log(Info, "Shared %zu duplicate object%s within the scene.",
+            ctx.shared_count, ctx.shared_count == 1 ? "" : "s");
+    if (ctx.cache)
+        Log(Info, "Reused %zu of %zu objects from the instance cache.",
+            (size_t) ctx.cached_count,
+            (size_t) ctx.cached_count + (size_t) ctx.created_count);
+
     return ctx.instances.find(id)->second.object;
 }
 
 ref<Object> create_texture_from_rgb(const std::string &name,
                                     Color<float, 3> color,
                                     const std::string &variant,
-                                    bool within_emitter) {
+                                    bool within_emitter,
+                                    InstanceCache *cache) {
     Properties props(within_emitter ? "d65" : "srgb");
     props.set_color("color", color);
 
     if (!within_emitter && is_unbounded_spectrum(name))
         props.set_bool("unbounded", true);
 
-    ref<Object> texture = PluginManager::instance()->create_object(
-        props, Class::for_name("Texture", variant));
+    ref<Object> texture =
+        create_object(props, Class::for_name("Texture", variant), cache);
     std::vector<ref<Object>> children = texture->expand();
     if (!children.empty())
         return (Object *) children[0].get();
@@ -1194,7 +1556,8 @@ ref<Object> create_texture_from_spectrum(const std::string &name,
                                          const std::string &variant,
                                          bool within_emitter,
                                          bool is_spectral_mode,
-                                         bool is_monochromatic_mode) {
+                                         bool is_monochromatic_mode,
+                                         InstanceCache *cache) {
     const Class *class_ = Class::for_name("Texture", variant);
 
     bool is_unbounded = is_unbounded_spectrum(name);
@@ -1209,11 +1572,11 @@ ref<Object> create_texture_from_spectrum(const std::string &name,
             Properties props("srgb");
             props.set_color("color", color);
             props.set_bool("unbounded", true);
-            return PluginManager::instance()->create_object(props, class_);
+            return create_object(props, class_, cache);
         } else {
             Properties props("uniform");
             props.set_float("value", const_value);
-            return PluginManager::instance()->create_object(props, class_);
+            return create_object(props, class_, cache);
         }
     } else {
         /* Detect whether wavelengths are regularly sampled and potentially
@@ -1262,7 +1625,7 @@ ref<Object> create_texture_from_spectrum(const std::string &name,
                 props.set_pointer("values", values.data());
             }
 
-            return PluginManager::instance()->create_object(props, class_);
+            return create_object(props, class_, cache);
         } else {
             /* Pre-integrate against the CIE matching curves. In order to match
             the behavior of spectral modes, this function should instead
@@ -1286,7 +1649,7 @@ ref<Object> create_texture_from_spectrum(const std::string &name,
                     props.set_bool("unbounded", true);
             }
 
-            return PluginManager::instance()->create_object(props, class_);
+            return create_object(props, class_, cache);
         }
     }
 }
@@ -1348,7 +1711,9 @@ NAMESPACE_END(detail)
 std::vector<ref<Object>> load_string(const std::string &string,
                                      const std::string &variant,
                                      ParameterList param,
-                                     bool parallel) {
+                                     bool parallel,
+                                     bool deduplicate,
+                                     InstanceCache *cache) {
     ScopedPhase sp(ProfilerPhase::InitScene);
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_buffer(string.c_str(), string.length(),
@@ -1369,7 +1734,7 @@ std::vector<ref<Object>> load_string(const std::string &string,
 
     try {
         pugi::xml_node root = doc.document_element();
-        detail::XMLParseContext ctx(variant, parallel);
+        detail::XMLParseContext ctx(variant, parallel, cache, deduplicate);
         Properties props;
         size_t arg_counter; // Unused
         auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, props,
@@ -1395,7 +1760,9 @@ std::vector<ref<Object>> load_file(const fs::path &filename,
                                    const std::string &variant,
                                    ParameterList param,
                                    bool write_update,
-                                   bool parallel) {
+                                   bool parallel,
+                                   bool deduplicate,
+                                   InstanceCache *cache) {
     ScopedPhase sp(ProfilerPhase::InitScene);
 
     if (!fs::exists(filename))
@@ -1411,7 +1778,7 @@ std::vector<ref<Object>> load_file(const fs::path &filename,
     Thread::thread()->set_file_resolver(fs.get());
 
     try {
-        detail::XMLParseContext ctx(variant, parallel);
+        detail::XMLParseContext ctx(variant, parallel, cache, deduplicate);
         auto scene_id = detail::init_xml_parse_context_from_file(ctx, filename, param, write_update);
 
         ref<Object> top_node = detail::instantiate_top_node(ctx, scene_id);
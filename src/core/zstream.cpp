@@ -1,5 +1,7 @@
 #include <mitsuba/core/zstream.h>
+#include <mitsuba/core/util.h>
 #include <zlib.h>
+#include <limits>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -152,6 +154,56 @@ void ZStream::close() {
     m_child_stream = nullptr;
 }
 
+std::vector<uint8_t> ZStream::compress(const void *data, size_t size, int level) {
+    if (size > (size_t) std::numeric_limits<uInt>::max())
+        Throw("compress(): buffer is too large (%s)!", util::mem_string(size));
+
+    uLongf output_size = compressBound((uLong) size);
+    std::vector<uint8_t> output(output_size);
+
+    int retval = compress2(output.data(), &output_size, (const Bytef *) data,
+                           (uLong) size, level);
+    if (retval != Z_OK)
+        Throw("compress2(): error code %i", retval);
+
+    output.resize(output_size);
+    return output;
+}
+
+void ZStream::decompress(const void *data, size_t data_size, void *out,
+                         size_t size) {
+    if (size > (size_t) std::numeric_limits<uInt>::max() ||
+        data_size > (size_t) std::numeric_limits<uInt>::max())
+        Throw("decompress(): buffer is too large (%s)!", util::mem_string(size));
+
+    uLongf output_size = (uLongf) size;
+    uLong input_size = (uLong) data_size;
+    int retval = uncompress2((Bytef *) out, &output_size, (const Bytef *) data,
+                             &input_size);
+
+    switch (retval) {
+        case Z_OK:
+            break;
+        case Z_BUF_ERROR:
+            Throw("uncompress(): the stream is truncated or exceeds %s!",
+                  util::mem_string(size));
+        case Z_DATA_ERROR:
+            Throw("uncompress(): data error!");
+        case Z_MEM_ERROR:
+            Throw("uncompress(): memory error!");
+        default:
+            Throw("uncompress(): error code %i", retval);
+    }
+
+    // Reject chunks whose inflated size differs from the declared one
+    if ((size_t) output_size != size)
+        Throw("uncompress(): the stream inflates to %zu bytes, but %zu bytes "
+              "were expected!", (size_t) output_size, size);
+    if ((size_t) input_size != data_size)
+        Throw("uncompress(): the stream ends after %zu of %zu bytes!",
+              (size_t) input_size, data_size);
+}
+
 ZStream::~ZStream() {
     close();
 }
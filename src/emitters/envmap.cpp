@@ -10,6 +10,7 @@
 #include <drjit/tensor.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/core/fstream.h>
+#include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -43,6 +44,18 @@ Environment emitter (:monosp:`envmap`)
      will be combined using multiple importance sampling (MIS)? This is
      extremely cheap to do and can slightly reduce variance. (Default: true)
 
+ * - warp_downsampling
+   - |int|
+   - Reduce the resolution of the data structure used for importance sampling
+     by this factor along each axis. Sampling remains unbiased, but follows the
+     image less closely. Useful to cut down memory usage and startup time for
+     very high resolution images. (Default: 1)
+
+ * - warp_half_precision
+   - |bool|
+   - Store the hierarchy used for importance sampling using 16-bit floating
+     point values. Sampling remains unbiased. (Default: false)
+
  * - data
    - |tensor|
    - Tensor array containing the radiance-valued data.
@@ -105,6 +118,11 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_filename = file_path.filename().string();
 
+        m_warp_downsampling = props.get<uint32_t>("warp_downsampling", 1);
+        m_warp_half_precision = props.get<bool>("warp_half_precision", false);
+        if (m_warp_downsampling == 0)
+            Throw("\"%s\": 'warp_downsampling' must be >= 1", m_filename);
+
         ref<Bitmap> bitmap = new Bitmap(file_path);
         if (bitmap->width() < 2 || bitmap->height() < 3)
             Throw("\"%s\": the environment map resolution must be at "
@@ -201,7 +219,7 @@ public:
         m_data = TensorXf(bitmap_2->data(), 3, shape);
 
         m_scale = props.get<ScalarFloat>("scale", 1.f);
-        m_warp = Warp(luminance.get(), res);
+        build_warp(luminance.get(), res);
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
         dr::set_attr(this, "flags", m_flags);
@@ -271,7 +289,7 @@ public:
                 }
             }
 
-            m_warp = Warp(luminance.get(), res);
+            build_warp(luminance.get(), res);
         }
     }
 
@@ -461,6 +479,75 @@ public:
     }
 
 protected:
+    /**
+     * \brief (Re-)build the importance sampling data structure from the
+     * luminance image, optionally at a reduced resolution
+     */
+    void build_warp(const ScalarFloat *luminance, const ScalarVector2u &res) {
+        uint32_t factor = m_warp_downsampling;
+        if (factor == 1) {
+            m_warp = Warp(luminance, res, {}, {}, true, true,
+                          m_warp_half_precision);
+            return;
+        }
+
+        ScalarVector2u n_patches = res - 1u,
+                       res_d = dr::maximum((n_patches + (factor - 1u)) / factor, 1u) + 1u;
+        ScalarVector2f step = ScalarVector2f(n_patches) / ScalarVector2f(res_d - 1u);
+
+        /* Each output value averages the input over a window that extends by
+           one output cell plus one input cell in each direction. This ensures
+           that the reduced interpolant is nonzero wherever the original one
+           is, which is required for unbiased sampling. */
+        ScalarVector2f radius = step + 1.f;
+
+        auto window = [](ScalarFloat center, ScalarFloat radius, uint32_t size) {
+            int start = (int) dr::ceil(center - radius),
+                end   = (int) dr::floor(center + radius);
+            return std::make_pair((uint32_t) std::max(start, 0),
+                                  (uint32_t) std::min(end, (int) size - 1));
+        };
+
+        // Separable box filter: first along rows, then along columns
+        std::unique_ptr<ScalarFloat[]> temp(new ScalarFloat[res.y() * res_d.x()]),
+                                       luminance_d(new ScalarFloat[dr::prod(res_d)]);
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, res.y(), std::max(1u, 16384u / res.x())),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                    const ScalarFloat *in = luminance + y * res.x();
+                    for (uint32_t x = 0; x < res_d.x(); ++x) {
+                        auto [start, end] = window(x * step.x(), radius.x(), res.x());
+                        double sum = 0.0;
+                        for (uint32_t i = start; i <= end; ++i)
+                            sum += (double) in[i];
+                        temp[y * res_d.x() + x] = ScalarFloat(sum / (end - start + 1));
+                    }
+                }
+            }
+        );
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, res_d.y(), 1),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                    auto [start, end] = window(y * step.y(), radius.y(), res.y());
+                    for (uint32_t x = 0; x < res_d.x(); ++x) {
+                        double sum = 0.0;
+                        for (uint32_t i = start; i <= end; ++i)
+                            sum += (double) temp[i * res_d.x() + x];
+                        luminance_d[y * res_d.x() + x] =
+                            ScalarFloat(sum / (end - start + 1));
+                    }
+                }
+            }
+        );
+
+        m_warp = Warp(luminance_d.get(), res_d, {}, {}, true, true,
+                      m_warp_half_precision);
+    }
+
     UnpolarizedSpectrum eval_spectrum(Point2f uv, const Wavelength &wavelengths,
                                       Mask active, bool include_whitepoint = true) const {
         ScalarVector2u res = { m_data.shape(1), m_data.shape(0) };
@@ -527,6 +614,8 @@ protected:
     ScalarBoundingSphere3f m_bsphere;
     TensorXf m_data;
     Warp m_warp;
+    uint32_t m_warp_downsampling;
+    bool m_warp_half_precision;
     ref<Texture> m_d65;
     Float m_scale;
 };
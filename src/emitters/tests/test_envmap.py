@@ -78,3 +78,30 @@ def test02_sampling_weights(variants_vec_backends_once_rgb):
     ds.d = -ray.d
     w4 = emitter.eval(si) / emitter.pdf_direction(si, ds) * dr.pi
     assert dr.allclose(w4, w, rtol=1e-3)
+
+
+@pytest.mark.parametrize("downsampling", [1, 4])
+@pytest.mark.parametrize("half_precision", [False, True])
+def test03_compact_warp(variants_vec_backends_once_rgb, downsampling, half_precision):
+    tempdir = tempfile.TemporaryDirectory()
+    fname = os.path.join(tempdir.name, 'out.exr')
+
+    # Smooth background with a very bright spot
+    img = dr.full(mi.TensorXf, 0.01, [100, 60])
+    img[40, 5] = 1000
+    mi.Bitmap(img).write(fname)
+
+    xml = f'<string name="filename" value="{fname}"/>' \
+          f'<integer name="warp_downsampling" value="{downsampling}"/>' \
+          f'<boolean name="warp_half_precision" value="{str(half_precision).lower()}"/>'
+    sample_func, pdf_func = mi.chi2.EmitterAdapter("envmap", xml)
+
+    chi2 = mi.chi2.ChiSquareTest(
+        domain=mi.chi2.SphericalDomain(),
+        sample_func=sample_func,
+        pdf_func=pdf_func,
+        sample_dim=2,
+        ires=32
+    )
+
+    assert chi2.run()
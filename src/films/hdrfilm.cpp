@@ -6,6 +6,7 @@
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/spiral.h>
 
 #include <mutex>
 
@@ -19,7 +20,7 @@ High dynamic range film (:monosp:`hdrfilm`)
 -------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 7
+ :extra-rows: 9
 
  * - width, height
    - |int|
@@ -55,6 +56,19 @@ High dynamic range film (:monosp:`hdrfilm`)
      improve the image quality at the edges, especially when using very large reconstruction
      filters. In general, this is not needed though. (Default: |false|, i.e. disabled)
 
+ * - half_aovs
+   - |string|
+   - Comma-separated list of AOVs (e.g. :monosp:`nn,dd`), whose channels are accumulated
+     at half precision to reduce the memory usage of the film, or :monosp:`*` to store all AOVs
+     at half precision. The color, alpha and weight channels always use full precision. Only
+     supported in scalar variants. (Default: none)
+
+ * - stream_filename
+   - |string|
+   - If specified, completed regions of the image are developed and written to this
+     tiled OpenEXR file while rendering, instead of keeping the whole image in memory.
+     See below for details. Only supported in scalar variants. (Default: disabled)
+
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -98,6 +112,22 @@ data. PFM output is restricted to :monosp:`float32`-valued images using the :mon
 :monosp:`luminance` pixel formats. Due to the superior accuracy and adoption of OpenEXR, the use of
 these two alternative formats is discouraged however.
 
+When rendering images that do not fit into memory (e.g. gigapixel panoramas), the film can
+stream its output to disk by setting the :monosp:`stream_filename` parameter. The block-based
+renderer of the scalar variants then informs the film about the blocks it will submit, and the
+film only accumulates the tiles of the image that are currently being rendered. As soon as all
+blocks overlapping a tile (including the border of the reconstruction filter) have been merged,
+the tile is developed and written to a tiled OpenEXR file. The amount of memory needed is thus
+proportional to the perimeter of the spiral traversal rather than the image area. Since every
+pass of a rendering visits the complete image, this is most effective when rendering with a
+single pass (i.e. without specifying :monosp:`samples_per_pass`). Calling :monosp:`write()`
+merely completes the streamed file (which remains at :monosp:`stream_filename`). Once the file is
+complete, :monosp:`develop()` and :monosp:`bitmap()` read the image back from disk, which requires
+enough memory to hold it. Pass :monosp:`develop=False` to the integrator's :monosp:`render()`
+function to avoid this. The raw (unnormalized) film contents are not available in this mode.
+When the integrator only renders a partition of the image blocks (e.g. as a worker of a
+distributed rendering), the remaining tiles of the streamed image are left blank.
+
 When RGB(A) output is selected, the measured spectral power distributions are
 converted to linear RGB based on the CIE 1931 XYZ color matching curves and
 the ITU-R Rec. BT.709-3 primaries with a D65 white point.
@@ -215,6 +245,34 @@ public:
             }
         }
 
+        for (const std::string &name : string::tokenize(props.string("half_aovs", ""), " ,"))
+            m_half_aovs.push_back(name);
+
+        if (!m_half_aovs.empty() && dr::is_jit_v<Float>) {
+            Log(Warn, "The \"half_aovs\" parameter is only supported in scalar "
+                      "variants, storing all channels at full precision.");
+            m_half_aovs.clear();
+        }
+
+        m_stream_path = props.string("stream_filename", "");
+        if (!m_stream_path.empty()) {
+            if constexpr (dr::is_jit_v<Float>) {
+                Log(Warn, "The \"stream_filename\" parameter is only supported "
+                          "in scalar variants, keeping the image in memory.");
+                m_stream_path = fs::path();
+            } else {
+                if (m_file_format != Bitmap::FileFormat::OpenEXR)
+                    Throw("Streaming output requires file_format=\"openexr\"!");
+                if (!m_half_aovs.empty()) {
+                    Log(Warn, "The \"half_aovs\" parameter has no effect when "
+                              "streaming the output to disk.");
+                    m_half_aovs.clear();
+                }
+                if (string::to_lower(m_stream_path.extension().string()) != ".exr")
+                    m_stream_path.replace_extension(".exr");
+            }
+        }
+
         props.mark_queried("banner"); // no banner in Mitsuba 3
     }
 
@@ -235,9 +293,32 @@ public:
 
         /* locked */ {
             std::lock_guard<std::mutex> lock(m_mutex);
-            m_storage = new ImageBlock(m_crop_size, m_crop_offset,
-                                       (uint32_t) channels.size());
             m_channels = channels;
+
+            // Split the channels into full and half precision storage
+            m_full_channels.clear();
+            m_half_channels.clear();
+            for (uint32_t i = 0; i < (uint32_t) channels.size(); ++i) {
+                if (i >= base_channels && is_half_aov(channels[i]))
+                    m_half_channels.push_back(i);
+                else
+                    m_full_channels.push_back(i);
+            }
+
+            // In streaming mode, the storage is set up by prepare_blocks()
+            m_stream = nullptr;
+            m_tiles.clear();
+            m_tile_pending.clear();
+            if (m_stream_path.empty())
+                m_storage = new ImageBlock(m_crop_size, m_crop_offset,
+                                           (uint32_t) m_full_channels.size());
+            else
+                m_storage = nullptr;
+
+            m_half_storage.reset();
+            if (!m_half_channels.empty())
+                m_half_storage.reset(new dr::half[dr::prod(m_crop_size) *
+                                                  m_half_channels.size()]());
         }
 
         std::sort(channels.begin(), channels.end());
@@ -265,19 +346,324 @@ public:
                               warn /* warn_invalid */);
     }
 
+    void prepare_blocks(const ScalarPoint2i &offset, const ScalarVector2u &size,
+                        uint32_t block_size, uint32_t passes,
+                        uint32_t partition_index,
+                        uint32_t partition_count) override {
+        if (m_stream_path.empty())
+            return;
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_channels.empty())
+                Throw("HDRFilm::prepare_blocks(): prepare() must be called first!");
+
+            m_tile_size = block_size;
+            m_tile_count = (m_crop_size + block_size - 1) / block_size;
+            m_tiles.assign(dr::prod(m_tile_count), nullptr);
+            m_tile_pending.assign(dr::prod(m_tile_count), 0);
+
+            /* Count the block submissions that overlap each tile. Only the
+               blocks of the rendered partition of the spiral are submitted. */
+            uint32_t border = m_filter->border_size();
+            Spiral spiral(size, ScalarVector2u(0), block_size);
+            spiral.set_partition(partition_index, partition_count);
+            while (true) {
+                auto [rel, extent, block_id] = spiral.next_block();
+                if (block_id == (uint32_t) -1)
+                    break;
+                auto [lo, hi] = tile_range(offset + rel - (int32_t) border,
+                                           extent + 2 * border);
+                for (uint32_t ty = lo.y(); ty < hi.y(); ++ty)
+                    for (uint32_t tx = lo.x(); tx < hi.x(); ++tx)
+                        m_tile_pending[ty * m_tile_count.x() + tx] += passes;
+            }
+
+            m_tiles_left = 0;
+            for (uint32_t pending : m_tile_pending)
+                m_tiles_left += pending > 0 ? 1 : 0;
+
+            // Determine the channel layout of the output from an empty pixel
+            std::vector<ScalarFloat> pixel(m_channels.size(), 0.f);
+            ref<Bitmap> layout = convert_component_format(
+                develop_bitmap(raw_bitmap(pixel.data(), ScalarVector2u(1))));
+
+            m_stream = new TiledEXRWriter(m_stream_path, layout, m_crop_size,
+                                          block_size);
+
+            // Tiles that no submitted block overlaps are written right away
+            std::vector<std::string> names;
+            for (const Struct::Field &field : *layout->struct_())
+                names.push_back(field.name);
+
+            ref<Bitmap> blank;
+            for (uint32_t i = 0; i < (uint32_t) m_tile_pending.size(); ++i) {
+                if (m_tile_pending[i] != 0)
+                    continue;
+                ScalarVector2u tile(i % m_tile_count.x(), i / m_tile_count.x()),
+                               tile_size = dr::minimum(
+                                   block_size, m_crop_size - tile * block_size);
+                if (!blank || blank->size() != tile_size) {
+                    blank = new Bitmap(layout->pixel_format(),
+                                       layout->component_format(), tile_size,
+                                       names.size(), names);
+                    blank->clear();
+                }
+                m_stream->write_tile(tile, blank);
+            }
+
+            Log(Info, "Streaming the image to \"%s\" (%u tiles) ..",
+                m_stream_path.string(), dr::prod(m_tile_count));
+        } else {
+            DRJIT_MARK_USED(offset);
+            DRJIT_MARK_USED(size);
+            DRJIT_MARK_USED(block_size);
+            DRJIT_MARK_USED(passes);
+            DRJIT_MARK_USED(partition_index);
+            DRJIT_MARK_USED(partition_count);
+        }
+    }
+
     void put_block(const ImageBlock *block) override {
+        if (!m_stream_path.empty()) {
+            put_block_streamed(block);
+            return;
+        }
+
         Assert(m_storage != nullptr);
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_storage->put_block(block);
+        if (m_half_channels.empty()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_storage->put_block(block);
+            return;
+        }
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            uint32_t source_ch = block->channel_count(),
+                     full_ch   = (uint32_t) m_full_channels.size(),
+                     half_ch   = (uint32_t) m_half_channels.size();
+
+            if (source_ch != m_channels.size())
+                Throw("HDRFilm::put_block(): mismatched channel counts! (%u, "
+                      "expected %u)", source_ch, m_channels.size());
+
+            ScalarVector2u size = block->size() + 2 * block->border_size();
+            ScalarPoint2i block_offset = block->offset() - block->border_size(),
+                          offset = block_offset - ScalarPoint2i(m_crop_offset);
+
+            // Full precision channels are accumulated by the image block
+            size_t shape[3] = { size.y(), size.x(), full_ch };
+            auto full = dr::zeros<DynamicBuffer<ScalarFloat>>(dr::prod(size) * full_ch);
+            const ScalarFloat *source = block->tensor().data();
+            ScalarFloat *target = full.data();
+            for (size_t i = 0; i < dr::prod(size); ++i) {
+                for (uint32_t k = 0; k < full_ch; ++k)
+                    *target++ = source[m_full_channels[k]];
+                source += source_ch;
+            }
+
+            ref<ImageBlock> full_block = new ImageBlock(
+                TensorXf(full, 3, shape), block_offset, nullptr,
+                false /* border */, false /* normalize */, false /* coalesce */,
+                false /* warn_negative */, false /* warn_invalid */);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_storage->put_block(full_block);
+
+            /* The remaining channels store the running mean (i.e. the sum
+               divided by the accumulated weight) at half precision. Unlike
+               the sum, the mean stays within the range of half precision
+               values, and new samples are not lost to rounding. */
+            uint32_t weight_ch = has_flag(m_flags, FilmFlags::Alpha) ? 4 : 3;
+            const ScalarFloat *accum = m_storage->tensor().data();
+            for (uint32_t y = 0; y < size.y(); ++y) {
+                int32_t ty = offset.y() + (int32_t) y;
+                if (ty < 0 || ty >= (int32_t) m_crop_size.y())
+                    continue;
+
+                for (uint32_t x = 0; x < size.x(); ++x) {
+                    int32_t tx = offset.x() + (int32_t) x;
+                    if (tx < 0 || tx >= (int32_t) m_crop_size.x())
+                        continue;
+
+                    size_t pixel = (size_t) ty * m_crop_size.x() + tx;
+                    const ScalarFloat *src = block->tensor().data() +
+                        ((size_t) y * size.x() + x) * source_ch;
+                    dr::half *dst = m_half_storage.get() + pixel * half_ch;
+
+                    float weight     = (float) accum[pixel * full_ch + weight_ch],
+                          weight_src = (float) src[weight_ch];
+
+                    // The sum is not representable for a zero total weight
+                    if (weight == 0.f) {
+                        for (uint32_t k = 0; k < half_ch; ++k)
+                            dst[k] = dr::half(0.f);
+                        continue;
+                    }
+
+                    for (uint32_t k = 0; k < half_ch; ++k) {
+                        float mean = (float) dst[k];
+                        mean += ((float) src[m_half_channels[k]] -
+                                 weight_src * mean) / weight;
+                        dst[k] = dr::half(mean);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Merge a block into the overlapping tiles and write the completed ones
+    void put_block_streamed(const ImageBlock *block) {
+        if (!m_stream)
+            Throw("HDRFilm::put_block(): streaming the output requires a "
+                  "block-based renderer that calls prepare_blocks()!");
+
+        auto [lo, hi] =
+            tile_range(block->offset() - block->border_size(),
+                       block->size() + 2 * block->border_size());
+
+        std::vector<std::pair<uint32_t, ref<ImageBlock>>> finished;
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (uint32_t ty = lo.y(); ty < hi.y(); ++ty) {
+                for (uint32_t tx = lo.x(); tx < hi.x(); ++tx) {
+                    uint32_t index = ty * m_tile_count.x() + tx;
+
+                    // Tile was already written, e.g. by an early write()
+                    if (m_tile_pending[index] == 0)
+                        continue;
+
+                    ref<ImageBlock> &tile = m_tiles[index];
+                    if (!tile) {
+                        ScalarVector2u tile_offset =
+                            ScalarVector2u(tx, ty) * m_tile_size;
+                        tile = new ImageBlock(
+                            dr::minimum(m_tile_size, m_crop_size - tile_offset),
+                            m_crop_offset + tile_offset,
+                            (uint32_t) m_channels.size());
+                    }
+                    tile->put_block(block);
+
+                    if (--m_tile_pending[index] == 0) {
+                        finished.emplace_back(index, tile);
+                        tile = nullptr;
+                    }
+                }
+            }
+        }
+
+        // Develop and write the completed tiles outside of the critical section
+        for (auto &[index, tile] : finished)
+            write_tile(index, tile);
+
+        if (!finished.empty()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tiles_left -= (uint32_t) finished.size();
+            if (m_tiles_left == 0) {
+                m_stream->close();
+                Log(Info, "Finished streaming the image to \"%s\".",
+                    m_stream_path.string());
+            }
+        }
+    }
+
+    /// Develop a tile of the streamed output and write it to disk
+    void write_tile(uint32_t index, const ImageBlock *tile) const {
+        if constexpr (!dr::is_jit_v<Float>) {
+            ref<Bitmap> source =
+                raw_bitmap(tile->tensor().data(), tile->size());
+            m_stream->write_tile(
+                ScalarVector2u(index % m_tile_count.x(), index / m_tile_count.x()),
+                convert_component_format(develop_bitmap(source)));
+        } else {
+            DRJIT_MARK_USED(index);
+            DRJIT_MARK_USED(tile);
+        }
+    }
+
+    /**
+     * \brief Return the range of tiles (of the streamed output) that overlap
+     * the given region of the film
+     *
+     * \return The first tile and the (exclusive) upper bound on both axes
+     */
+    std::pair<ScalarVector2u, ScalarVector2u>
+    tile_range(const ScalarPoint2i &offset, const ScalarVector2u &size) const {
+        ScalarVector2i p0 = offset - ScalarVector2i(m_crop_offset),
+                       p1 = p0 + ScalarVector2i(size);
+        p0 = dr::maximum(p0, 0);
+        p1 = dr::minimum(p1, ScalarVector2i(m_crop_size));
+
+        if (dr::any(p1 <= p0))
+            return { ScalarVector2u(0), ScalarVector2u(0) };
+
+        return { ScalarVector2u(p0) / m_tile_size,
+                 (ScalarVector2u(p1) - 1) / m_tile_size + 1 };
+    }
+
+    /**
+     * \brief Read back the image that was streamed to disk
+     *
+     * Only the developed image is available, and only once all tiles were
+     * written (or after \ref write() completed the file).
+     */
+    ref<Bitmap> streamed_bitmap(bool raw) const {
+        if (raw)
+            Throw("The image was streamed to \"%s\", its raw contents are "
+                  "not kept in memory!", m_stream_path.string());
+
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_stream || m_tiles_left != 0)
+                Throw("The image that is streamed to \"%s\" is not complete "
+                      "yet!", m_stream_path.string());
+        }
+
+        m_stream->close();
+        ref<Bitmap> bitmap = new Bitmap(m_stream_path);
+        return bitmap->convert(bitmap->pixel_format(),
+                               struct_type_v<ScalarFloat>, false);
+    }
+
+    /// Return the raw contents of the film with all channels at full precision
+    TensorXf storage_tensor() const {
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (!m_half_channels.empty()) {
+                uint32_t full_ch  = (uint32_t) m_full_channels.size(),
+                         half_ch  = (uint32_t) m_half_channels.size(),
+                         channels = full_ch + half_ch;
+                size_t pixels = dr::prod(m_storage->size());
+
+                auto result = dr::zeros<DynamicBuffer<ScalarFloat>>(pixels * channels);
+                const ScalarFloat *full = m_storage->tensor().data();
+                const dr::half *half = m_half_storage.get();
+                ScalarFloat *target = result.data();
+                uint32_t weight_ch = has_flag(m_flags, FilmFlags::Alpha) ? 4 : 3;
+                for (size_t i = 0; i < pixels; ++i) {
+                    // Convert the running means back into weighted sums
+                    ScalarFloat weight = full[weight_ch];
+                    for (uint32_t k = 0; k < full_ch; ++k)
+                        target[m_full_channels[k]] = *full++;
+                    for (uint32_t k = 0; k < half_ch; ++k)
+                        target[m_half_channels[k]] = (float) *half++ * weight;
+                    target += channels;
+                }
+
+                size_t shape[3] = { m_storage->size().y(), m_storage->size().x(),
+                                    channels };
+                return TensorXf(result, 3, shape);
+            }
+        }
+
+        return m_storage->tensor();
     }
 
     TensorXf develop(bool raw = false) const override {
-        if (!m_storage)
+        if (!m_storage && m_stream_path.empty())
             Throw("No storage allocated, was prepare() called first?");
 
-        if (raw) {
+        if (raw && m_stream_path.empty()) {
             std::lock_guard<std::mutex> lock(m_mutex);
-            return m_storage->tensor();
+            return storage_tensor();
         }
 
         if constexpr (dr::is_jit_v<Float>) {
@@ -374,7 +760,8 @@ public:
 
             return TensorXf(values, 3, shape);
         } else {
-            ref<Bitmap> source = bitmap();
+            // Streamed images are read back from disk by bitmap()
+            ref<Bitmap> source = bitmap(raw);
             ScalarVector2i size = source->size();
             size_t width = source->channel_count() * dr::prod(size);
             auto data = dr::load<DynamicBuffer<ScalarFloat>>(source->data(), width);
@@ -387,31 +774,60 @@ public:
         }
     }
 
+    bool streams_output() const override { return !m_stream_path.empty(); }
+
     ref<Bitmap> bitmap(bool raw = false) const override {
+        if (!m_stream_path.empty())
+            return streamed_bitmap(raw);
         if (!m_storage)
             Throw("No storage allocated, was prepare() called first?");
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto &&storage = dr::migrate(m_storage->tensor().array(), AllocType::Host);
+        /* Only snapshot the storage while holding the lock so that concurrent
+           put_block() calls (e.g. during a live preview) are not stalled for
+           the duration of the development step */
+        TensorXf tensor;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            tensor = storage_tensor();
+        }
+        auto &&storage = dr::migrate(tensor.array(), AllocType::Host);
 
         if constexpr (dr::is_jit_v<Float>)
             dr::sync_thread();
 
+        ref<Bitmap> source =
+            raw_bitmap((const ScalarFloat *) storage.data(), m_storage->size());
+
+        if (raw) {
+            // The host copy of JIT storage is released when returning
+            if constexpr (dr::is_jit_v<Float>)
+                return new Bitmap(*source);
+            return source;
+        }
+
+        return develop_bitmap(source);
+    }
+
+    /// Wrap raw (unnormalized) film contents into a bitmap without copying them
+    ref<Bitmap> raw_bitmap(const ScalarFloat *data,
+                           const ScalarVector2u &size) const {
         bool alpha = has_flag(m_flags, FilmFlags::Alpha);
-        uint32_t base_ch = alpha ? 5 : 4;
-        bool has_aovs  = m_channels.size() != base_ch;
+        bool has_aovs = m_channels.size() != (alpha ? 5 : 4);
 
         Bitmap::PixelFormat source_fmt = !has_aovs
                                      ? (alpha ? Bitmap::PixelFormat::RGBAW
                                               : Bitmap::PixelFormat::RGBW)
                                      : Bitmap::PixelFormat::MultiChannel;
 
-        ref<Bitmap> source = new Bitmap(
-            source_fmt, struct_type_v<ScalarFloat>, m_storage->size(),
-            m_storage->channel_count(), m_channels, (uint8_t *) storage.data());
+        return new Bitmap(source_fmt, struct_type_v<ScalarFloat>, size,
+                          m_channels.size(), m_channels, (uint8_t *) data);
+    }
 
-        if (raw)
-            return source;
+    /// Normalize a raw bitmap and convert it to the output pixel format
+    ref<Bitmap> develop_bitmap(Bitmap *source) const {
+        bool alpha = has_flag(m_flags, FilmFlags::Alpha);
+        uint32_t base_ch = alpha ? 5 : 4;
+        bool has_aovs  = m_channels.size() != base_ch;
 
         bool to_rgb    = m_pixel_format == Bitmap::PixelFormat::RGB ||
                          m_pixel_format == Bitmap::PixelFormat::RGBA;
@@ -423,11 +839,11 @@ public:
         uint32_t img_ch = to_y ? 1 : 3;
         uint32_t aovs_channel = has_aovs ? (img_ch + (uint32_t) alpha) : 0;
         uint32_t target_ch =
-            (uint32_t) m_storage->channel_count() - base_ch + aovs_channel;
+            (uint32_t) m_channels.size() - base_ch + aovs_channel;
 
         ref<Bitmap> target = new Bitmap(
             has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            struct_type_v<ScalarFloat>, m_storage->size(),
+            struct_type_v<ScalarFloat>, source->size(),
             has_aovs ? target_ch : 0);
 
         if (has_aovs) {
@@ -514,6 +930,11 @@ public:
     }
 
     void write(const fs::path &path) const override {
+        if (!m_stream_path.empty()) {
+            finish_stream(path);
+            return;
+        }
+
         fs::path filename = path;
         std::string proper_extension;
         if (m_file_format == Bitmap::FileFormat::OpenEXR)
@@ -533,29 +954,73 @@ public:
             Log(Info, "Developing \"%s\" ..", filename.string());
         #endif
 
-        ref<Bitmap> source = bitmap();
-        if (m_component_format != struct_type_v<ScalarFloat>) {
-            // Mismatch between the current format and the one expected by the film
-            // Conversion is necessary before saving to disk
-            std::vector<std::string> channel_names;
-            for (size_t i = 0; i < source->channel_count(); i++)
-                channel_names.push_back(source->struct_()->operator[](i).name);
-            ref<Bitmap> target = new Bitmap(
-                source->pixel_format(),
-                m_component_format,
-                source->size(),
-                source->channel_count(),
-                channel_names);
-            source->convert(target);
-
-            target->write(filename, m_file_format);
-        } else {
-            source->write(filename, m_file_format);
+        convert_component_format(bitmap())->write(filename, m_file_format);
+    }
+
+    /// Convert a developed bitmap to the component format of the output file
+    ref<Bitmap> convert_component_format(Bitmap *source) const {
+        if (m_component_format == struct_type_v<ScalarFloat>)
+            return source;
+
+        // Mismatch between the current format and the one expected by the film
+        // Conversion is necessary before saving to disk
+        std::vector<std::string> channel_names;
+        for (size_t i = 0; i < source->channel_count(); i++)
+            channel_names.push_back(source->struct_()->operator[](i).name);
+        ref<Bitmap> target = new Bitmap(
+            source->pixel_format(),
+            m_component_format,
+            source->size(),
+            source->channel_count(),
+            channel_names);
+        source->convert(target);
+        return target;
+    }
+
+    /**
+     * Write the remaining tiles of the streamed output and complete the file.
+     * Tiles are only outstanding if the rendering was interrupted.
+     */
+    void finish_stream(const fs::path &path) const {
+        std::vector<std::pair<uint32_t, ref<ImageBlock>>> remaining;
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_stream)
+                Throw("No image was streamed, was the film used by a "
+                      "block-based renderer?");
+
+            for (uint32_t i = 0; i < (uint32_t) m_tiles.size(); ++i) {
+                if (m_tile_pending[i] == 0)
+                    continue;
+                m_tile_pending[i] = 0;
+                if (m_tiles[i])
+                    remaining.emplace_back(i, m_tiles[i]);
+                m_tiles[i] = nullptr;
+            }
+            m_tiles_left = 0;
         }
+
+        if (!remaining.empty())
+            Log(Warn, "Writing %zu incomplete tile%s of the streamed image.",
+                remaining.size(), remaining.size() == 1 ? "" : "s");
+
+        for (auto &[index, tile] : remaining)
+            write_tile(index, tile);
+
+        m_stream->close();
+
+        fs::path filename = path;
+        filename.replace_extension(".exr");
+        if (filename == m_stream_path)
+            Log(Info, "The image was streamed to \"%s\".", m_stream_path.string());
+        else
+            Log(Warn, "The image was streamed to \"%s\" instead of \"%s\".",
+                m_stream_path.string(), filename.string());
     }
 
     void schedule_storage() override {
-        dr::schedule(m_storage->tensor());
+        if (m_storage)
+            dr::schedule(m_storage->tensor());
     };
 
     std::string to_string() const override {
@@ -574,6 +1039,17 @@ public:
     }
 
     MI_DECLARE_CLASS()
+protected:
+    /// Check whether an AOV channel (e.g. "nn.X") is stored at half precision
+    bool is_half_aov(const std::string &channel) const {
+        for (const std::string &name : m_half_aovs) {
+            if (name == "*" || channel == name ||
+                string::starts_with(channel, name + "."))
+                return true;
+        }
+        return false;
+    }
+
 protected:
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
@@ -581,6 +1057,27 @@ protected:
     ref<ImageBlock> m_storage;
     mutable std::mutex m_mutex;
     std::vector<std::string> m_channels;
+
+    /// AOVs stored at half precision (see \ref is_half_aov())
+    std::vector<std::string> m_half_aovs;
+    /// Indices of the channels in \ref m_storage and \ref m_half_storage
+    std::vector<uint32_t> m_full_channels, m_half_channels;
+    /// Running means of the half precision channels (scalar variants only)
+    std::unique_ptr<dr::half[]> m_half_storage;
+
+    /// Target of the streamed output (empty if the image is kept in memory)
+    fs::path m_stream_path;
+    /// Writer of the streamed output, created by \ref prepare_blocks()
+    mutable ref<TiledEXRWriter> m_stream;
+    /// Size of the tiles of the streamed output and their number on each axis
+    uint32_t m_tile_size = 0;
+    ScalarVector2u m_tile_count;
+    /// Partially accumulated tiles (\c nullptr when untouched or written)
+    mutable std::vector<ref<ImageBlock>> m_tiles;
+    /// Number of block submissions that each tile is still waiting for
+    mutable std::vector<uint32_t> m_tile_pending;
+    /// Number of tiles that have not been written yet
+    mutable uint32_t m_tiles_left = 0;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
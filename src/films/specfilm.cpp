@@ -371,8 +371,12 @@ public:
             struct_type_v<ScalarFloat>, m_storage->size(),
             m_storage->channel_count(), m_channels, (uint8_t *) storage.data());
 
-        if (raw)
+        if (raw) {
+            // The host copy of JIT storage is released when returning
+            if constexpr (dr::is_jit_v<Float>)
+                return new Bitmap(*source);
             return source;
+        }
 
         ref<Bitmap> target = new Bitmap(
             Bitmap::PixelFormat::MultiChannel,
@@ -223,3 +223,122 @@ def test06_empty_film(variants_all_rgb, develop):
     else:
         image = mi.TensorXf(film.bitmap())
         assert dr.all((image == 0) | dr.isnan(image))
+
+
+def test07_half_aovs(variant_scalar_rgb):
+    # AOVs stored at half precision develop to (almost) the same image
+    aovs_channels = ['aa.X', 'aa.Y']
+    images = []
+    for half_aovs in ['', '*', 'aa']:
+        film = mi.load_dict({
+            'type': 'hdrfilm',
+            'width': 3,
+            'height': 2,
+            'half_aovs': half_aovs,
+            'rfilter': { 'type': 'box' }
+        })
+        film.prepare(aovs_channels)
+
+        block = film.create_block()
+        for y in range(2):
+            for x in range(3):
+                block.put([x + 0.5, y + 0.5], [x, y, 0.1, 1.0, 0.3 * x, 2 + y])
+        film.put_block(block)
+        images.append(film.develop(raw=True))
+
+    for image in images[1:]:
+        assert dr.allclose(image, images[0], rtol=1e-3)
+
+
+@pytest.mark.parametrize('samples_per_pass', [4, 2])
+def test08_stream_output(variant_scalar_rgb, tmp_path, samples_per_pass):
+    # Streamed tiles must match the image developed from memory
+    filename = str(tmp_path / 'streamed.exr')
+    images = []
+    for stream in [False, True]:
+        scene_dict = mi.cornell_box()
+        scene_dict['integrator'] = {
+            'type': 'path',
+            'block_size': 8,
+            'samples_per_pass': samples_per_pass
+        }
+        film = scene_dict['sensor']['film']
+        film['width'], film['height'] = 37, 21
+        film['component_format'] = 'float32'
+        film['rfilter'] = { 'type': 'gaussian' }
+        if stream:
+            film['stream_filename'] = filename
+        scene = mi.load_dict(scene_dict)
+
+        sensor = scene.sensors()[0]
+        assert sensor.film().streams_output() == stream
+        scene.integrator().render(scene, sensor, spp=4, develop=False)
+
+        if stream:
+            with pytest.raises(RuntimeError, match='streamed'):
+                sensor.film().develop(raw=True)
+            # The completed file is read back by develop()
+            developed = sensor.film().develop()
+            sensor.film().write(filename)
+            images.append(mi.TensorXf(mi.Bitmap(filename)))
+            assert dr.allclose(developed, images[-1])
+        else:
+            images.append(mi.TensorXf(sensor.film().bitmap()))
+
+    assert dr.shape(images[0]) == dr.shape(images[1])
+    assert dr.allclose(images[0], images[1], rtol=1e-4, atol=1e-5)
+
+
+def test09_half_aovs_many_samples(variant_scalar_rgb):
+    # Accumulating many blocks must neither stall nor overflow at half precision
+    aovs_channels = ['aa.X', 'aa.Y']
+    images = []
+    for half_aovs in ['', 'aa']:
+        film = mi.load_dict({
+            'type': 'hdrfilm',
+            'width': 2,
+            'height': 1,
+            'half_aovs': half_aovs,
+            'rfilter': { 'type': 'box' }
+        })
+        film.prepare(aovs_channels)
+
+        for i in range(1000):
+            block = film.create_block()
+            for x in range(2):
+                block.put([x + 0.5, 0.5],
+                          [0.5, 0.5, 0.5, 1.0, 100.0 + x, 1.0 + 0.001 * (i % 7)])
+            film.put_block(block)
+        images.append(film.develop(raw=True))
+
+    assert dr.all(dr.isfinite(images[1].array))
+    assert dr.allclose(images[1], images[0], rtol=5e-3)
+
+
+@pytest.mark.parametrize('partition_count', [2, 3])
+def test10_stream_output_partition(variant_scalar_rgb, tmp_path, partition_count):
+    # Every tile overlapped by the blocks of a partition is streamed once
+    # these blocks are done, and the partitions add up to the full image
+    scene_dict = mi.cornell_box()
+    scene_dict['integrator'] = { 'type': 'path', 'block_size': 8 }
+    film = scene_dict['sensor']['film']
+    film['width'], film['height'] = 37, 21
+    film['component_format'] = 'float32'
+    film['rfilter'] = { 'type': 'box' }
+
+    scene = mi.load_dict(scene_dict)
+    ref = mi.TensorXf(mi.render(scene, spp=4))
+
+    result = dr.zeros(mi.TensorXf, dr.shape(ref))
+    for index in range(partition_count):
+        film['stream_filename'] = str(tmp_path / f'partition_{index}.exr')
+        scene = mi.load_dict(scene_dict)
+        integrator = scene.integrator()
+        integrator.set_block_partition(index, partition_count)
+
+        # The stream is complete without calling write()
+        image = integrator.render(scene, scene.sensors()[0], spp=4)
+        result += mi.TensorXf(image)
+
+    # With a box filter, blocks do not overlap, and unrendered tiles are blank
+    assert dr.allclose(result, ref, rtol=1e-4, atol=1e-5)
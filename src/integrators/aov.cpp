@@ -24,7 +24,9 @@ Arbitrary Output Variables integrator (:monosp:`aov`)
 
 
 This integrator returns one or more AOVs (Arbitrary Output Variables) describing the visible
-surfaces.
+surfaces. The intersection of the primary ray computed for the AOVs is shared with the nested
+integrators that support it (e.g. :ref:`path <integrator-path>` and :ref:`direct
+<integrator-direct>`), so that the AOVs add almost no tracing cost.
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/bsdf_diffuse_plain.jpg
@@ -192,8 +194,12 @@ public:
 
         std::pair<Spectrum, Mask> result { 0.f, false };
 
-        SurfaceInteraction3f si = scene->ray_intersect(
+        /* Nested integrators reuse this intersection instead of tracing the
+           primary ray again, see SamplingIntegrator::sample_primary() */
+        SurfaceInteraction3f si_primary = scene->ray_intersect(
             ray, RayFlags::All | RayFlags::BoundaryTest, true, active);
+
+        SurfaceInteraction3f si = si_primary;
         dr::masked(si, !si.is_valid()) = dr::zeros<SurfaceInteraction3f>();
         size_t ctr = 0;
 
@@ -262,7 +268,8 @@ public:
 
                 case Type::IntegratorRGBA: {
                         std::pair<Spectrum, Mask> result_sub =
-                            m_integrators[ctr].first->sample(scene, sampler, ray, medium, aovs, active);
+                            m_integrators[ctr].first->sample_primary(
+                                scene, sampler, ray, si_primary, medium, aovs, active);
                         aovs += m_integrators[ctr].second;
 
                         UnpolarizedSpectrum spec_u = unpolarized_spectrum(result_sub.first);
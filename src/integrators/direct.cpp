@@ -114,13 +114,24 @@ public:
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray,
-                                     const Medium * /* medium */,
-                                     Float * /* aovs */,
+                                     const Medium *medium,
+                                     Float *aovs,
                                      Mask active) const override {
-        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
-
         SurfaceInteraction3f si = scene->ray_intersect(
             ray, +RayFlags::All, /* coherent = */ true, active);
+        return sample_primary(scene, sampler, ray, si, medium, aovs, active);
+    }
+
+    std::pair<Spectrum, Mask> sample_primary(const Scene *scene,
+                                             Sampler *sampler,
+                                             const RayDifferential3f &ray,
+                                             const SurfaceInteraction3f &si_,
+                                             const Medium * /* medium */,
+                                             Float * /* aovs */,
+                                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        SurfaceInteraction3f si = si_;
         Mask valid_ray = active && si.is_valid();
 
         Spectrum result(0.f);
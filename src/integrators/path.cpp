@@ -1,6 +1,7 @@
 #include <random>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/integrator.h>
@@ -35,6 +36,44 @@ Path tracer (:monosp:`path`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - guiding
+   - |bool|
+   - Learn the incident radiance distribution during a sequence of training
+     passes and use it to guide directional sampling (*path guiding*, see
+     below). (Default: no, i.e. |false|)
+
+ * - guiding_budget
+   - |float|
+   - Fraction of the sample count that may be spent on training passes.
+     (Default: 0.25)
+
+ * - guiding_spatial_threshold
+   - |float|
+   - Number of samples (scaled by :math:`\sqrt{2^k}` in training pass
+     :math:`k`) above which a spatial cell of the guiding structure is split.
+     (Default: 12000)
+
+ * - guiding_rho
+   - |float|
+   - Fraction of the energy above which a directional quadrant is refined.
+     (Default: 0.01)
+
+ * - rr_mode
+   - |string|
+   - Path termination strategy: ``throughput`` applies Russian roulette based
+     on the path throughput, ``adrrs`` uses adjoint-driven Russian roulette
+     and splitting (see below). (Default: ``throughput``)
+
+ * - adrrs_window
+   - |float|
+   - Ratio between the upper and the lower bound of the weight window used by
+     adjoint-driven Russian roulette and splitting. (Default: 5)
+
+ * - adrrs_max_split
+   - |int|
+   - Maximum number of branches that adjoint-driven splitting may create at a
+     single vertex. (Default: 8)
+
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
 
@@ -67,6 +106,31 @@ relies on multiple importance sampling to combine BSDF and emitter samples. The
 main difference in comparison to the former plugin is that it considers light
 paths of arbitrary length to compute both direct and indirect illumination.
 
+Scenes where most of the light arrives through small openings (e.g. interiors
+lit through windows) are challenging for BSDF sampling. For such scenes, the
+``guiding`` parameter enables the *practical path guiding* technique by Müller
+et al. :cite:`Muller2017Practical`: the first passes of the rendering process
+learn a spatial-directional approximation of the incident radiance (a binary
+tree over the scene, with a directional quadtree in each leaf) and the final
+pass draws directions from a mixture of this distribution and the BSDF. The
+mixture weight is learned per spatial cell. Surfaces with Dirac delta or glossy
+transmission components (e.g. dielectrics) are always sampled by the BSDF. Training passes use 1, 2, 4, ...
+samples per pixel and do not contribute to the final image. They are taken
+from the sample count (up to the fraction ``guiding_budget``), and the final
+pass renders the remaining samples.
+
+By default, paths are terminated using *Russian roulette* based on their
+throughput, which tends to kill important paths in dark regions and spends
+effort on unimportant bright ones. Setting ``rr_mode`` to ``adrrs`` enables
+the *adjoint-driven Russian roulette and splitting* technique by Vorba and
+Křivánek :cite:`Vorba2016Adjoint`. It uses the guiding structure (trained in
+the same way as above, but not necessarily used for sampling) as a radiance
+cache to estimate the expected contribution of a path vertex relative to the
+pixel estimate, and then terminates paths that fall below a weight window and
+splits paths that exceed it. Split paths are traced one branch after the
+other, which keeps the state per sample bounded in the wavefront formulation
+used by the JIT variants.
+
 .. note:: This integrator does not handle participating media
 
 .. tabs::
@@ -87,17 +151,44 @@ paths of arbitrary length to compute both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
-    MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
-
-    PathIntegrator(const Properties &props) : Base(props) { }
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                   m_guide, m_adrrs, adrrs_factors)
+    MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr,
+                    SDTree)
+    using GuidingPath = mitsuba::GuidingPath<Float, Spectrum>;
+
+    PathIntegrator(const Properties &props) : Base(props) {
+        this->init_guiding(props);
+    }
 
     std::pair<Spectrum, Bool> sample(const Scene *scene,
                                      Sampler *sampler,
-                                     const RayDifferential3f &ray_,
+                                     const RayDifferential3f &ray,
                                      const Medium * /* medium */,
                                      Float * /* aovs */,
                                      Bool active) const override {
+        return sample_impl(scene, sampler, ray, nullptr, active);
+    }
+
+    std::pair<Spectrum, Bool> sample_primary(const Scene *scene,
+                                             Sampler *sampler,
+                                             const RayDifferential3f &ray,
+                                             const SurfaceInteraction3f &si,
+                                             const Medium * /* medium */,
+                                             Float * /* aovs */,
+                                             Bool active) const override {
+        return sample_impl(scene, sampler, ray, &si, active);
+    }
+
+    /**
+     * \brief Path tracer implementation, which optionally reuses the
+     * intersection \c primary of the first ray with the scene
+     */
+    std::pair<Spectrum, Bool> sample_impl(const Scene *scene,
+                                          Sampler *sampler,
+                                          const RayDifferential3f &ray_,
+                                          const SurfaceInteraction3f *primary,
+                                          Bool active) const {
         MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
         if (unlikely(m_max_depth == 0))
@@ -120,6 +211,23 @@ public:
         Bool          prev_bsdf_delta = true;
         BSDFContext   bsdf_ctx;
 
+        // Vertices whose incident radiance is recorded for path guiding
+        bool recording = m_guide && m_guide->training();
+        GuidingPath guide_path = dr::zeros<GuidingPath>();
+
+        /* Adjoint-driven Russian roulette and splitting. The branches of a
+           split vertex are traced sequentially: the vertex is stored and
+           re-entered once the current branch terminates. Vertices are only
+           split while no branch of a previous split is pending. */
+        bool adrrs = m_adrrs && m_guide->ready() && !m_guide->training();
+        Float pixel_estimate          = 0.f;
+        Ray3f split_ray               = dr::zeros<Ray3f>();
+        Spectrum split_throughput     = 0.f;
+        Float split_eta               = 1.f;
+        UInt32 split_depth            = 0;
+        UInt32 split_count            = 0;
+        Mask resume                   = false;
+
         /* Set up a Dr.Jit loop. This optimizes away to a normal loop in scalar
            mode, and it generates either a a megakernel (default) or
            wavefront-style renderer in JIT variants. This can be controlled by
@@ -130,23 +238,60 @@ public:
            debugging. The subsequent list registers all variables that encode
            the loop state variables. This is crucial: omitting a variable may
            lead to undefined behavior. */
-        dr::Loop<Bool> loop("Path Tracer", sampler, ray, throughput, result,
-                            eta, depth, valid_ray, prev_si, prev_bsdf_pdf,
-                            prev_bsdf_delta, active);
+        dr::Loop<Bool> loop("Path Tracer");
+        loop.put(ray, throughput, result, eta, depth, valid_ray, prev_si,
+                 prev_bsdf_pdf, prev_bsdf_delta, active);
+        sampler->loop_put(loop);
+        if (recording)
+            loop.put(guide_path);
+        if (adrrs)
+            loop.put(pixel_estimate, split_ray, split_throughput, split_eta,
+                     split_depth, split_count, resume);
+        loop.init();
 
         /* Inform the loop about the maximum number of loop iterations.
            This accelerates wavefront-style rendering by avoiding costly
            synchronization points that check the 'active' flag. */
-        loop.set_max_iterations(m_max_depth);
+        if (!adrrs)
+            loop.set_max_iterations(m_max_depth);
+
+        // Start the next branch of a split vertex when the current one ended
+        auto next_branch = [&]() {
+            resume = !active && split_count > 0u;
+            dr::masked(split_count, resume) -= 1u;
+            dr::masked(ray, resume) = split_ray;
+            dr::masked(throughput, resume) = split_throughput;
+            dr::masked(eta, resume) = split_eta;
+            dr::masked(depth, resume) = split_depth;
+            active |= resume;
+        };
 
         while (loop(active)) {
             /* dr::Loop implicitly masks all code in the loop using the 'active'
                flag, so there is no need to pass it to every function */
 
-            SurfaceInteraction3f si =
-                scene->ray_intersect(ray,
-                                     /* ray_flags = */ +RayFlags::All,
-                                     /* coherent = */ dr::eq(depth, 0u));
+            SurfaceInteraction3f si;
+            if (!primary) {
+                si = scene->ray_intersect(ray,
+                                          /* ray_flags = */ +RayFlags::All,
+                                          /* coherent = */ dr::eq(depth, 0u));
+            } else {
+                /* Reuse the intersection of the primary ray computed by the
+                   caller (this includes split branches re-entering it) */
+                Mask first = dr::eq(depth, 0u);
+                if (dr::all_or<false>(first)) {
+                    si = *primary;
+                } else {
+                    si = scene->ray_intersect(ray, +RayFlags::All,
+                                              /* coherent = */ false, !first);
+                    dr::masked(si, first) = *primary;
+                }
+            }
+
+            /* Branches of a split vertex re-enter it by tracing the same ray
+               again, but must not account for its emission and emitter
+               samples a second time */
+            Mask fresh = !resume;
 
             // ---------------------- Direct emission ----------------------
 
@@ -155,7 +300,7 @@ public:
                each Monte Carlo sample runs independently. In this case,
                dr::any_or<..>() returns the template argument (true) which means
                that the 'if' statement is always conservatively taken. */
-            if (dr::any_or<true>(dr::neq(si.emitter(scene), nullptr))) {
+            if (dr::any_or<true>(dr::neq(si.emitter(scene), nullptr) && fresh)) {
                 DirectionSample3f ds(scene, si, prev_si);
                 Float em_pdf = 0.f;
 
@@ -166,24 +311,42 @@ public:
                 // Compute MIS weight for emitter sample from previous bounce
                 Float mis_bsdf = mis_weight(prev_bsdf_pdf, em_pdf);
 
+                Spectrum emitted =
+                    ds.emitter->eval(si, prev_bsdf_pdf > 0.f) * mis_bsdf;
+
                 // Accumulate, being careful with polarization (see spec_fma)
-                result = spec_fma(
-                    throughput,
-                    ds.emitter->eval(si, prev_bsdf_pdf > 0.f) * mis_bsdf,
-                    result);
+                result[fresh] = spec_fma(throughput, emitted, result);
+
+                if (recording)
+                    guide_path.add_radiance(throughput * emitted, active);
             }
 
             // Continue tracing the path at this point?
             Bool active_next = (depth + 1 < m_max_depth) && si.is_valid();
 
-            if (dr::none_or<false>(active_next))
-                break; // early exit for scalar mode
+            if (dr::none_or<false>(active_next)) {
+                // Early exit for scalar mode, unless a split branch is pending
+                if (dr::none_or<false>(split_count > 0u))
+                    break;
+                active = false;
+                next_branch();
+                continue;
+            }
 
             // ---------------------- Emitter sampling ----------------------
 
             // Perform emitter sampling?
             BSDFPtr bsdf = si.bsdf(ray);
-            Mask active_em = active_next && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+            Mask active_em = active_next && fresh &&
+                             has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+            // Look up the guiding distribution for smooth BSDFs
+            UInt32 dtree = 0;
+            Mask guided = false;
+            if (m_guide) {
+                guided = m_guide->guidable(bsdf, active_next);
+                dtree = m_guide->lookup(si.p, guided);
+            }
 
             if (dr::any_or<true>(active_em)) {
                 // Sample the emitter
@@ -205,13 +368,58 @@ public:
                     bsdf->eval_pdf(bsdf_ctx, si, wo, active_em);
                 bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
+                // Account for guided sampling in the density of BSDF samples
+                if (m_guide)
+                    bsdf_pdf = m_guide->mixture_pdf(dtree, ds.d, bsdf_pdf,
+                                                    guided && active_em);
+
                 // Compute the MIS weight
                 Float mis_em =
                     dr::select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
 
+                Spectrum contrib = bsdf_val * em_weight * mis_em;
+
                 // Accumulate, being careful with polarization (see spec_fma)
-                result[active_em] = spec_fma(
-                    throughput, bsdf_val * em_weight * mis_em, result);
+                result[active_em] = spec_fma(throughput, contrib, result);
+
+                if (recording)
+                    guide_path.add_radiance(throughput * contrib, active_em);
+            }
+
+            // -------------- Adjoint-driven roulette and splitting --------------
+
+            /* Compare the expected contribution of the continuation against
+               the pixel estimate, which is the value of the first vertex.
+               Regular roulette is only replaced where this comparison took
+               place, i.e. not at vertices without a smooth BSDF, re-entered
+               split vertices, or when the pixel estimate is zero. */
+            Mask adrrs_vertex = false;
+            if (adrrs) {
+                Mask adrrs_active = guided && fresh;
+                Float expected =
+                    dr::mean(unpolarized_spectrum(throughput)) *
+                    m_guide->reflected_radiance(bsdf_ctx, bsdf, si, dtree,
+                                                sampler->next_2d(), adrrs_active);
+
+                dr::masked(pixel_estimate, adrrs_active && dr::eq(depth, 0u)) =
+                    dr::mean(unpolarized_spectrum(result)) + expected;
+
+                auto [survival, split] =
+                    adrrs_factors(expected, pixel_estimate, adrrs_active);
+                adrrs_vertex = adrrs_active && pixel_estimate > 0.f;
+
+                Mask rr_continue = sampler->next_1d() < survival;
+                throughput[adrrs_active] *= dr::rcp(dr::detach(survival));
+                active_next &= !adrrs_active || rr_continue;
+
+                Mask do_split = adrrs_active && active_next && split > 1u &&
+                                dr::eq(split_count, 0u);
+                throughput[do_split] *= dr::rcp(Float(split));
+                dr::masked(split_count, do_split) = split - 1u;
+                dr::masked(split_ray, do_split) = ray;
+                dr::masked(split_throughput, do_split) = throughput;
+                dr::masked(split_eta, do_split) = eta;
+                dr::masked(split_depth, do_split) = depth;
             }
 
             // ---------------------- BSDF sampling ----------------------
@@ -219,8 +427,18 @@ public:
             Float sample_1 = sampler->next_1d();
             Point2f sample_2 = sampler->next_2d();
 
-            auto [bsdf_sample, bsdf_weight] =
-                bsdf->sample(bsdf_ctx, si, sample_1, sample_2, active_next);
+            BSDFSample3f bsdf_sample = dr::zeros<BSDFSample3f>();
+            Spectrum bsdf_weight;
+            Float guide_grad = 0.f;
+
+            if (m_guide)
+                std::tie(bsdf_sample, bsdf_weight, guide_grad) =
+                    m_guide->sample_bsdf(bsdf_ctx, bsdf, si, dtree, sample_1,
+                                         sample_2, guided, active_next);
+            else
+                std::tie(bsdf_sample, bsdf_weight) =
+                    bsdf->sample(bsdf_ctx, si, sample_1, sample_2, active_next);
+
             bsdf_weight = si.to_world_mueller(bsdf_weight, -bsdf_sample.wo, si.wi);
 
             ray = si.spawn_ray(si.to_world(bsdf_sample.wo));
@@ -246,6 +464,10 @@ public:
             valid_ray |= active && si.is_valid() &&
                          !has_flag(bsdf_sample.sampled_type, BSDFFlags::Null);
 
+            if (recording)
+                guide_path.add_vertex(dtree, ray.d, throughput,
+                                      bsdf_sample.pdf, guide_grad, guided);
+
             // Information about the current vertex needed by the next iteration
             prev_si = si;
             prev_bsdf_pdf = bsdf_sample.pdf;
@@ -258,7 +480,7 @@ public:
             Float throughput_max = dr::max(unpolarized_spectrum(throughput));
 
             Float rr_prob = dr::minimum(throughput_max * dr::sqr(eta), .95f);
-            Mask rr_active = depth >= m_rr_depth,
+            Mask rr_active = depth >= m_rr_depth && !adrrs_vertex,
                  rr_continue = sampler->next_1d() < rr_prob;
 
             /* Differentiable variants of the renderer require the the russian
@@ -268,8 +490,14 @@ public:
 
             active = active_next && (!rr_active || rr_continue) &&
                      dr::neq(throughput_max, 0.f);
+
+            if (adrrs)
+                next_branch();
         }
 
+        if (recording)
+            guide_path.commit(m_guide.get(), true);
+
         return {
             /* spec  = */ dr::select(valid_ray, result, 0.f),
             /* valid = */ valid_ray
@@ -282,8 +510,11 @@ public:
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %u,\n"
-            "  rr_depth = %u\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %u,\n"
+            "  rr_mode = %s,\n"
+            "  guide = %s\n"
+            "]", m_max_depth, m_rr_depth, m_adrrs ? "adrrs" : "throughput",
+            m_guide ? string::indent(m_guide) : "none");
     }
 
     /// Compute a multiple importance sampling weight using the power heuristic
@@ -0,0 +1,903 @@
+#include <atomic>
+
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/sensor.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-sppm:
+
+Stochastic progressive photon mapping (:monosp:`sppm`)
+------------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1
+     corresponds to :math:`\infty`). This limits both the sensor subpaths and
+     the photon paths. (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the minimum photon path depth, after which the implementation
+     will start to use the *russian roulette* path termination criterion.
+     (Default: 5)
+
+ * - photon_count
+   - |int|
+   - Number of photons that are traced in every iteration. (Default: 250000)
+
+ * - initial_radius
+   - |float|
+   - Initial radius of the density estimation in world space units. The
+     default value of 0 selects a radius of 0.5% of the radius of the scene's
+     bounding sphere. (Default: 0)
+
+ * - alpha
+   - |float|
+   - Radius reduction parameter, which must lie in the interval
+     :math:`(0, 1)`. Smaller values shrink the radius faster. (Default: 0.7)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This plugin implements *stochastic progressive photon mapping* (SPPM) by
+Hachisuka and Jensen :cite:`Hachisuka2009Stochastic`. It handles scenes with
+caustics (e.g. light that is focused by glass or reflected by mirrors onto a
+diffuse surface) that are nearly impossible to render with unidirectional
+techniques like the :ref:`path tracer <integrator-path>` or the
+:ref:`particle tracer <integrator-ptracer>`.
+
+Each iteration of the algorithm traces one path per pixel from the sensor.
+Such a path follows specular (and glossy) reflection and refraction until it
+finds a diffuse surface, where it computes direct illumination using emitter
+sampling and creates a *visible point*. The iteration then traces a batch of
+photons from the emitters, which are stored in a hash grid, and every visible
+point gathers the photons within a per-pixel radius. The radius shrinks from
+one iteration to the next, and the statistics of each pixel (the number of
+photons found so far, the current radius, and the accumulated flux) are kept
+in the channels of an image block. The estimate thus converges to the
+correct solution as the number of iterations increases.
+
+The number of iterations equals the sample count of the sensor's sampler.
+The scalar variants trace photons and sensor paths on all cores and build the
+hash grid in parallel, while the JIT variants process each iteration as a
+small number of wavefronts.
+
+.. note:: This integrator does not handle participating media. In spectral
+   variants, photon and sensor subpaths are combined in RGB space, since they
+   generally sample different wavelengths.
+
+.. tabs::
+    .. code-tab::  xml
+        :name: sppm-integrator
+
+        <integrator type="sppm">
+            <integer name="photon_count" value="1000000"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'sppm',
+        'photon_count': 1000000
+
+ */
+
+template <typename Float, typename Spectrum>
+class SPPMIntegrator final : public Integrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Integrator, should_stop, aov_names, m_stop, m_timeout,
+                   m_render_timer, m_hide_emitters)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, ImageBlock, Emitter,
+                    EmitterPtr, BSDF, BSDFPtr)
+
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
+
+    /// Photons sorted by the hash grid cell they fall into
+    struct PhotonGrid {
+        ScalarFloat inv_cell_size = 0.f;
+        uint32_t hash_mask = 0;
+        uint32_t photon_count = 0;
+
+        /// Index of the first photon of each cell (plus a sentinel entry)
+        UInt32Storage cell_start;
+
+        /// Position, incident direction and RGB flux of the photons
+        FloatStorage position, direction, flux;
+    };
+
+    /// Photon deposits collected on the host before building the grid
+    struct PhotonList {
+        std::vector<ScalarFloat> position, direction, flux;
+    };
+
+    /// Number of photons traced with the same seed (scalar variants)
+    static constexpr uint32_t PhotonBlockSize = 4096;
+
+    /// State of a wavefront of photon paths
+    struct PhotonPath {
+        Ray3f ray;
+        Spectrum throughput;
+        Float eta;
+        UInt32 depth;
+        Mask active;
+
+        DRJIT_STRUCT(PhotonPath, ray, throughput, eta, depth, active)
+    };
+
+    /// Per-pixel statistics kept in the channels of an image block
+    enum StatsChannel : uint32_t {
+        DirectR = 0, DirectG, DirectB,
+        FluxR, FluxG, FluxB,
+        PhotonCount, RadiusSqr,
+        StatsChannelCount
+    };
+
+    SPPMIntegrator(const Properties &props) : Base(props) {
+        int max_depth = props.get<int>("max_depth", -1);
+        if (max_depth < 0 && max_depth != -1)
+            Throw("\"max_depth\" must be set to -1 (infinite) or a value >= 0");
+        m_max_depth = (uint32_t) max_depth; // This maps -1 to 2^32-1 bounces
+
+        int rr_depth = props.get<int>("rr_depth", 5);
+        if (rr_depth <= 0)
+            Throw("\"rr_depth\" must be set to a value greater than zero!");
+        m_rr_depth = (uint32_t) rr_depth;
+
+        int photon_count = props.get<int>("photon_count", 250000);
+        if (photon_count <= 0)
+            Throw("\"photon_count\" must be set to a value greater than zero!");
+        m_photon_count = (uint32_t) photon_count;
+
+        m_initial_radius = props.get<ScalarFloat>("initial_radius", 0.f);
+        if (m_initial_radius < 0.f)
+            Throw("\"initial_radius\" cannot be negative!");
+
+        m_alpha = props.get<ScalarFloat>("alpha", .7f);
+        if (!(m_alpha > 0.f && m_alpha < 1.f))
+            Throw("\"alpha\" must lie in the interval (0, 1)!");
+    }
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        Film *film = sensor->film();
+        ScalarVector2u crop_size = film->crop_size();
+        uint32_t pixel_count = dr::prod(crop_size);
+
+        if (unlikely(has_flag(film->flags(), FilmFlags::Special)))
+            Throw("SPPMIntegrator: films with special output formats are not "
+                  "supported!");
+
+        // Every iteration traces one sensor path per pixel
+        Sampler *sampler = sensor->sampler();
+        if (spp)
+            sampler->set_sample_count(spp);
+        uint32_t iterations = sampler->sample_count();
+
+        size_t n_channels = film->prepare(aov_names());
+
+        ScalarFloat radius = m_initial_radius;
+        if (radius == 0.f)
+            radius = scene->bbox().bounding_sphere().radius * 5e-3f;
+
+        /* Per-pixel statistics. A squared radius of zero marks pixels that
+           didn't find any photons yet and still use the initial radius. */
+        ref<ImageBlock> stats = new ImageBlock(
+            crop_size, film->crop_offset(), StatsChannelCount,
+            nullptr /* rfilter */, false /* border */, false /* normalize */,
+            false /* coalesce */, false /* warn_negative */,
+            false /* warn_invalid */);
+        stats->clear();
+
+        m_render_timer.reset();
+
+        if constexpr (dr::is_jit_v<Float>) {
+            dr::sync_thread(); // Separate from scene initialization (for timings)
+            sampler->set_samples_per_wavefront(1);
+        }
+
+        Log(Info, "Starting render job (%ux%u, %u iteration%s, %u photons per "
+                  "iteration)", crop_size.x(), crop_size.y(), iterations,
+            iterations == 1 ? "" : "s", m_photon_count);
+
+        ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+
+        uint32_t iteration = 0;
+        while (iteration < iterations && !should_stop()) {
+            // Distinct seeds for the photon and sensor passes of all iterations
+            uint32_t pass_seed = (seed * iterations + iteration) * 2;
+
+            // 1. Trace photons and sort them into a hash grid
+            ScalarFloat radius_max = max_radius(stats.get(), radius);
+            PhotonList photons = trace_photons(scene, sampler, pass_seed);
+            PhotonGrid grid = build_grid(photons, 2.f * radius_max);
+
+            // 2. Trace sensor paths, gather photons and update the statistics
+            FloatStorage &stats_data = stats->tensor().array();
+            for_each(sampler, pass_seed + 1, pixel_count,
+                     [&](const UInt32 &index, Sampler *sampler) {
+                         gather(scene, sensor, sampler, grid, stats_data,
+                                index, radius);
+                     });
+
+            if constexpr (dr::is_jit_v<Float>)
+                dr::eval(stats_data);
+
+            progress->update(++iteration / (ScalarFloat) iterations);
+        }
+
+        /* 3. Combine the statistics into the final estimate. Each pixel is
+              written directly, since the estimate is already filtered. */
+        ref<ImageBlock> block = new ImageBlock(
+            crop_size, film->crop_offset(), (uint32_t) n_channels,
+            nullptr /* rfilter */, false /* border */);
+        block->clear();
+        FloatStorage &block_data = block->tensor().array();
+
+        ScalarFloat direct_scale = 1.f / std::max(iteration, 1u),
+                    flux_scale   = direct_scale /
+                                 (m_photon_count * dr::Pi<ScalarFloat>);
+        const FloatStorage &stats_data = stats->tensor().array();
+
+        for_each(nullptr, 0, pixel_count,
+                 [&](const UInt32 &index, Sampler * /* sampler */) {
+            UInt32 offset = index * StatsChannelCount;
+            Float r2 = dr::gather<Float>(stats_data, offset + RadiusSqr);
+            r2 = dr::select(r2 > 0.f, r2, dr::sqr(radius));
+
+            // R, G, B, and potentially alpha and weight
+            UInt32 out = index * (uint32_t) n_channels;
+            for (uint32_t i = 0; i < 3; ++i) {
+                Float value =
+                    dr::gather<Float>(stats_data, offset + DirectR + i) * direct_scale +
+                    dr::gather<Float>(stats_data, offset + FluxR + i) * flux_scale / r2;
+                dr::scatter(block_data, value, out + i);
+            }
+            for (uint32_t i = 3; i < n_channels; ++i)
+                dr::scatter(block_data, Float(1.f), out + i);
+        });
+
+        film->put_block(block);
+
+        TensorXf result;
+        if (develop) {
+            result = film->develop();
+            dr::schedule(result);
+        } else {
+            film->schedule_storage();
+        }
+
+        if constexpr (dr::is_jit_v<Float>) {
+            if (evaluate) {
+                dr::eval();
+                dr::sync_thread();
+            }
+        }
+
+        if (!m_stop)
+            Log(Info, "Rendering finished. (took %s)",
+                util::time_string((float) m_render_timer.value(), true));
+
+        return result;
+    }
+
+    /**
+     * \brief Invoke \c func for the indices <tt>0, .., size - 1</tt>
+     *
+     * Scalar variants process the indices in parallel and pass a sampler that
+     * was seeded for each index. JIT variants invoke \c func once with a
+     * wavefront containing all indices.
+     */
+    template <typename Func>
+    void for_each(Sampler *sampler, uint32_t seed, uint32_t size,
+                  Func func) const {
+        if constexpr (dr::is_jit_v<Float>) {
+            if (sampler)
+                sampler->seed(seed, size);
+            func(dr::arange<UInt32>(size), sampler);
+            if (sampler)
+                sampler->schedule_state();
+        } else {
+            uint32_t n_threads = (uint32_t) Thread::thread_count(),
+                     grain_size = std::max(size / (4 * n_threads), 1u);
+
+            ThreadEnvironment env;
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, size, grain_size),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> local;
+                    if (sampler)
+                        local = sampler->clone();
+
+                    for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                        if (local)
+                            local->seed(sample_tea_32(seed, i).first);
+                        func(i, local.get());
+                    }
+                }
+            );
+        }
+    }
+
+    // =============================================================
+    //! @{ \name Photon tracing
+    // =============================================================
+
+    /// Convert a spectrum to linear RGB, being careful with polarization
+    Color3f to_rgb(const Spectrum &value, const Wavelength &wavelengths,
+                   Mask active) const {
+        UnpolarizedSpectrum spec_u = unpolarized_spectrum(value);
+        if constexpr (is_spectral_v<Spectrum>)
+            return spectrum_to_srgb(spec_u, wavelengths, active);
+        else if constexpr (is_monochromatic_v<Spectrum>)
+            return spec_u.x();
+        else
+            return spec_u;
+    }
+
+    /// Sample the initial segment of photon paths
+    PhotonPath emit_photon(const Scene *scene, Sampler *sampler,
+                           Mask active) const {
+        Float time = 0.f;
+        Float wavelength_sample = sampler->next_1d(active);
+        Point2f direction_sample = sampler->next_2d(active),
+                position_sample  = sampler->next_2d(active);
+
+        auto [ray, weight, emitter] = scene->sample_emitter_ray(
+            time, wavelength_sample, direction_sample, position_sample, active);
+        DRJIT_MARK_USED(emitter);
+
+        return PhotonPath{ ray, weight, Float(1.f), UInt32(0),
+                           active && dr::any(dr::neq(unpolarized_spectrum(weight), 0.f)) };
+    }
+
+    /**
+     * \brief Advance photon paths by one bounce
+     *
+     * Returns a mask of the paths that deposit a photon at the current
+     * vertex, along with its position, incident direction and RGB flux. The
+     * first vertex never receives a deposit, since sensor paths account for
+     * direct illumination using emitter sampling.
+     */
+    std::tuple<Mask, Point3f, Vector3f, Color3f>
+    scatter_photon(const Scene *scene, Sampler *sampler,
+                   PhotonPath &path) const {
+        Mask active = path.active;
+        Ray3f ray = path.ray;
+
+        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        active &= si.is_valid();
+
+        if (dr::none_or<false>(active)) {
+            path.active = false;
+            return { false, 0.f, 0.f, 0.f }; // early exit for scalar mode
+        }
+
+        BSDFPtr bsdf = si.bsdf();
+        Mask deposit = active && path.depth > 0u &&
+                       has_flag(bsdf->flags(), BSDFFlags::Smooth);
+        Color3f flux = to_rgb(path.throughput, ray.wavelengths, deposit);
+
+        // Sample BSDF * cos(theta) using the adjoint transport mode
+        BSDFContext ctx(TransportMode::Importance);
+        auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                           sampler->next_2d(active), active);
+
+        // Prevent light leaks due to shading normals
+        Float wi_dot_geo_n = dr::dot(si.n, -ray.d),
+              wo_dot_geo_n = dr::dot(si.n, si.to_world(bs.wo));
+        active &= (wi_dot_geo_n * Frame3f::cos_theta(si.wi) > 0.f) &&
+                  (wo_dot_geo_n * Frame3f::cos_theta(bs.wo) > 0.f);
+
+        // Adjoint BSDF for shading normals -- [Veach, p. 155]
+        Float correction = dr::abs((Frame3f::cos_theta(si.wi) * wo_dot_geo_n) /
+                                   (Frame3f::cos_theta(bs.wo) * wi_dot_geo_n));
+
+        bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+        dr::masked(path.throughput, active) *= bsdf_val * correction;
+        dr::masked(path.eta, active) *= bs.eta;
+        dr::masked(path.depth, active) += 1u;
+        dr::masked(path.ray, active) = si.spawn_ray(si.to_world(bs.wo));
+
+        active &= path.depth + 1u < m_max_depth &&
+                  dr::any(dr::neq(unpolarized_spectrum(path.throughput), 0.f));
+
+        // Russian roulette
+        Mask use_rr = active && path.depth >= m_rr_depth;
+        Float q = dr::minimum(
+            dr::max(unpolarized_spectrum(path.throughput)) * dr::sqr(path.eta), .95f);
+        active &= !use_rr || sampler->next_1d(use_rr) < q;
+        dr::masked(path.throughput, use_rr) *= dr::rcp(q);
+
+        path.active = active;
+        return { deposit, si.p, -ray.d, flux };
+    }
+
+    /// Trace a batch of photons and return the deposits
+    PhotonList trace_photons(const Scene *scene, Sampler *sampler,
+                             uint32_t seed) const {
+        PhotonList result;
+        if (unlikely(scene->emitters().empty()))
+            return result;
+
+        auto append = [](PhotonList &list, const ScalarPoint3f &p,
+                         const ScalarVector3f &d, const ScalarColor3f &flux) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                list.position.push_back(p[i]);
+                list.direction.push_back(d[i]);
+                list.flux.push_back(flux[i]);
+            }
+        };
+
+        if constexpr (dr::is_jit_v<Float>) {
+            /* Trace one wavefront per bounce. The deposits of each bounce are
+               compacted on the host, which also determines when to stop. */
+            sampler->seed(seed, m_photon_count);
+            PhotonPath path = emit_photon(scene, sampler, true);
+
+            while (true) {
+                auto [deposit, p, d, flux] = scatter_photon(scene, sampler, path);
+                sampler->schedule_state();
+                dr::eval(path, deposit, p, d, flux);
+
+                auto deposit_h = dr::migrate(deposit, AllocType::Host);
+                auto active_h  = dr::migrate(path.active, AllocType::Host);
+                auto p_h = dr::migrate(p, AllocType::Host);
+                auto d_h = dr::migrate(d, AllocType::Host);
+                auto flux_h = dr::migrate(flux, AllocType::Host);
+                dr::sync_thread();
+
+                const bool *deposit_ptr = deposit_h.data(),
+                           *active_ptr  = active_h.data();
+                bool any_active = false;
+
+                for (uint32_t i = 0; i < m_photon_count; ++i) {
+                    any_active |= active_ptr[i];
+                    if (!deposit_ptr[i])
+                        continue;
+                    append(result,
+                           ScalarPoint3f(p_h.x().data()[i], p_h.y().data()[i],
+                                         p_h.z().data()[i]),
+                           ScalarVector3f(d_h.x().data()[i], d_h.y().data()[i],
+                                          d_h.z().data()[i]),
+                           ScalarColor3f(flux_h.x().data()[i], flux_h.y().data()[i],
+                                         flux_h.z().data()[i]));
+                }
+
+                if (!any_active)
+                    break;
+            }
+        } else {
+            /* Photons are traced in blocks of a fixed size, each with its own
+               seed, and the blocks' photons are concatenated in order. The
+               photon set thus does not depend on the number of threads. */
+            uint32_t block_count =
+                (m_photon_count + PhotonBlockSize - 1) / PhotonBlockSize;
+            std::vector<PhotonList> lists(block_count);
+
+            ThreadEnvironment env;
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, block_count, 1),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> local = sampler->clone();
+
+                    for (uint32_t block = range.begin(); block != range.end(); ++block) {
+                        local->seed(sample_tea_32(seed, block).first);
+
+                        PhotonList &list = lists[block];
+                        uint32_t start = block * PhotonBlockSize,
+                                 end   = std::min(start + PhotonBlockSize,
+                                                  m_photon_count);
+                        for (uint32_t i = start; i != end; ++i) {
+                            PhotonPath path = emit_photon(scene, local, true);
+                            while (path.active) {
+                                auto [deposit, p, d, flux] =
+                                    scatter_photon(scene, local, path);
+                                if (deposit)
+                                    append(list, p, d, flux);
+                            }
+                            local->advance();
+                        }
+                    }
+                }
+            );
+
+            for (PhotonList &list : lists) {
+                result.position.insert(result.position.end(),
+                                       list.position.begin(), list.position.end());
+                result.direction.insert(result.direction.end(),
+                                        list.direction.begin(), list.direction.end());
+                result.flux.insert(result.flux.end(),
+                                   list.flux.begin(), list.flux.end());
+            }
+        }
+
+        return result;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Hash grid
+    // =============================================================
+
+    /// Hash the grid cell containing the point \c p
+    template <typename Point3>
+    static auto cell_hash(const Point3 &p, ScalarFloat inv_cell_size,
+                          uint32_t hash_mask) {
+        using Value  = dr::value_t<Point3>;
+        using UInt   = dr::uint32_array_t<Value>;
+        using Point3i_ = dr::Array<dr::int32_array_t<Value>, 3>;
+
+        Point3i_ cell = dr::floor2int<Point3i_>(p * inv_cell_size);
+        return cell_hash(UInt(cell.x()), UInt(cell.y()), UInt(cell.z()), hash_mask);
+    }
+
+    /// Hash the grid cell with integer coordinates <tt>(x, y, z)</tt>
+    template <typename UInt>
+    static UInt cell_hash(const UInt &x, const UInt &y, const UInt &z,
+                          uint32_t hash_mask) {
+        return ((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u)) & hash_mask;
+    }
+
+    /**
+     * \brief Sort the photons into a hash grid with the given cell size
+     *
+     * The grid is built on the host using a counting sort, which stores the
+     * photons of each cell contiguously and in their original order.
+     */
+    PhotonGrid build_grid(const PhotonList &photons,
+                          ScalarFloat cell_size) const {
+        PhotonGrid grid;
+        uint32_t n = (uint32_t) (photons.position.size() / 3);
+        uint32_t table_size = math::round_to_power_of_two(std::max(n, 1u));
+
+        grid.inv_cell_size = 1.f / cell_size;
+        grid.hash_mask = table_size - 1;
+        grid.photon_count = n;
+
+        std::unique_ptr<uint32_t[]> cell(new uint32_t[std::max(n, 1u)]);
+        std::unique_ptr<std::atomic<uint32_t>[]> counter(
+            new std::atomic<uint32_t>[table_size]);
+        for (uint32_t i = 0; i < table_size; ++i)
+            counter[i].store(0, std::memory_order_relaxed);
+
+        uint32_t grain_size = std::max(n / (4 * (uint32_t) Thread::thread_count()),
+                                       1024u);
+
+        // Count the photons per cell
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, n, grain_size),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarPoint3f p = dr::load<ScalarPoint3f>(
+                        photons.position.data() + 3 * i);
+                    cell[i] = cell_hash(p, grid.inv_cell_size, grid.hash_mask);
+                    counter[cell[i]].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        );
+
+        // Exclusive prefix sum, the counters then serve as insertion cursors
+        std::unique_ptr<uint32_t[]> cell_start(new uint32_t[table_size + 1]);
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < table_size; ++i) {
+            cell_start[i] = sum;
+            sum += counter[i].load(std::memory_order_relaxed);
+            counter[i].store(cell_start[i], std::memory_order_relaxed);
+        }
+        cell_start[table_size] = sum;
+
+        std::unique_ptr<ScalarFloat[]> position(new ScalarFloat[3 * n + 1]),
+                                       direction(new ScalarFloat[3 * n + 1]),
+                                       flux(new ScalarFloat[3 * n + 1]);
+
+        /* Scatter the photons sequentially, so that the photons of each cell
+           (and thus the order of their contributions) are deterministic */
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t j = counter[cell[i]].fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t k = 0; k < 3; ++k) {
+                position[3 * j + k]  = photons.position[3 * i + k];
+                direction[3 * j + k] = photons.direction[3 * i + k];
+                flux[3 * j + k]      = photons.flux[3 * i + k];
+            }
+        }
+
+        grid.cell_start = dr::load<UInt32Storage>(cell_start.get(), table_size + 1);
+        grid.position   = dr::load<FloatStorage>(position.get(), 3 * n);
+        grid.direction  = dr::load<FloatStorage>(direction.get(), 3 * n);
+        grid.flux       = dr::load<FloatStorage>(flux.get(), 3 * n);
+
+        return grid;
+    }
+
+    /// Return the largest density estimation radius of all pixels
+    ScalarFloat max_radius(ImageBlock *stats, ScalarFloat initial_radius) const {
+        FloatStorage data = stats->tensor().array();
+        if constexpr (dr::is_jit_v<Float>) {
+            data = dr::migrate(data, AllocType::Host);
+            dr::sync_thread();
+        }
+
+        const ScalarFloat *ptr = data.data();
+        ScalarFloat r2_max = 0.f;
+        for (size_t i = RadiusSqr; i < data.size(); i += StatsChannelCount) {
+            if (ptr[i] == 0.f)
+                return initial_radius;
+            r2_max = std::max(r2_max, ptr[i]);
+        }
+
+        return dr::sqrt(r2_max);
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Sensor paths and density estimation
+    // =============================================================
+
+    /**
+     * \brief Trace sensor paths for the given pixels, gather the nearby
+     * photons and update the per-pixel statistics
+     */
+    void gather(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                const PhotonGrid &grid, FloatStorage &stats,
+                const UInt32 &index, ScalarFloat initial_radius) const {
+        const Film *film = sensor->film();
+        ScalarVector2u crop_size = film->crop_size();
+        ScalarVector2f scale = 1.f / ScalarVector2f(crop_size);
+
+        // ----------------------- Sample the sensor ray -----------------------
+
+        Point2u pixel;
+        pixel.y() = index / crop_size.x();
+        pixel.x() = index - pixel.y() * crop_size.x();
+
+        Vector2f adjusted_pos = (Point2f(pixel) + sampler->next_2d()) * scale;
+
+        Point2f aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d();
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Float wavelength_sample = 0.f;
+        if constexpr (is_spectral_v<Spectrum>)
+            wavelength_sample = sampler->next_1d();
+
+        auto [ray_, ray_weight] = sensor->sample_ray_differential(
+            time, wavelength_sample, adjusted_pos, aperture_sample);
+        Ray3f ray = Ray3f(ray_);
+
+        // ------------------ Find the visible point of the path ------------------
+
+        Spectrum throughput = ray_weight, direct = 0.f;
+        UInt32 depth = 0;
+        Mask active = m_max_depth > 0, found = false;
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        BSDFContext ctx;
+
+        dr::Loop<Mask> loop("SPPM sensor path", active, depth, ray, throughput,
+                            direct, found, si, sampler);
+
+        while (loop(active)) {
+            si = scene->ray_intersect(ray, +RayFlags::All, dr::eq(depth, 0u));
+
+            /* All vertices before the visible point are specular (or glossy),
+               hence emission is only handled here by BSDF sampling */
+            Mask visible = dr::neq(depth, 0u) || !m_hide_emitters;
+            if (dr::any_or<true>(dr::neq(si.emitter(scene), nullptr) && visible)) {
+                Spectrum emitted = si.emitter(scene)->eval(si, visible);
+                direct[visible] = direct + throughput * emitted;
+            }
+
+            active &= si.is_valid();
+            if (dr::none_or<false>(active))
+                break; // early exit for scalar mode
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            UInt32 flags = bsdf->flags(active);
+
+            // Create the visible point on diffuse (or last glossy) vertices
+            Mask is_visible_point =
+                has_flag(flags, BSDFFlags::Diffuse) ||
+                (has_flag(flags, BSDFFlags::Glossy) && depth + 1u >= m_max_depth);
+            found |= active && is_visible_point;
+            active &= !is_visible_point;
+
+            auto [bs, bsdf_weight] = bsdf->sample(
+                ctx, si, sampler->next_1d(active), sampler->next_2d(active), active);
+            bsdf_weight = si.to_world_mueller(bsdf_weight, -bs.wo, si.wi);
+
+            throughput[active] *= bsdf_weight;
+            dr::masked(ray, active) = si.spawn_ray(si.to_world(bs.wo));
+            dr::masked(depth, active) += 1u;
+
+            active &= depth < m_max_depth &&
+                      dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
+        }
+
+        BSDFPtr bsdf = dr::zeros<BSDFPtr>();
+        if (dr::any_or<true>(found))
+            bsdf = si.bsdf();
+        found &= dr::neq(bsdf, nullptr);
+
+        // ---------------- Direct illumination at the visible point ----------------
+
+        Mask active_em = found && depth + 1u < m_max_depth;
+        if (dr::any_or<true>(active_em)) {
+            auto [ds, em_weight] = scene->sample_emitter_direction(
+                si, sampler->next_2d(active_em), true, active_em);
+            active_em &= dr::neq(ds.pdf, 0.f);
+
+            Vector3f wo = si.to_local(ds.d);
+            Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_em);
+            bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+            direct[active_em] = direct + throughput * bsdf_val * em_weight;
+        }
+
+        // -------------------------- Photon gathering --------------------------
+
+        UInt32 offset = index * StatsChannelCount;
+        Float r2 = dr::gather<Float>(stats, offset + RadiusSqr);
+        r2 = dr::select(r2 > 0.f, r2, dr::sqr(initial_radius));
+
+        Color3f phi = 0.f;
+        Float m = 0.f;
+
+        if (grid.photon_count > 0 && dr::any_or<true>(found)) {
+            /* The search radius is at most half of the cell size, hence the
+               2x2x2 cells nearest to the visible point contain all photons */
+            Point3i base = dr::floor2int<Point3i>(si.p * grid.inv_cell_size - .5f);
+
+            auto cell_range = [&](const UInt32 &cell, Mask active_c) {
+                UInt32 h = cell_hash(UInt32(base.x()) + (cell & 1u),
+                                     UInt32(base.y()) + ((cell >> 1) & 1u),
+                                     UInt32(base.z()) + (cell >> 2),
+                                     grid.hash_mask);
+
+                // Skip hash table entries already visited by a previous cell
+                for (uint32_t j = 0; j < 7; ++j) {
+                    UInt32 h_j = cell_hash(UInt32(base.x()) + (j & 1u),
+                                           UInt32(base.y()) + ((j >> 1) & 1u),
+                                           UInt32(base.z()) + (j >> 2),
+                                           grid.hash_mask);
+                    active_c &= !(j < cell && dr::eq(h, h_j));
+                }
+
+                UInt32 start = dr::gather<UInt32>(grid.cell_start, h, active_c),
+                       end   = dr::gather<UInt32>(grid.cell_start, h + 1u, active_c);
+                return std::make_pair(start, dr::select(active_c, end, start));
+            };
+
+            UInt32 cell = 0, cursor, end;
+            std::tie(cursor, end) = cell_range(cell, found);
+            Mask active_g = found;
+
+            dr::Loop<Mask> loop_g("SPPM photon gathering", active_g, cell,
+                                  cursor, end, phi, m);
+
+            while (loop_g(active_g)) {
+                Mask in_cell = cursor < end;
+
+                Point3f p   = dr::gather<Point3f>(grid.position, cursor, in_cell);
+                Mask inside = in_cell && dr::squared_norm(p - si.p) < r2;
+
+                if (dr::any_or<true>(inside)) {
+                    Vector3f d = dr::gather<Vector3f>(grid.direction, cursor, inside);
+                    Color3f flux = dr::gather<Color3f>(grid.flux, cursor, inside);
+
+                    // Photon flux is incident flux, hence remove the cosine
+                    Vector3f wo = si.to_local(d);
+                    Float cos_theta = dr::abs(Frame3f::cos_theta(wo));
+                    inside &= cos_theta > 1e-4f;
+
+                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo, inside);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    Color3f weight = to_rgb(throughput * bsdf_val, si.wavelengths,
+                                            inside) / cos_theta;
+
+                    phi[inside] = phi + weight * flux;
+                    m[inside] = m + 1.f;
+                }
+
+                dr::masked(cursor, in_cell) += 1u;
+
+                // Continue with the next cell once this one is exhausted
+                Mask next = !in_cell;
+                dr::masked(cell, next) += 1u;
+                next &= cell < 8u;
+                if (dr::any_or<true>(next)) {
+                    auto [cursor_n, end_n] = cell_range(cell, next);
+                    dr::masked(cursor, next) = cursor_n;
+                    dr::masked(end, next) = end_n;
+                }
+
+                active_g = cell < 8u;
+            }
+        }
+
+        // -------------------- Update the pixel statistics --------------------
+
+        // Each pixel is owned by a single lane (or thread)
+        Color3f direct_rgb = to_rgb(direct, si.wavelengths, true);
+        for (uint32_t i = 0; i < 3; ++i) {
+            Float sum = dr::gather<Float>(stats, offset + DirectR + i);
+            dr::scatter(stats, sum + direct_rgb[i], offset + DirectR + i);
+        }
+
+        // Shrink the radius based on the number of photons that were found
+        Mask update = m > 0.f;
+        Float n = dr::gather<Float>(stats, offset + PhotonCount, update),
+              n_new = n + m_alpha * m,
+              r2_new = r2 * n_new / (n + m);
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            Float tau = dr::gather<Float>(stats, offset + FluxR + i, update);
+            dr::scatter(stats, (tau + phi[i]) * (r2_new / r2),
+                        offset + FluxR + i, update);
+        }
+
+        dr::scatter(stats, n_new, offset + PhotonCount, update);
+        dr::scatter(stats, r2_new, offset + RadiusSqr, update);
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("SPPMIntegrator[\n"
+                           "  max_depth = %u,\n"
+                           "  rr_depth = %u,\n"
+                           "  photon_count = %u,\n"
+                           "  initial_radius = %f,\n"
+                           "  alpha = %f\n"
+                           "]",
+                           m_max_depth, m_rr_depth, m_photon_count,
+                           m_initial_radius, m_alpha);
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    uint32_t m_max_depth;
+    uint32_t m_rr_depth;
+    uint32_t m_photon_count;
+    ScalarFloat m_initial_radius;
+    ScalarFloat m_alpha;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SPPMIntegrator, Integrator)
+MI_EXPORT_PLUGIN(SPPMIntegrator, "Stochastic progressive photon mapping integrator");
+NAMESPACE_END(mitsuba)
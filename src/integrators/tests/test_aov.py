@@ -0,0 +1,25 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+@pytest.mark.parametrize('integrator_type', ['path', 'direct'])
+def test01_nested_integrator_matches(variants_all_backends_once, integrator_type):
+    # The nested integrator reuses the primary intersection of the AOV integrator
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = 16
+    scene_dict['sensor']['film']['height'] = 16
+    scene_dict['integrator'] = {
+        'type': 'aov',
+        'aovs': 'dd.y:depth,nn:sh_normal',
+        'my_image': { 'type': integrator_type },
+    }
+    scene = mi.load_dict(scene_dict)
+    image_aov = mi.render(scene, spp=4)
+
+    integrator = mi.load_dict({ 'type': integrator_type })
+    image = mi.render(scene, integrator=integrator, spp=4)
+
+    # Channels: R, G, B, A, dd.y, nn.X, nn.Y, nn.Z, my_image.{R,G,B,A}
+    assert image_aov.shape[2] == 12
+    assert dr.allclose(image_aov[:, :, 8:11], image[:, :, 0:3], rtol=1e-4, atol=1e-5)
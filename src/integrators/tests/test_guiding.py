@@ -0,0 +1,150 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def render_cornell_box(integrator, spp, seed=0):
+    scene_dict = mi.cornell_box()
+    scene_dict['integrator'] = integrator
+    scene_dict['sensor']['film']['width'] = 16
+    scene_dict['sensor']['film']['height'] = 16
+    scene = mi.load_dict(scene_dict)
+    return scene.integrator().render(scene, seed=seed, spp=spp)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('integrator_type', ['path', 'volpath'])
+def test01_guided_render_is_unbiased(variants_all_backends_once, integrator_type):
+    integrator = {
+        'type': integrator_type,
+        'max_depth': 6,
+        'guiding': True,
+        'guiding_spatial_threshold': 100.0,
+    }
+
+    image = render_cornell_box(integrator, spp=256)
+    ref = render_cornell_box({ 'type': integrator_type, 'max_depth': 6 }, spp=256, seed=1)
+
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+def test02_sdtree_refinement(variants_all_backends_once):
+    integrator = mi.load_dict({
+        'type': 'path',
+        'max_depth': 6,
+        'guiding': True,
+        'guiding_budget': 0.5,
+        'guiding_spatial_threshold': 10.0,
+    })
+
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = 8
+    scene_dict['sensor']['film']['height'] = 8
+    scene = mi.load_dict(scene_dict)
+
+    # Training passes (1 + 2 + 4 + 8 spp) refine the spatial structure
+    integrator.render(scene, spp=32)
+    assert 'iteration = 4' in str(integrator)
+    assert 'spatial_nodes = 1,' not in str(integrator)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('integrator_type', ['path', 'volpath'])
+def test03_adrrs_is_unbiased(variants_all_backends_once, integrator_type):
+    integrator = {
+        'type': integrator_type,
+        'max_depth': 8,
+        'rr_mode': 'adrrs',
+        'rr_depth': 1,
+        'guiding_spatial_threshold': 100.0,
+    }
+
+    image = render_cornell_box(integrator, spp=256)
+    ref = render_cornell_box({ 'type': integrator_type, 'max_depth': 8 }, spp=256, seed=1)
+
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+def test04_invalid_rr_mode(variants_all_backends_once):
+    with pytest.raises(RuntimeError, match='rr_mode'):
+        mi.load_dict({ 'type': 'path', 'rr_mode': 'foo' })
+
+
+@pytest.mark.parametrize('rr_mode', ['throughput', 'adrrs'])
+def test05_sample_budget(variants_all_backends_once, rr_mode):
+    integrator = mi.load_dict({
+        'type': 'path',
+        'max_depth': 4,
+        'guiding': rr_mode == 'throughput',
+        'rr_mode': rr_mode,
+        'guiding_budget': 0.5,
+    })
+
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = 8
+    scene_dict['sensor']['film']['height'] = 8
+    scene_dict['sensor']['film']['rfilter'] = { 'type': 'box' }
+    scene = mi.load_dict(scene_dict)
+    sensor = scene.sensors()[0]
+
+    # Training passes (1 + 2 + 4 + 8 spp) are part of the sample count, the
+    # final pass renders the remaining 17 samples per pixel
+    integrator.render(scene, spp=32, develop=False)
+    weights = mi.TensorXf(sensor.film().bitmap(raw=True))[:, :, -1]
+    assert dr.allclose(weights.array, 17)
+    assert sensor.sampler().sample_count() == 32
+
+
+@pytest.mark.slow
+def test06_guided_rough_dielectric(variants_all_backends_once):
+    # Refraction through rough dielectrics must keep its radiance scaling
+    def render(guiding, seed):
+        scene_dict = mi.cornell_box()
+        scene_dict['integrator'] = {
+            'type': 'path',
+            'max_depth': 8,
+            'guiding': guiding,
+            'guiding_spatial_threshold': 100.0,
+        }
+        scene_dict['sensor']['film']['width'] = 16
+        scene_dict['sensor']['film']['height'] = 16
+        scene_dict['sphere'] = {
+            'type': 'sphere',
+            'radius': 0.4,
+            'bsdf': { 'type': 'roughdielectric', 'alpha': 0.3, 'int_ior': 1.5 },
+        }
+        scene = mi.load_dict(scene_dict)
+        return scene.integrator().render(scene, seed=seed, spp=256)
+
+    image = render(True, 0)
+    ref = render(False, 1)
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+@pytest.mark.parametrize('integrator_type', ['path', 'volpath'])
+def test07_adrrs_zero_estimate(variants_all_backends_once, integrator_type):
+    # Inside a closed white sphere without emitters, the pixel estimate is zero
+    # and ADRRS makes no decision. Regular roulette must still terminate the
+    # paths, whose throughput never decreases.
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {
+            'type': integrator_type,
+            'max_depth': -1,
+            'rr_depth': 1,
+            'rr_mode': 'adrrs',
+        },
+        'sensor': {
+            'type': 'perspective',
+            'film': { 'type': 'hdrfilm', 'width': 4, 'height': 4 },
+        },
+        'shape': {
+            'type': 'sphere',
+            'radius': 10,
+            'flip_normals': True,
+            'bsdf': { 'type': 'diffuse', 'reflectance': { 'type': 'rgb', 'value': 1.0 } },
+        },
+    })
+
+    image = mi.render(scene, spp=16)
+    assert dr.all(dr.eq(image.array, 0))
@@ -0,0 +1,49 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def render_cornell_box(integrator, spp, seed=0):
+    scene_dict = mi.cornell_box()
+    scene_dict['integrator'] = integrator
+    scene_dict['sensor']['film']['width'] = 16
+    scene_dict['sensor']['film']['height'] = 16
+    scene = mi.load_dict(scene_dict)
+    return scene.integrator().render(scene, seed=seed, spp=spp)
+
+
+def test01_construct(variants_all_backends_once):
+    integrator = mi.load_dict({ 'type': 'sppm', 'photon_count': 1000 })
+    assert 'photon_count = 1000' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='alpha'):
+        mi.load_dict({ 'type': 'sppm', 'alpha': 1.5 })
+
+    with pytest.raises(RuntimeError, match='photon_count'):
+        mi.load_dict({ 'type': 'sppm', 'photon_count': 0 })
+
+
+def test02_direct_illumination(variants_all_backends_once):
+    # Photons only account for indirect illumination
+    image = render_cornell_box({ 'type': 'sppm', 'max_depth': 2,
+                                 'photon_count': 1000 }, spp=64)
+    ref = render_cornell_box({ 'type': 'path', 'max_depth': 2 }, spp=64, seed=1)
+
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+@pytest.mark.slow
+def test03_global_illumination(variants_all_backends_once):
+    image = render_cornell_box({ 'type': 'sppm', 'max_depth': 6,
+                                 'photon_count': 100000 }, spp=32)
+    ref = render_cornell_box({ 'type': 'path', 'max_depth': 6 }, spp=256, seed=1)
+
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+def test04_reproducible(variant_scalar_rgb):
+    # The photons must not depend on how the work is split across threads
+    integrator = { 'type': 'sppm', 'max_depth': 4, 'photon_count': 10007 }
+    images = [render_cornell_box(integrator, spp=4) for _ in range(3)]
+    for image in images[1:]:
+        assert dr.all(dr.eq(image.array, images[0].array))
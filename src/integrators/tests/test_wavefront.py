@@ -0,0 +1,59 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def render_cornell_box(integrator, spp, seed=0):
+    scene_dict = mi.cornell_box()
+    scene_dict['integrator'] = integrator
+    scene_dict['sensor']['film']['width'] = 16
+    scene_dict['sensor']['film']['height'] = 16
+    scene = mi.load_dict(scene_dict)
+    return scene.integrator().render(scene, seed=seed, spp=spp)
+
+
+@pytest.mark.parametrize('max_wavefront_size', [256 * 16, 256 * 2, 100])
+def test01_wavefront_limit(variants_vec_rgb, max_wavefront_size):
+    # Limits below the film size additionally split the image into chunks
+    image = render_cornell_box({
+        'type': 'path',
+        'max_wavefront_size': max_wavefront_size
+    }, spp=64)
+    ref = render_cornell_box({ 'type': 'path' }, spp=64, seed=1)
+
+    assert dr.shape(image) == dr.shape(ref)
+    assert dr.all(dr.isfinite(image.array))
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=5e-2)
+
+
+def test02_explicit_samples_per_pass(variants_vec_rgb):
+    # Samples per pass specified by the user are kept, the image is chunked
+    image = render_cornell_box({
+        'type': 'path',
+        'samples_per_pass': 8,
+        'max_wavefront_size': 8 * 100
+    }, spp=16)
+    ref = render_cornell_box({ 'type': 'path' }, spp=16, seed=1)
+    assert dr.allclose(dr.mean(image.array), dr.mean(ref.array), rtol=1e-1)
+
+    with pytest.raises(RuntimeError, match='samples per pass'):
+        render_cornell_box({
+            'type': 'path',
+            'samples_per_pass': 16,
+            'max_wavefront_size': 8
+        }, spp=16)
+
+
+@pytest.mark.parametrize('max_wavefront_size', [0, 100])
+def test03_record_passes(variants_vec_rgb, max_wavefront_size):
+    # Recorded passes consume the same random numbers as separate passes
+    integrator = {
+        'type': 'path',
+        'samples_per_pass': 2,
+        'max_wavefront_size': max_wavefront_size
+    }
+    ref = render_cornell_box(integrator, spp=8)
+
+    integrator['record_passes'] = True
+    image = render_cornell_box(integrator, spp=8)
+    assert dr.allclose(image, ref, rtol=1e-4, atol=1e-5)
@@ -1,6 +1,7 @@
 #include <random>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/integrator.h>
@@ -35,6 +36,20 @@ Volumetric path tracer (:monosp:`volpath`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - guiding
+   - |bool|
+   - Use path guiding for surface interactions, see the :ref:`path tracer
+     <integrator-path>` for details and the related ``guiding_*``
+     parameters. (Default: no, i.e. |false|)
+
+ * - rr_mode
+   - |string|
+   - Path termination strategy, either ``throughput`` or ``adrrs``. The latter
+     applies adjoint-driven Russian roulette at surface interactions, see the
+     :ref:`path tracer <integrator-path>` for details and the related
+     ``adrrs_*`` parameters. Unlike the path tracer, this integrator does not
+     split paths. (Default: ``throughput``)
+
 This plugin provides a volumetric path tracer that can be used to compute approximate solutions
 of the radiative transfer equation. Its implementation makes use of multiple importance sampling
 to combine BSDF and phase function sampling with direct illumination sampling strategies. On
@@ -72,11 +87,14 @@ template <typename Float, typename Spectrum>
 class VolumetricPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 
 public:
-    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                   m_guide, m_adrrs, adrrs_factors)
     MI_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
-                     Medium, MediumPtr, PhaseFunctionContext)
+                     Medium, MediumPtr, PhaseFunctionContext, SDTree)
+    using GuidingPath = mitsuba::GuidingPath<Float, Spectrum>;
 
     VolumetricPathIntegrator(const Properties &props) : Base(props) {
+        this->init_guiding(props);
     }
 
     MI_INLINE
@@ -126,14 +144,31 @@ public:
         Interaction3f last_scatter_event = dr::zeros<Interaction3f>();
         Float last_scatter_direction_pdf = 1.f;
 
+        // Surface vertices whose incident radiance is recorded for path guiding
+        bool recording = m_guide && m_guide->training();
+        GuidingPath guide_path = dr::zeros<GuidingPath>();
+
+        /* Adjoint-driven Russian roulette at surface vertices, which replaces
+           the throughput-based roulette of the following iteration where it
+           applied a survival factor */
+        bool adrrs = m_adrrs && m_guide->ready() && !m_guide->training();
+        Float pixel_estimate = 0.f;
+        Mask adrrs_vertex = false;
+
         /* Set up a Dr.Jit loop (optimizes away to a normal loop in scalar mode,
            generates wavefront or megakernel renderer based on configuration).
            Register everything that changes as part of the loop here */
-        dr::Loop<Mask> loop("Volpath integrator",
-                            /* loop state: */ active, depth, ray, throughput,
-                            result, si, mei, medium, eta, last_scatter_event,
-                            last_scatter_direction_pdf, needs_intersection,
-                            specular_chain, valid_ray, sampler);
+        dr::Loop<Mask> loop("Volpath integrator");
+        loop.put(/* loop state: */ active, depth, ray, throughput, result, si,
+                 mei, medium, eta, last_scatter_event,
+                 last_scatter_direction_pdf, needs_intersection,
+                 specular_chain, valid_ray);
+        sampler->loop_put(loop);
+        if (recording)
+            loop.put(guide_path);
+        if (adrrs)
+            loop.put(pixel_estimate, adrrs_vertex);
+        loop.init();
 
         while (loop(active)) {
             // ----------------- Handle termination of paths ------------------
@@ -142,9 +177,10 @@ public:
             // probability to avoid  getting stuck (e.g. due to total internal reflection)
             active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
             Float q = dr::minimum(dr::max(unpolarized_spectrum(throughput)) * dr::sqr(eta), .95f);
-            Mask perform_rr = (depth > (uint32_t) m_rr_depth);
+            Mask perform_rr = (depth > (uint32_t) m_rr_depth) && !adrrs_vertex;
             active &= sampler->next_1d(active) < q || !perform_rr;
             dr::masked(throughput, perform_rr) *= dr::rcp(dr::detach(q));
+            adrrs_vertex = false;
 
             active &= depth < (uint32_t) m_max_depth;
             if (dr::none_or<false>(active))
@@ -227,8 +263,11 @@ public:
                 if (dr::any_or<true>(active_e)) {
                     auto [emitted, ds] = sample_emitter(mei, scene, sampler, medium, channel, active_e);
                     Float phase_val = phase->eval(phase_ctx, mei, ds.d, active_e);
-                    dr::masked(result, active_e) += throughput * phase_val * emitted *
-                                                    mis_weight(ds.pdf, dr::select(ds.delta, 0.f, phase_val));
+                    Spectrum contrib = throughput * phase_val * emitted *
+                                       mis_weight(ds.pdf, dr::select(ds.delta, 0.f, phase_val));
+                    dr::masked(result, active_e) += contrib;
+                    if (recording)
+                        guide_path.add_radiance(contrib, active_e);
                 }
 
                 // ------------------ Phase function sampling -----------------
@@ -268,6 +307,8 @@ public:
                     Spectrum contrib = dr::select(count_direct, throughput * emitted,
                                                   throughput * mis_weight(last_scatter_direction_pdf, emitter_pdf) * emitted);
                     dr::masked(result, active_e) += contrib;
+                    if (recording)
+                        guide_path.add_radiance(contrib, active_e);
                 }
             }
             active_surface &= si.is_valid();
@@ -277,6 +318,14 @@ public:
                 BSDFPtr bsdf  = si.bsdf(ray);
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
 
+                // Look up the guiding distribution for smooth BSDFs
+                UInt32 dtree = 0;
+                Mask guided = false;
+                if (m_guide) {
+                    guided = m_guide->guidable(bsdf, active_surface);
+                    dtree = m_guide->lookup(si.p, guided);
+                }
+
                 if (likely(dr::any_or<true>(active_e))) {
                     auto [emitted, ds] = sample_emitter(si, scene, sampler, medium, channel, active_e);
 
@@ -288,12 +337,52 @@ public:
                     // Determine probability of having sampled that same
                     // direction using BSDF sampling.
                     Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-                    result[active_e] += throughput * bsdf_val * mis_weight(ds.pdf, dr::select(ds.delta, 0.f, bsdf_pdf)) * emitted;
+                    if (m_guide)
+                        bsdf_pdf = m_guide->mixture_pdf(dtree, ds.d, bsdf_pdf,
+                                                        guided && active_e);
+                    Spectrum contrib = throughput * bsdf_val * mis_weight(ds.pdf, dr::select(ds.delta, 0.f, bsdf_pdf)) * emitted;
+                    result[active_e] += contrib;
+                    if (recording)
+                        guide_path.add_radiance(contrib, active_e);
+                }
+
+                // ------------- Adjoint-driven Russian roulette --------------
+                if (adrrs) {
+                    Mask adrrs_active = guided;
+                    Float expected =
+                        dr::mean(unpolarized_spectrum(throughput)) *
+                        m_guide->reflected_radiance(ctx, bsdf, si, dtree,
+                                                    sampler->next_2d(adrrs_active),
+                                                    adrrs_active);
+                    dr::masked(pixel_estimate, adrrs_active && dr::eq(depth, 0u)) =
+                        dr::mean(unpolarized_spectrum(result)) + expected;
+
+                    Float survival =
+                        adrrs_factors(expected, pixel_estimate, adrrs_active).first;
+                    Mask rr_continue = sampler->next_1d(adrrs_active) < survival;
+                    dr::masked(throughput, adrrs_active) *= dr::rcp(dr::detach(survival));
+                    active_surface &= !adrrs_active || rr_continue;
+
+                    // Without a pixel estimate, no survival factor was applied
+                    adrrs_vertex = adrrs_active && pixel_estimate > 0.f;
                 }
 
                 // ----------------------- BSDF sampling ----------------------
-                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active_surface),
-                                                   sampler->next_2d(active_surface), active_surface);
+                Float sample_1 = sampler->next_1d(active_surface);
+                Point2f sample_2 = sampler->next_2d(active_surface);
+
+                BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+                Spectrum bsdf_val;
+                Float guide_grad = 0.f;
+
+                if (m_guide)
+                    std::tie(bs, bsdf_val, guide_grad) =
+                        m_guide->sample_bsdf(ctx, bsdf, si, dtree, sample_1,
+                                             sample_2, guided, active_surface);
+                else
+                    std::tie(bs, bsdf_val) =
+                        bsdf->sample(ctx, si, sample_1, sample_2, active_surface);
+
                 bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
                 dr::masked(throughput, active_surface) *= bsdf_val;
@@ -303,6 +392,10 @@ public:
                 dr::masked(ray, active_surface) = bsdf_ray;
                 needs_intersection |= active_surface;
 
+                if (recording)
+                    guide_path.add_vertex(dtree, bsdf_ray.d, throughput, bs.pdf,
+                                          guide_grad, guided);
+
                 Mask non_null_bsdf = active_surface && !has_flag(bs.sampled_type, BSDFFlags::Null);
                 dr::masked(depth, non_null_bsdf) += 1;
 
@@ -319,6 +412,10 @@ public:
             }
             active &= (active_surface | active_medium);
         }
+
+        if (recording)
+            guide_path.commit(m_guide.get(), true);
+
         return { result, valid_ray };
     }
 
@@ -441,9 +538,13 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricSimplePathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  rr_mode = %s,\n"
+                           "  guide = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth,
+                           m_adrrs ? "adrrs" : "throughput",
+                           m_guide ? string::indent(m_guide) : "none");
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
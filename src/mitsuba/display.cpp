@@ -0,0 +1,183 @@
+#include "display.h"
+#include "protocol.h"
+
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Message types of the tev protocol
+enum class TevMessage : uint8_t { CreateImage = 4, UpdateImage = 6 };
+
+/// Size of the tiles that are compared and sent separately
+static constexpr uint32_t TevTileSize = 128;
+
+/// Binary tev message, which is encoded in little endian byte order
+class TevPacket {
+public:
+    TevPacket(TevMessage type) : m_data(4, '\0') {
+        put<uint8_t>((uint8_t) type);
+    }
+
+    template <typename T> void put(T value) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T); ++i)
+            m_data.push_back((char) ((bits >> (8 * i)) & 0xFF));
+    }
+
+    void put(const std::string &value) {
+        m_data.append(value);
+        m_data.push_back('\0');
+    }
+
+    /// Fill in the size of the message and send it
+    void send(SocketChannel &channel) {
+        uint32_t size = (uint32_t) m_data.size();
+        for (size_t i = 0; i < 4; ++i)
+            m_data[i] = (char) ((size >> (8 * i)) & 0xFF);
+        channel.write(m_data.data(), m_data.size());
+    }
+
+private:
+    std::string m_data;
+};
+
+TevDisplay::TevDisplay(const std::string &address, const std::string &name)
+    : m_name(name), m_channel(SocketChannel::connect(address)) {
+    Log(Info, "Showing the rendering progress in the viewer at \"%s\".",
+        address);
+
+    ThreadEnvironment env;
+    m_thread = std::thread([this, env]() {
+        ScopedSetThreadEnvironment set_env(env);
+        run();
+    });
+}
+
+TevDisplay::~TevDisplay() {
+    /* locked */ {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void TevDisplay::update(Snapshot snapshot) {
+    /* locked */ {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_channel)
+            return;
+        m_pending = std::move(snapshot);
+    }
+    m_cv.notify_one();
+}
+
+void TevDisplay::run() {
+    while (true) {
+        Snapshot snapshot;
+        /* locked */ {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_pending || m_shutdown; });
+            if (!m_pending)
+                return;
+            snapshot = std::move(m_pending);
+            m_pending = nullptr;
+        }
+
+        try {
+            ref<Bitmap> bitmap = snapshot();
+            if (bitmap)
+                send(bitmap);
+        } catch (const std::exception &e) {
+            Log(Warn, "Disabling the live display: %s", e.what());
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_channel.reset();
+            m_pending = nullptr;
+            return;
+        }
+    }
+}
+
+void TevDisplay::send(const Bitmap *bitmap) {
+    std::vector<std::string> names;
+    for (const Struct::Field &field : *bitmap->struct_())
+        names.push_back(field.name);
+
+    // The viewer expects single precision values
+    ref<Bitmap> image = new Bitmap(bitmap->pixel_format(), Struct::Type::Float32,
+                                   bitmap->size(), names.size(), names);
+    bitmap->convert(image);
+
+    Bitmap::Vector2u size = image->size();
+    uint32_t channels = (uint32_t) names.size();
+
+    // (Re-)create the image if its layout changed
+    if (!m_previous || m_previous->size() != size ||
+        m_previous->channel_count() != channels) {
+        TevPacket packet(TevMessage::CreateImage);
+        packet.put<uint8_t>(1); // grab focus
+        packet.put(m_name);
+        packet.put<int32_t>((int32_t) size.x());
+        packet.put<int32_t>((int32_t) size.y());
+        packet.put<int32_t>((int32_t) channels);
+        for (const std::string &name : names)
+            packet.put(name);
+        packet.send(*m_channel);
+        m_previous = nullptr;
+    }
+
+    const float *data = (const float *) image->data(),
+                *prev = m_previous ? (const float *) m_previous->data() : nullptr;
+
+    size_t row_size = (size_t) size.x() * channels;
+    for (uint32_t y0 = 0; y0 < size.y(); y0 += TevTileSize) {
+        for (uint32_t x0 = 0; x0 < size.x(); x0 += TevTileSize) {
+            uint32_t w = std::min(TevTileSize, size.x() - x0),
+                     h = std::min(TevTileSize, size.y() - y0);
+            size_t offset = (size_t) y0 * row_size + (size_t) x0 * channels,
+                   tile_row = (size_t) w * channels;
+
+            // Skip tiles that did not change since the previous snapshot
+            bool changed = !prev;
+            for (uint32_t y = 0; y < h && !changed; ++y)
+                changed = std::memcmp(data + offset + y * row_size,
+                                      prev + offset + y * row_size,
+                                      tile_row * sizeof(float)) != 0;
+            if (!changed)
+                continue;
+
+            TevPacket packet(TevMessage::UpdateImage);
+            packet.put<uint8_t>(0); // grab focus
+            packet.put(m_name);
+            packet.put<int32_t>((int32_t) channels);
+            for (const std::string &name : names)
+                packet.put(name);
+            packet.put<int32_t>((int32_t) x0);
+            packet.put<int32_t>((int32_t) y0);
+            packet.put<int32_t>((int32_t) w);
+            packet.put<int32_t>((int32_t) h);
+
+            // Channels are interleaved within the transmitted tile
+            for (uint32_t c = 0; c < channels; ++c)
+                packet.put<int64_t>((int64_t) c);
+            for (uint32_t c = 0; c < channels; ++c)
+                packet.put<int64_t>((int64_t) channels);
+
+            for (uint32_t y = 0; y < h; ++y) {
+                const float *row = data + offset + y * row_size;
+                for (size_t i = 0; i < tile_row; ++i)
+                    packet.put<float>(row[i]);
+            }
+
+            packet.send(*m_channel);
+        }
+    }
+
+    m_previous = image;
+}
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+NAMESPACE_BEGIN(mitsuba)
+
+class SocketChannel;
+
+/**
+ * \brief Streams the image of a rendering in progress to the tev image viewer
+ *
+ * The display connects to a running instance of tev
+ * (https://github.com/Tom94/tev) using its TCP protocol (tev listens on
+ * <tt>127.0.0.1:14158</tt> by default). Snapshots of the film are taken and
+ * transmitted by a separate thread, which only sends the tiles that changed
+ * since the previous snapshot. Errors (e.g. after the viewer was closed) are
+ * reported once, after which the display stays inactive.
+ */
+class TevDisplay {
+public:
+    /// Function that returns the developed contents of the film
+    using Snapshot = std::function<ref<Bitmap>()>;
+
+    /// Connect to the viewer and show the image under the given name
+    TevDisplay(const std::string &address, const std::string &name);
+
+    /// Send the remaining update (if any) and close the connection
+    ~TevDisplay();
+
+    /**
+     * \brief Request an update of the displayed image
+     *
+     * The function \c snapshot is invoked on the display thread. Requests
+     * that arrive while a previous one is still being processed replace each
+     * other, hence this function returns immediately.
+     */
+    void update(Snapshot snapshot);
+
+private:
+    /// Main loop of the display thread
+    void run();
+
+    /// Send the tiles of \c bitmap that differ from the previous snapshot
+    void send(const Bitmap *bitmap);
+
+private:
+    std::string m_name;
+    std::unique_ptr<SocketChannel> m_channel;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    Snapshot m_pending;
+    bool m_shutdown = false;
+
+    /// Last snapshot sent to the viewer (in single precision)
+    ref<Bitmap> m_previous;
+};
+
+NAMESPACE_END(mitsuba)
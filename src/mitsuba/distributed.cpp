@@ -0,0 +1,297 @@
+#include "distributed.h"
+#include "protocol.h"
+
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+
+#include <exception>
+#include <sstream>
+#include <thread>
+
+NAMESPACE_BEGIN(mitsuba)
+
+RenderPartition::Mode RenderPartition::parse_mode(const std::string &name) {
+    if (name == "blocks")
+        return Mode::Blocks;
+    else if (name == "passes")
+        return Mode::Passes;
+    else
+        Throw("Invalid partitioning mode \"%s\", must be one of: \"blocks\" "
+              "or \"passes\"!", name);
+}
+
+template <typename Float, typename Spectrum>
+ref<Bitmap> render_scene_impl(Object *scene_, size_t sensor_i, uint32_t seed,
+                              uint32_t spp, const RenderPartition &partition,
+                              bool raw) {
+    MI_IMPORT_TYPES(Scene, SamplingIntegrator)
+
+    auto *scene = dynamic_cast<Scene *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (sensor_i >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    if (partition.count == 0 || partition.index >= partition.count)
+        Throw("Invalid partition %u/%u!", partition.index, partition.count);
+
+    auto sensor = scene->sensors()[sensor_i];
+    auto integrator = scene->integrator();
+    if (!integrator)
+        Throw("No integrator specified for scene: %s", scene);
+
+    SamplingIntegrator *sampling_integrator = nullptr;
+    if (partition.count > 1) {
+        if (partition.mode == RenderPartition::Mode::Passes) {
+            // Split the samples evenly, and decorrelate the partitions
+            uint32_t total = spp ? spp : sensor->sampler()->sample_count();
+            if (total < partition.count)
+                Throw("Cannot split %u samples per pixel into %u partitions!",
+                      total, partition.count);
+            spp = total / partition.count +
+                  (partition.index < total % partition.count ? 1 : 0);
+            seed = seed * partition.count + partition.index;
+        } else {
+            sampling_integrator = dynamic_cast<SamplingIntegrator *>(integrator);
+            if (!sampling_integrator)
+                Throw("Block partitions require a sampling-based integrator, "
+                      "split the sample count across processes instead!");
+            sampling_integrator->set_block_partition(partition.index,
+                                                     partition.count);
+        }
+    }
+
+    try {
+        integrator->render(scene, sensor.get(), seed, spp,
+                           false /* develop */, true /* evaluate */);
+    } catch (...) {
+        if (sampling_integrator)
+            sampling_integrator->set_block_partition(0, 1);
+        throw;
+    }
+
+    if (sampling_integrator)
+        sampling_integrator->set_block_partition(0, 1);
+
+    return sensor->film()->bitmap(raw);
+}
+
+ref<Bitmap> render_scene(const std::string &variant, Object *scene,
+                         size_t sensor_i, uint32_t seed, uint32_t spp,
+                         const RenderPartition &partition, bool raw) {
+    return MI_INVOKE_VARIANT(variant, render_scene_impl, scene, sensor_i, seed,
+                             spp, partition, raw);
+}
+
+/// Convert raw film data into the channel layout of another bitmap
+static ref<Bitmap> conform_bitmap(const Bitmap *source, const Bitmap *layout,
+                                  Struct::Type component_format) {
+    if (source->size() != layout->size())
+        Throw("Raw film data has resolution %s, expected %s!", source->size(),
+              layout->size());
+
+    std::vector<std::string> names;
+    for (const Struct::Field &field : *layout->struct_()) {
+        if (!source->struct_()->has_field(field.name))
+            Throw("Raw film data lacks the channel \"%s\"!", field.name);
+        names.push_back(field.name);
+    }
+
+    // The weight channel is copied as-is since the target has one as well
+    ref<Bitmap> target =
+        new Bitmap(layout->pixel_format(), component_format, layout->size(),
+                   names.size(), names);
+    target->set_premultiplied_alpha(source->premultiplied_alpha());
+    source->convert(target);
+    return target;
+}
+
+template <typename Float, typename Spectrum>
+void merge_into_film(Object *scene_, size_t sensor_i,
+                     const std::vector<ref<Bitmap>> &parts,
+                     const fs::path &output) {
+    MI_IMPORT_TYPES(Scene, Film, ImageBlock)
+    using FloatStorage = DynamicBuffer<Float>;
+
+    auto *scene = dynamic_cast<Scene *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (sensor_i >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    auto integrator = scene->integrator();
+    if (!integrator)
+        Throw("No integrator specified for scene: %s", scene);
+
+    Film *film = scene->sensors()[sensor_i]->film();
+    film->prepare(integrator->aov_names());
+    ref<Bitmap> layout = film->bitmap(true);
+
+    ScalarVector2u size = film->crop_size();
+    for (const ref<Bitmap> &part : parts) {
+        ref<Bitmap> data =
+            conform_bitmap(part, layout, struct_type_v<ScalarFloat>);
+        size_t shape[3] = { size.y(), size.x(), data->channel_count() };
+        TensorXf tensor(dr::load<FloatStorage>(
+                            (const ScalarFloat *) data->data(),
+                            data->pixel_count() * data->channel_count()),
+                        3, shape);
+
+        ref<ImageBlock> block = new ImageBlock(
+            tensor, ScalarPoint2i(film->crop_offset()), nullptr,
+            false /* border */, false /* normalize */, false /* coalesce */,
+            false /* warn_negative */, false /* warn_invalid */);
+        film->put_block(block);
+    }
+
+    film->write(output);
+}
+
+void render_distributed(const std::string &variant, Object *scene,
+                        const fs::path &scene_file,
+                        const xml::ParameterList &params, size_t sensor_i,
+                        const std::vector<std::string> &workers,
+                        RenderPartition::Mode mode, const fs::path &output) {
+    if (workers.empty())
+        Throw("No workers specified!");
+
+    Log(Info, "Distributing rendering over %zu workers (%s) ..", workers.size(),
+        RenderPartition{ mode }.mode_name());
+
+    std::ostringstream defines;
+    for (size_t i = 0; i < params.size(); ++i)
+        defines << (i > 0 ? ", " : "") << json_escape(std::get<0>(params[i]))
+                << ": " << json_escape(std::get<1>(params[i]));
+
+    Timer timer;
+    size_t n = workers.size();
+    std::vector<std::string> replies(n);
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<std::thread> threads;
+
+    /* The workers render concurrently. The threads only perform network
+       communication, since they are not registered with the logger. */
+    for (size_t i = 0; i < n; ++i) {
+        RenderPartition partition{ mode, (uint32_t) i, (uint32_t) n };
+        std::ostringstream request;
+        request << "{\"scene\": " << json_escape(fs::absolute(scene_file).string())
+                << ", \"defines\": {" << defines.str() << "}"
+                << ", \"sensor\": " << sensor_i
+                << ", \"split\": \"" << partition.mode_name() << "\""
+                << ", \"index\": " << partition.index
+                << ", \"count\": " << partition.count
+                << ", \"raw\": true}";
+
+        threads.emplace_back([&, i, request = request.str()]() {
+            try {
+                auto channel = SocketChannel::connect(workers[i]);
+                channel->write_line(request);
+
+                std::string line;
+                if (!channel->read_line(line))
+                    Throw("Connection closed unexpectedly!");
+                JSONValue reply = parse_json(line);
+                const JSONValue *status = reply.find("status"),
+                                *size   = reply.find("size");
+                if (!status || status->value != "ok") {
+                    const JSONValue *message = reply.find("message");
+                    Throw("%s", message ? message->value : line);
+                }
+                if (!size)
+                    Throw("Reply lacks the image size!");
+
+                replies[i].resize(std::stoull(size->value));
+                channel->read(replies[i].data(), replies[i].size());
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::vector<ref<Bitmap>> parts;
+    for (size_t i = 0; i < n; ++i) {
+        if (errors[i]) {
+            try {
+                std::rethrow_exception(errors[i]);
+            } catch (const std::exception &e) {
+                Throw("Worker \"%s\" failed: %s", workers[i], e.what());
+            }
+        }
+        ref<MemoryStream> stream =
+            new MemoryStream(replies[i].data(), replies[i].size());
+        parts.push_back(new Bitmap(stream, Bitmap::FileFormat::OpenEXR));
+    }
+
+    Log(Info, "All workers finished (took %s), merging ..",
+        util::time_string((float) timer.value(), true));
+
+    MI_INVOKE_VARIANT(variant, merge_into_film, scene, sensor_i, parts, output);
+}
+
+ref<Bitmap> merge_raw_bitmaps(const std::vector<ref<Bitmap>> &bitmaps) {
+    if (bitmaps.empty())
+        Throw("No raw film data specified!");
+
+    // Accumulate in single precision, even if the inputs use half floats
+    ref<Bitmap> result =
+        conform_bitmap(bitmaps[0], bitmaps[0], Struct::Type::Float32);
+    for (size_t i = 1; i < bitmaps.size(); ++i)
+        result->accumulate(
+            conform_bitmap(bitmaps[i], result, Struct::Type::Float32));
+
+    return result;
+}
+
+ref<Bitmap> develop_raw_bitmap(const Bitmap *bitmap) {
+    ref<Bitmap> source = new Bitmap(*bitmap);
+    source->set_premultiplied_alpha(bitmap->premultiplied_alpha());
+
+    // Normalize all channels by the weight channel
+    std::vector<std::string> names;
+    bool has_weight = false;
+    for (Struct::Field &field : *source->struct_()) {
+        if (field.name == "W") {
+            field.flags |= +Struct::Flags::Weight;
+            has_weight = true;
+        } else {
+            names.push_back(field.name);
+        }
+    }
+
+    if (!has_weight)
+        Throw("Raw film data must contain a weight channel \"W\"!");
+
+    ref<Bitmap> target;
+    switch (source->pixel_format()) {
+        case Bitmap::PixelFormat::RGBW:
+            target = new Bitmap(Bitmap::PixelFormat::RGB,
+                                source->component_format(), source->size());
+            break;
+
+        case Bitmap::PixelFormat::RGBAW:
+            target = new Bitmap(Bitmap::PixelFormat::RGBA,
+                                source->component_format(), source->size());
+            break;
+
+        default:
+            target = new Bitmap(Bitmap::PixelFormat::MultiChannel,
+                                source->component_format(), source->size(),
+                                names.size(), names);
+            break;
+    }
+
+    target->set_premultiplied_alpha(source->premultiplied_alpha());
+    source->convert(target);
+    return target;
+}
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/xml.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Describes which part of an image a process renders when a single
+ * frame is distributed over several processes
+ *
+ * In \c Blocks mode, the blocks of the spiral traversal are split into
+ * interleaved partitions (scalar variants only). In \c Passes mode, every
+ * process renders the full image with a share of the sample count and a
+ * distinct seed. In both cases, the raw (unnormalized) film contents of all
+ * partitions sum up to the raw contents of the complete rendering.
+ */
+struct RenderPartition {
+    enum class Mode { Blocks, Passes };
+
+    Mode mode = Mode::Blocks;
+    uint32_t index = 0;
+    uint32_t count = 1;
+
+    /// Parse the name of a partitioning mode ("blocks" or "passes")
+    static Mode parse_mode(const std::string &name);
+
+    /// Return the name of the partitioning mode
+    const char *mode_name() const {
+        return mode == Mode::Blocks ? "blocks" : "passes";
+    }
+};
+
+/**
+ * \brief Render a scene, or one partition of it, and return the contents of
+ * the film
+ *
+ * \param raw
+ *     If set, the raw film storage (including the weight channel) is returned
+ *     instead of the developed image.
+ */
+extern ref<Bitmap> render_scene(const std::string &variant, Object *scene,
+                                size_t sensor_i, uint32_t seed, uint32_t spp,
+                                const RenderPartition &partition, bool raw);
+
+/**
+ * \brief Distribute the rendering of a scene over a set of worker processes
+ * and write the merged image to \c output
+ *
+ * Each worker is a render server (<tt>mitsuba --server --socket
+ * address</tt>) that renders one partition of the image and replies with the
+ * raw film contents, which are accumulated into the film of the local copy
+ * of the scene. The scene file must be accessible under the same (absolute)
+ * path on all workers.
+ */
+extern void render_distributed(const std::string &variant, Object *scene,
+                               const fs::path &scene_file,
+                               const xml::ParameterList &params,
+                               size_t sensor_i,
+                               const std::vector<std::string> &workers,
+                               RenderPartition::Mode mode,
+                               const fs::path &output);
+
+/**
+ * \brief Sum raw film dumps (e.g. produced by <tt>mitsuba --partition</tt>)
+ *
+ * Channels are matched by name. All bitmaps must have the same resolution.
+ */
+extern ref<Bitmap> merge_raw_bitmaps(const std::vector<ref<Bitmap>> &bitmaps);
+
+/// Normalize raw film contents by their weight channel \c W
+extern ref<Bitmap> develop_raw_bitmap(const Bitmap *bitmap);
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,83 @@
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+#include "distributed.h"
+
+using namespace mitsuba;
+
+static void help() {
+    std::cout << R"(
+Usage: mitsuba-merge [options] <Two or more raw film files>
+
+Sums the raw film contents written by separate partitions of a rendering
+(e.g. "mitsuba --partition <index>/<count> scene.xml") and writes the
+developed image.
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -o <filename>, --output <filename>
+        Write the merged image to the file "filename" (default: merged.exr).
+
+    -r, --raw
+        Write the merged raw film contents (including the weight channel)
+        instead of the developed image, e.g. to merge them again later.
+
+)";
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+
+    ArgParser parser;
+    using StringVec = std::vector<std::string>;
+    auto arg_help   = parser.add(StringVec{ "-h", "--help" });
+    auto arg_output = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_raw    = parser.add(StringVec{ "-r", "--raw" });
+    auto arg_extra  = parser.add("", true);
+
+    int result = 0;
+    try {
+        parser.parse(argc, argv);
+
+        if (!*arg_extra || *arg_help) {
+            help();
+        } else {
+            std::vector<ref<Bitmap>> bitmaps;
+            while (arg_extra && *arg_extra) {
+                fs::path filename(arg_extra->as_string());
+                Log(Info, "Loading \"%s\" ..", filename);
+                bitmaps.push_back(new Bitmap(filename));
+                arg_extra = arg_extra->next();
+            }
+
+            ref<Bitmap> merged = merge_raw_bitmaps(bitmaps);
+            if (!*arg_raw)
+                merged = develop_raw_bitmap(merged);
+
+            fs::path output(*arg_output ? arg_output->as_string() : "merged.exr");
+            Log(Info, "Writing \"%s\" ..", output);
+            merged->write(output);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Caught a critical exception: " << e.what() << std::endl;
+        result = -1;
+    }
+
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+
+    return result;
+}
@@ -1,3 +1,4 @@
+#include <mitsuba/core/appender.h>
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
@@ -13,6 +14,9 @@
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include "display.h"
+#include "distributed.h"
+#include "server.h"
 
 #if !defined(_WIN32)
 #  include <signal.h>
@@ -26,6 +30,7 @@ static void help(int thread_count) {
     std::cout << util::info_features() << std::endl;
     std::cout << R"(
 Usage: mitsuba [options] <One or more scene XML files>
+       mitsuba [options] --server [--socket <address>] [--output-dir <path>]
 
 Options:
 
@@ -63,6 +68,56 @@ Options:
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
 
+    --display <address>
+        Show the image while it is being rendered in the tev image viewer
+        listening on the TCP endpoint "address" (e.g. 127.0.0.1:14158).
+        The image is updated about once per second (scalar modes), or after
+        every pass (JIT modes, requires specifying "samples_per_pass").
+        Not available when the film streams its output to disk.
+
+    --server
+        Keep the renderer resident and process a stream of render requests
+        (one JSON object per line) read from the standard input, e.g.
+
+          {"scene": "scene.xml", "defines": {"spp": 64}, "output": "out.exr"}
+
+        Other entries are "sensor", "seed", "spp" and "reload" (discard
+        all cached objects). Objects whose parameters did not change since
+        a previous request (meshes, textures, ..) are reused. Replies are
+        written to the standard output, log messages to standard error.
+        Without "output", the image is streamed back after the reply.
+
+    --socket <address>
+        Together with --server, listen for requests on a UNIX domain socket
+        (a path) or a TCP endpoint ("host:port") instead of the standard input.
+        TCP endpoints without a host (":port") listen on 127.0.0.1.
+
+    --allow-remote
+        Together with --socket, permit listening on TCP interfaces other
+        than the loopback interface (e.g. "*:port" for all of them). Clients
+        are not authenticated, only use this on trusted networks.
+
+    --output-dir <path>
+        Together with --server, directory in which the "output" files of
+        requests are written (default: the current working directory).
+        Outputs must be relative paths that stay within this directory.
+
+ === Distributed rendering of a single image ===
+
+    --workers <address1>;<address2>;..
+        Split the rendering across render servers (started with --server
+        --socket <address>) and merge their results. The scene file must be
+        accessible under the same absolute path on all workers.
+
+    --split <blocks|passes>
+        Give each worker (or partition) a disjoint subset of the image blocks
+        (scalar modes only, default) or of the samples per pixel.
+
+    --partition <index>/<count>
+        Only render partition 'index' (starting at 0) of 'count', and write
+        the raw film contents (including the weight channel). Raw outputs
+        of all partitions can be combined using the mitsuba-merge tool.
+
  === The following options are only relevant for JIT (CUDA/LLVM) modes ===
 
     -O [0-5]
@@ -108,7 +163,8 @@ void scene_static_accel_shutdown() {
 }
 
 template <typename Float, typename Spectrum>
-void render(Object *scene_, size_t sensor_i, fs::path filename) {
+void render(Object *scene_, size_t sensor_i, fs::path filename,
+            const std::string &display_address) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
     if (!scene)
         Throw("Root element of the input file must be a <scene> tag!");
@@ -127,17 +183,58 @@ void render(Object *scene_, size_t sensor_i, fs::path filename) {
         develop_callback = [&]() { film->write(filename); };
     }
 
-    integrator->render(scene, (uint32_t) sensor_i,
-                       0 /* seed */,
-                       0 /* spp */,
-                       false /* develop */,
-                       true /* evaluate */);
+    std::unique_ptr<TevDisplay> display;
+    if (!display_address.empty() && film->streams_output()) {
+        // Streamed images are only available once they are complete
+        Log(Warn, "The live display is not supported when the film streams "
+                  "its output to disk.");
+    } else if (!display_address.empty()) {
+        try {
+            display = std::make_unique<TevDisplay>(display_address,
+                                                   filename.filename().string());
+        } catch (const std::exception &e) {
+            Log(Warn, "Could not connect to the live display: %s", e.what());
+        }
+    }
+
+    if (display) {
+        integrator->set_preview_callback(
+            [&display](const Film<Float, Spectrum> *preview_film) {
+                if constexpr (dr::is_jit_v<Float>) {
+                    // JIT storage is read on the rendering thread between passes
+                    ref<Bitmap> bitmap = preview_film->bitmap();
+                    display->update([bitmap]() { return bitmap; });
+                } else {
+                    // Develop the image on the display thread
+                    display->update([preview_film]() { return preview_film->bitmap(); });
+                }
+            });
+    }
+
+    try {
+        integrator->render(scene, (uint32_t) sensor_i,
+                           0 /* seed */,
+                           0 /* spp */,
+                           false /* develop */,
+                           true /* evaluate */);
+    } catch (...) {
+        integrator->set_preview_callback(nullptr);
+        throw;
+    }
+
+    integrator->set_preview_callback(nullptr);
 
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = nullptr;
     }
 
+    if (display) {
+        // Show the final image (never streamed, see above)
+        display->update([&film]() { return film->bitmap(); });
+        display.reset();
+    }
+
     film->write(filename);
 }
 
@@ -173,6 +270,14 @@ int main(int argc, char *argv[]) {
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
     auto arg_paths     = parser.add(StringVec{ "-a" }, true);
+    auto arg_server    = parser.add(StringVec{ "--server" }, false);
+    auto arg_socket    = parser.add(StringVec{ "--socket" }, true);
+    auto arg_remote    = parser.add(StringVec{ "--allow-remote" }, false);
+    auto arg_out_dir   = parser.add(StringVec{ "--output-dir" }, true);
+    auto arg_workers   = parser.add(StringVec{ "--workers" }, true);
+    auto arg_split     = parser.add(StringVec{ "--split" }, true);
+    auto arg_partition = parser.add(StringVec{ "--partition" }, true);
+    auto arg_display   = parser.add(StringVec{ "--display" }, true);
     auto arg_extra     = parser.add("", true);
 
     // Specialized flags for the JIT compiler
@@ -212,6 +317,12 @@ int main(int argc, char *argv[]) {
 
         // Set the log level
         auto logger = Thread::thread()->logger();
+
+        // Replies are sent over the standard output in server mode
+        if (*arg_server && !*arg_socket) {
+            logger->clear_appenders();
+            logger->add_appender(new StreamAppender(&std::cerr));
+        }
         mitsuba::LogLevel log_level_mitsuba[] = {
             Info,
             Debug,
@@ -334,7 +445,33 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if (!*arg_extra || *arg_help) {
+        if (*arg_socket && !*arg_server)
+            Throw("The --socket option requires --server!");
+
+        if (*arg_remote && !*arg_socket)
+            Throw("The --allow-remote option requires --socket!");
+
+        if (*arg_out_dir && !*arg_server)
+            Throw("The --output-dir option requires --server!");
+
+        if (*arg_workers && *arg_partition)
+            Throw("The --workers and --partition options are mutually exclusive!");
+
+        RenderPartition partition;
+        if (*arg_split)
+            partition.mode = RenderPartition::parse_mode(arg_split->as_string());
+        if (*arg_partition) {
+            auto tokens = string::tokenize(arg_partition->as_string(), "/");
+            if (tokens.size() != 2)
+                Throw("--partition: expect index/count pair!");
+            partition.index = (uint32_t) std::stoul(tokens[0]);
+            partition.count = (uint32_t) std::stoul(tokens[1]);
+            if (partition.count == 0 || partition.index >= partition.count)
+                Throw("--partition: invalid partition %s!",
+                      arg_partition->as_string());
+        }
+
+        if ((!*arg_extra && !*arg_server) || *arg_help) {
             help((int) Thread::thread_count());
         } else {
             Log(Info, "%s", util::info_build((int) Thread::thread_count()));
@@ -368,9 +505,37 @@ int main(int argc, char *argv[]) {
                 Throw("Root element of the input file is expanded into "
                       "multiple objects, only a single object is expected!");
 
-            MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i, filename);
+            if (*arg_workers) {
+                render_distributed(mode, parsed[0].get(), arg_extra->as_string(),
+                                   params, sensor_i,
+                                   string::tokenize(arg_workers->as_string(), ";"),
+                                   partition.mode, filename);
+            } else if (*arg_partition) {
+                ref<Bitmap> raw = render_scene(mode, parsed[0].get(), sensor_i,
+                                               0, 0, partition, true);
+                if (!*arg_output)
+                    filename.replace_extension(
+                        tfm::format(".part%u.exr", partition.index));
+                raw->write(filename, Bitmap::FileFormat::OpenEXR);
+            } else {
+                MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i,
+                                  filename,
+                                  *arg_display ? arg_display->as_string()
+                                               : std::string());
+            }
             arg_extra = arg_extra->next();
         }
+
+        if (*arg_server && !*arg_help) {
+            RenderServer server(mode, params, parallel_loading,
+                                *arg_out_dir ? fs::path(arg_out_dir->as_string())
+                                             : fs::path(),
+                                (bool) *arg_remote);
+            if (*arg_socket)
+                server.serve_socket(arg_socket->as_string());
+            else
+                server.serve_stdio();
+        }
     } catch (const std::exception &e) {
         error_msg = std::string("Caught a critical exception: ") + e.what();
     } catch (...) {
@@ -0,0 +1,451 @@
+#include "protocol.h"
+
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#  if !defined(MSG_NOSIGNAL)
+#    define MSG_NOSIGNAL 0
+#  endif
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+class JSONParser {
+public:
+    JSONParser(const std::string &str) : m_str(str), m_pos(0) { }
+
+    JSONValue parse() {
+        JSONValue result = parse_value();
+        skip_whitespace();
+        if (m_pos != m_str.size())
+            fail("trailing characters");
+        return result;
+    }
+
+private:
+    [[noreturn]] void fail(const char *reason) const {
+        Throw("Malformed JSON message (%s at offset %zu)!", reason, m_pos);
+    }
+
+    void skip_whitespace() {
+        while (m_pos < m_str.size() && std::isspace((unsigned char) m_str[m_pos]))
+            m_pos++;
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (m_pos < m_str.size() && m_str[m_pos] == c) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume_literal(const char *literal) {
+        size_t len = std::strlen(literal);
+        if (m_str.compare(m_pos, len, literal) != 0)
+            return false;
+        m_pos += len;
+        return true;
+    }
+
+    JSONValue parse_value() {
+        skip_whitespace();
+        if (m_pos == m_str.size())
+            fail("unexpected end of input");
+
+        JSONValue result;
+        char c = m_str[m_pos];
+        if (c == '{') {
+            result.type = JSONValue::Type::Object;
+            m_pos++;
+            if (consume('}'))
+                return result;
+            do {
+                skip_whitespace();
+                if (m_pos == m_str.size() || m_str[m_pos] != '"')
+                    fail("expected a key");
+                std::string key = parse_string();
+                if (!consume(':'))
+                    fail("expected ':'");
+                result.entries[key] = parse_value();
+            } while (consume(','));
+            if (!consume('}'))
+                fail("expected '}'");
+        } else if (c == '"') {
+            result.type = JSONValue::Type::String;
+            result.value = parse_string();
+        } else if (consume_literal("true") || consume_literal("false")) {
+            result.type = JSONValue::Type::Bool;
+            result.value = c == 't' ? "true" : "false";
+        } else if (consume_literal("null")) {
+            result.type = JSONValue::Type::Null;
+        } else {
+            size_t start = m_pos;
+            while (m_pos < m_str.size() &&
+                   (std::isdigit((unsigned char) m_str[m_pos]) ||
+                    std::strchr("+-.eE", m_str[m_pos])))
+                m_pos++;
+            if (start == m_pos)
+                fail("unexpected character");
+            result.type = JSONValue::Type::Number;
+            result.value = m_str.substr(start, m_pos - start);
+        }
+        return result;
+    }
+
+    std::string parse_string() {
+        std::string result;
+        m_pos++; // opening quote
+        while (true) {
+            if (m_pos >= m_str.size())
+                fail("unterminated string");
+            char c = m_str[m_pos++];
+            if (c == '"')
+                break;
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (m_pos >= m_str.size())
+                fail("unterminated string");
+            switch (c = m_str[m_pos++]) {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'u': {
+                    if (m_pos + 4 > m_str.size())
+                        fail("invalid escape sequence");
+                    uint32_t cp = (uint32_t) std::stoul(m_str.substr(m_pos, 4), nullptr, 16);
+                    m_pos += 4;
+                    // Encode as UTF-8 (surrogate pairs are not supported)
+                    if (cp < 0x80) {
+                        result += (char) cp;
+                    } else if (cp < 0x800) {
+                        result += (char) (0xC0 | (cp >> 6));
+                        result += (char) (0x80 | (cp & 0x3F));
+                    } else {
+                        result += (char) (0xE0 | (cp >> 12));
+                        result += (char) (0x80 | ((cp >> 6) & 0x3F));
+                        result += (char) (0x80 | (cp & 0x3F));
+                    }
+                    break;
+                }
+                default: result += c; break;
+            }
+        }
+        return result;
+    }
+
+private:
+    const std::string &m_str;
+    size_t m_pos;
+};
+
+std::string json_escape(const std::string &str) {
+    std::string result = "\"";
+    for (char c : str) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            case '\r': result += "\\r"; break;
+            default:
+                if ((unsigned char) c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (int) c);
+                    result += buf;
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result + "\"";
+}
+
+JSONValue parse_json(const std::string &str) {
+    return JSONParser(str).parse();
+}
+
+// =======================================================================
+//! @{ \name Transport of requests and replies
+// =======================================================================
+
+bool StdioChannel::read_line(std::string &line) {
+    return (bool) std::getline(std::cin, line);
+}
+
+void StdioChannel::read(void *data, size_t size) {
+    if (!std::cin.read((char *) data, (std::streamsize) size))
+        Throw("Could not read from the standard input!");
+}
+
+void StdioChannel::write(const void *data, size_t size) {
+    if (std::fwrite(data, 1, size, stdout) != size)
+        Throw("Could not write to the standard output!");
+    std::fflush(stdout);
+}
+
+#if defined(_WIN32)
+
+SocketChannel::~SocketChannel() { }
+
+std::unique_ptr<SocketChannel> SocketChannel::connect(const std::string &) {
+    Throw("Sockets are not supported on Windows!");
+}
+
+bool SocketChannel::read_line(std::string &) { return false; }
+void SocketChannel::read(void *, size_t) { }
+void SocketChannel::write(const void *, size_t) { }
+
+int listen_socket(const std::string &, bool) {
+    Throw("Sockets are not supported on Windows, use the standard "
+          "input/output instead!");
+}
+
+std::unique_ptr<SocketChannel> accept_socket(int) { return nullptr; }
+void close_socket(int, const std::string &) { }
+
+#else
+
+/// Split a socket address into a UNIX socket path or a TCP host and port
+static bool parse_address(const std::string &address, std::string &path,
+                          std::string &host, std::string &port) {
+    if (string::starts_with(address, "unix:")) {
+        path = address.substr(5);
+        return true;
+    }
+    size_t colon = address.rfind(':');
+    if (address.find('/') != std::string::npos || colon == std::string::npos) {
+        path = address;
+        return true;
+    }
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+    return false;
+}
+
+static sockaddr_un unix_address(const std::string &path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        Throw("Socket path \"%s\" is too long!", path);
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+/// Check whether a resolved address refers to the local machine only
+static bool is_loopback(const addrinfo *info) {
+    if (info->ai_family == AF_INET) {
+        const sockaddr_in *addr = (const sockaddr_in *) info->ai_addr;
+        return (ntohl(addr->sin_addr.s_addr) >> 24) == 127;
+    } else if (info->ai_family == AF_INET6) {
+        const sockaddr_in6 *addr = (const sockaddr_in6 *) info->ai_addr;
+        return IN6_IS_ADDR_LOOPBACK(&addr->sin6_addr);
+    }
+    return false;
+}
+
+/**
+ * \brief Create a socket bound or connected to a TCP endpoint
+ *
+ * Servers listen on the loopback interface when no host is given. Binding
+ * to other interfaces (including all of them via the host \c "*") requires
+ * \c allow_remote, since the protocol does not authenticate clients.
+ */
+static int tcp_socket(const std::string &host, const std::string &port,
+                      bool server, bool allow_remote = false) {
+    bool any = server && host == "*";
+    if (any && !allow_remote)
+        Throw("Refusing to listen on all network interfaces (\"*:%s\") "
+              "without --allow-remote!", port);
+
+    addrinfo hints, *info = nullptr;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = any ? AI_PASSIVE : 0;
+
+    // Without AI_PASSIVE, a null node resolves to the loopback interface
+    const char *node = (server && (host.empty() || any)) ? nullptr
+                                                         : host.c_str();
+    int rv = getaddrinfo(node, port.c_str(), &hints, &info);
+    if (rv != 0)
+        Throw("Could not resolve \"%s:%s\": %s", host, port, gai_strerror(rv));
+
+    if (server && !allow_remote) {
+        for (addrinfo *it = info; it; it = it->ai_next) {
+            if (is_loopback(it))
+                continue;
+            freeaddrinfo(info);
+            Throw("Refusing to listen on the non-loopback address \"%s:%s\" "
+                  "without --allow-remote!", host, port);
+        }
+    }
+
+    int fd = -1, err = 0;
+    for (addrinfo *it = info; it; it = it->ai_next) {
+        fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (fd < 0) {
+            err = errno;
+            continue;
+        }
+        if (server) {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, it->ai_addr, it->ai_addrlen) == 0)
+                break;
+        } else if (::connect(fd, it->ai_addr, it->ai_addrlen) == 0) {
+            break;
+        }
+        err = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(info);
+
+    if (fd < 0)
+        Throw("Could not %s \"%s:%s\": %s", server ? "bind to" : "connect to",
+              host, port, std::strerror(err));
+    return fd;
+}
+
+SocketChannel::~SocketChannel() { close(m_fd); }
+
+std::unique_ptr<SocketChannel> SocketChannel::connect(const std::string &address) {
+    std::string path, host, port;
+    int fd;
+    if (parse_address(address, path, host, port)) {
+        sockaddr_un addr = unix_address(path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            Throw("Could not create a socket: %s", std::strerror(errno));
+        if (::connect(fd, (sockaddr *) &addr, sizeof(addr)) != 0) {
+            int err = errno;
+            close(fd);
+            Throw("Could not connect to \"%s\": %s", path, std::strerror(err));
+        }
+    } else {
+        fd = tcp_socket(host, port, false);
+    }
+    return std::make_unique<SocketChannel>(fd);
+}
+
+bool SocketChannel::read_line(std::string &line) {
+    while (true) {
+        size_t newline = m_buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = m_buffer.substr(0, newline);
+            m_buffer.erase(0, newline + 1);
+            return true;
+        }
+        char buf[4096];
+        ssize_t n = ::read(m_fd, buf, sizeof(buf));
+        if (n <= 0) {
+            // Process a trailing line without newline
+            line = std::move(m_buffer);
+            m_buffer.clear();
+            return !line.empty();
+        }
+        m_buffer.append(buf, (size_t) n);
+    }
+}
+
+void SocketChannel::read(void *data, size_t size) {
+    char *ptr = (char *) data;
+
+    // Consume data that was already buffered by read_line()
+    size_t buffered = std::min(size, m_buffer.size());
+    std::memcpy(ptr, m_buffer.data(), buffered);
+    m_buffer.erase(0, buffered);
+    ptr += buffered;
+    size -= buffered;
+
+    while (size > 0) {
+        ssize_t n = ::read(m_fd, ptr, size);
+        if (n <= 0)
+            Throw("Connection closed while reading data!");
+        ptr += n;
+        size -= (size_t) n;
+    }
+}
+
+void SocketChannel::write(const void *data, size_t size) {
+    const char *ptr = (const char *) data;
+    while (size > 0) {
+        ssize_t n = ::send(m_fd, ptr, size, MSG_NOSIGNAL);
+        if (n <= 0)
+            Throw("Could not write to the socket!");
+        ptr += n;
+        size -= (size_t) n;
+    }
+}
+
+int listen_socket(const std::string &address, bool allow_remote) {
+    std::string path, host, port;
+    int fd;
+    if (parse_address(address, path, host, port)) {
+        sockaddr_un addr = unix_address(path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            Throw("Could not create a socket: %s", std::strerror(errno));
+        unlink(path.c_str());
+        if (bind(fd, (sockaddr *) &addr, sizeof(addr)) != 0) {
+            int err = errno;
+            close(fd);
+            Throw("Could not bind to \"%s\": %s", path, std::strerror(err));
+        }
+    } else {
+        fd = tcp_socket(host, port, true, allow_remote);
+    }
+
+    if (listen(fd, 16) != 0) {
+        int err = errno;
+        close(fd);
+        Throw("Could not listen on \"%s\": %s", address, std::strerror(err));
+    }
+    return fd;
+}
+
+std::unique_ptr<SocketChannel> accept_socket(int fd) {
+    while (true) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client >= 0)
+            return std::make_unique<SocketChannel>(client);
+        if (errno != EINTR) {
+            Log(Warn, "Could not accept a connection: %s", std::strerror(errno));
+            return nullptr;
+        }
+    }
+}
+
+void close_socket(int fd, const std::string &address) {
+    close(fd);
+    std::string path, host, port;
+    if (parse_address(address, path, host, port))
+        unlink(path.c_str());
+}
+
+#endif
+
+//! @}
+// =======================================================================
+
+NAMESPACE_END(mitsuba)
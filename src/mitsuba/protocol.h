@@ -0,0 +1,105 @@
+#pragma once
+
+#include <mitsuba/mitsuba.h>
+#include <map>
+#include <memory>
+#include <string>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Value of a JSON message exchanged by the render server, its clients
+ * and the distributed rendering coordinator
+ *
+ * Scalars are kept in their textual form, arrays are not supported.
+ */
+struct JSONValue {
+    enum class Type { Null, Bool, Number, String, Object };
+
+    Type type = Type::Null;
+    std::string value;
+    std::map<std::string, JSONValue> entries;
+
+    /// Look up an entry of an object (or \c nullptr)
+    const JSONValue *find(const std::string &name) const {
+        auto it = entries.find(name);
+        return it == entries.end() ? nullptr : &it->second;
+    }
+};
+
+/// Parse a single JSON value
+extern JSONValue parse_json(const std::string &str);
+
+/// Quote and escape a string for inclusion in a JSON message
+extern std::string json_escape(const std::string &str);
+
+/// Bidirectional line-based connection to a client or a server
+class RequestChannel {
+public:
+    virtual ~RequestChannel() = default;
+
+    /// Read the next line, returns \c false when the connection is closed
+    virtual bool read_line(std::string &line) = 0;
+
+    /// Read exactly \c size bytes of binary data
+    virtual void read(void *data, size_t size) = 0;
+
+    /// Send raw data to the other end
+    virtual void write(const void *data, size_t size) = 0;
+
+    void write_line(const std::string &line) {
+        std::string tmp = line + "\n";
+        write(tmp.data(), tmp.size());
+    }
+};
+
+/// Channel communicating over the standard input and output
+class StdioChannel : public RequestChannel {
+public:
+    bool read_line(std::string &line) override;
+    void read(void *data, size_t size) override;
+    void write(const void *data, size_t size) override;
+};
+
+/**
+ * \brief Channel communicating over a connected socket
+ *
+ * Socket addresses either refer to a UNIX domain socket (a path containing a
+ * slash or no colon, or any string prefixed with <tt>unix:</tt>), or to a TCP
+ * endpoint given as <tt>host:port</tt>. Servers listen on the loopback
+ * interface when the host is omitted (<tt>:port</tt>), and <tt>*:port</tt>
+ * listens on all interfaces. Sockets are not supported on Windows.
+ */
+class SocketChannel : public RequestChannel {
+public:
+    SocketChannel(int fd) : m_fd(fd) { }
+    ~SocketChannel();
+
+    /// Connect to a server listening on the given address
+    static std::unique_ptr<SocketChannel> connect(const std::string &address);
+
+    bool read_line(std::string &line) override;
+    void read(void *data, size_t size) override;
+    void write(const void *data, size_t size) override;
+
+private:
+    int m_fd;
+    std::string m_buffer;
+};
+
+/**
+ * \brief Create a socket listening on the given address (see \ref
+ * SocketChannel)
+ *
+ * TCP sockets are restricted to loopback addresses unless \c allow_remote
+ * is specified.
+ */
+extern int listen_socket(const std::string &address, bool allow_remote = false);
+
+/// Accept a connection, returns \c nullptr if the socket failed
+extern std::unique_ptr<SocketChannel> accept_socket(int fd);
+
+/// Close a listening socket and remove its file (if any)
+extern void close_socket(int fd, const std::string &address);
+
+NAMESPACE_END(mitsuba)
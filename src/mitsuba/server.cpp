@@ -0,0 +1,234 @@
+#include "server.h"
+#include "distributed.h"
+#include "protocol.h"
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+
+#include <algorithm>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+RenderServer::RenderServer(const std::string &mode,
+                           const xml::ParameterList &params,
+                           bool parallel_loading,
+                           const fs::path &output_dir,
+                           bool allow_remote)
+    : m_mode(mode), m_params(params), m_parallel_loading(parallel_loading),
+      m_allow_remote(allow_remote) {
+    m_output_dir = fs::absolute(output_dir.empty() ? fs::current_path()
+                                                   : output_dir);
+    if (!fs::is_directory(m_output_dir))
+        Throw("Output directory \"%s\" does not exist!", m_output_dir);
+}
+
+RenderServer::~RenderServer() {
+    // Release the scenes before the cached objects they reference
+    m_scenes.clear();
+    m_cache.clear();
+}
+
+void RenderServer::serve_stdio() {
+    Log(Info, "Render server is waiting for requests on the standard input ..");
+    StdioChannel channel;
+    serve(channel);
+}
+
+void RenderServer::serve_socket(const std::string &address) {
+    int fd = listen_socket(address, m_allow_remote);
+    Log(Info, "Render server is listening on \"%s\" ..", address);
+
+    // Clients are served one after the other, since rendering uses all cores
+    try {
+        bool running = true;
+        while (running) {
+            std::unique_ptr<SocketChannel> channel = accept_socket(fd);
+            if (!channel)
+                break;
+            running = serve(*channel);
+        }
+    } catch (...) {
+        close_socket(fd, address);
+        throw;
+    }
+
+    close_socket(fd, address);
+}
+
+bool RenderServer::serve(RequestChannel &channel) {
+    std::string line;
+    while (channel.read_line(line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        bool running = true;
+        try {
+            running = process(line, channel);
+        } catch (const std::exception &e) {
+            Log(Warn, "Render request failed: %s", e.what());
+            channel.write_line("{\"status\": \"error\", \"message\": " +
+                               json_escape(e.what()) + "}");
+        }
+        if (!running)
+            return false;
+    }
+    return true;
+}
+
+fs::path RenderServer::output_path(const std::string &name) const {
+    fs::path path(name);
+    if (path.empty() || path.is_absolute())
+        Throw("Output \"%s\" must be a path relative to the output "
+              "directory!", name);
+
+    // Reject paths that could escape from the output directory
+    for (fs::path p = path; !p.empty(); p = p.parent_path()) {
+        if (p.filename() == fs::path(".."))
+            Throw("Output \"%s\" must not refer to a parent directory!", name);
+    }
+
+    return m_output_dir / path;
+}
+
+bool RenderServer::process(const std::string &request, RequestChannel &channel) {
+    JSONValue req = parse_json(request);
+    if (req.type != JSONValue::Type::Object)
+        Throw("Requests must be JSON objects!");
+
+    auto entry = [&](const char *name) { return req.find(name); };
+
+    auto as_int = [&](const char *name, uint32_t def) -> uint32_t {
+        const JSONValue *v = entry(name);
+        if (!v)
+            return def;
+        if (v->type != JSONValue::Type::Number)
+            Throw("Request entry \"%s\" must be a number!", name);
+        return (uint32_t) std::stoul(v->value);
+    };
+
+    std::string command = "render";
+    if (const JSONValue *v = entry("command"))
+        command = v->value;
+
+    if (command == "quit") {
+        channel.write_line("{\"status\": \"ok\"}");
+        return false;
+    } else if (command == "clear") {
+        m_scenes.clear();
+        m_cache.clear();
+        channel.write_line("{\"status\": \"ok\"}");
+        return true;
+    } else if (command != "render") {
+        Throw("Unknown command \"%s\"!", command);
+    }
+
+    const JSONValue *scene_entry = entry("scene");
+    if (!scene_entry || scene_entry->type != JSONValue::Type::String)
+        Throw("Render requests must specify a \"scene\" file!");
+
+    if (const JSONValue *v = entry("reload"); v && v->value == "true") {
+        m_scenes.clear();
+        m_cache.clear();
+    }
+
+    // Request-specific definitions override those of the command line
+    xml::ParameterList params = m_params;
+    if (const JSONValue *defines = entry("defines")) {
+        if (defines->type != JSONValue::Type::Object)
+            Throw("Request entry \"defines\" must be an object!");
+        for (auto &[key, value] : defines->entries) {
+            auto it = std::find_if(params.begin(), params.end(),
+                [&key = key](const auto &p) { return std::get<0>(p) == key; });
+            if (it != params.end())
+                std::get<1>(*it) = value.value;
+            else
+                params.emplace_back(key, value.value, false);
+        }
+    }
+
+    fs::path filename(scene_entry->value);
+
+    // Add the scene file's directory to the search path (as done by main())
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+    ref<FileResolver> fr2 = new FileResolver(*fr);
+    fs::path scene_dir = filename.parent_path();
+    if (!fr2->contains(scene_dir))
+        fr2->append(scene_dir);
+    thread->set_file_resolver(fr2);
+
+    Timer timer;
+    std::vector<ref<Object>> parsed;
+    try {
+        parsed = xml::load_file(filename, m_mode, params, false,
+                                m_parallel_loading, false, &m_cache);
+    } catch (...) {
+        thread->set_file_resolver(fr);
+        throw;
+    }
+    thread->set_file_resolver(fr);
+
+    if (parsed.size() != 1)
+        Throw("Root element of the input file is expanded into "
+              "multiple objects, only a single object is expected!");
+
+    // Replace the previous version of the scene and release unused objects
+    m_scenes[filename.string()] = parsed[0];
+    parsed.clear();
+    size_t pruned = m_cache.prune();
+    float load_time = (float) timer.reset();
+
+    Log(Debug, "Scene \"%s\" loaded (took %s, %zu cached objects, %zu released).",
+        filename, util::time_string(load_time), m_cache.size(), pruned);
+
+    // Optionally only render one partition of the image
+    RenderPartition partition;
+    if (const JSONValue *v = entry("split"))
+        partition.mode = RenderPartition::parse_mode(v->value);
+    partition.index = as_int("index", 0);
+    partition.count = as_int("count", 1);
+
+    const JSONValue *raw = entry("raw");
+    ref<Bitmap> bitmap =
+        render_scene(m_mode, m_scenes[filename.string()].get(),
+                     (size_t) as_int("sensor", 0), as_int("seed", 0),
+                     as_int("spp", 0), partition, raw && raw->value == "true");
+    float render_time = (float) timer.value();
+
+    std::ostringstream reply;
+    reply << "{\"status\": \"ok\", \"width\": " << bitmap->width()
+          << ", \"height\": " << bitmap->height()
+          << ", \"load_time\": " << load_time
+          << ", \"render_time\": " << render_time;
+
+    if (const JSONValue *output = entry("output")) {
+        if (output->type != JSONValue::Type::String)
+            Throw("Request entry \"output\" must be a string!");
+        fs::path path = output_path(output->value);
+        bitmap->write(path);
+        reply << ", \"output\": " << json_escape(path.string()) << "}";
+        channel.write_line(reply.str());
+    } else {
+        // Stream the image as an OpenEXR file following the reply
+        ref<MemoryStream> stream = new MemoryStream();
+        bitmap->write(stream, Bitmap::FileFormat::OpenEXR);
+        std::vector<uint8_t> data(stream->size());
+        stream->seek(0);
+        stream->read(data.data(), data.size());
+
+        reply << ", \"size\": " << data.size() << "}";
+        channel.write_line(reply.str());
+        channel.write(data.data(), data.size());
+    }
+
+    return true;
+}
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/xml.h>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+class RequestChannel;
+
+/**
+ * \brief Resident render server used by the <tt>--server</tt> mode of the
+ * \c mitsuba executable
+ *
+ * The server processes render requests encoded as single-line JSON objects,
+ * e.g.
+ *
+ * <tt>{"scene": "scene.xml", "defines": {"spp": 64}, "sensor": 0,
+ *      "spp": 64, "seed": 0, "output": "out.exr"}</tt>
+ *
+ * Only the \c scene entry is required. Scenes are parsed anew for every
+ * request, but all objects whose parameters did not change (bitmaps, meshes,
+ * ...) are reused from previous requests through an \ref xml::InstanceCache.
+ * Setting <tt>"reload": true</tt> discards all cached objects, e.g. after
+ * external files were modified.
+ *
+ * Each request produces a single-line JSON reply. On success, it contains the
+ * image resolution and timings, and the image is either written to
+ * \c output, or streamed as an OpenEXR file of \c size bytes that directly
+ * follows the reply line. Outputs must be relative paths, which are
+ * resolved within the server's output directory and may not contain
+ * <tt>..</tt> components. On failure, the reply has the form
+ * <tt>{"status": "error", "message": "..."}</tt>. The request
+ * <tt>{"command": "quit"}</tt> shuts the server down.
+ *
+ * The entries \c split (\c "blocks" or \c "passes"), \c index and \c count
+ * restrict rendering to one partition of the image (see \ref
+ * RenderPartition), and <tt>"raw": true</tt> requests the unnormalized film
+ * contents. Both are used by the distributed rendering coordinator.
+ */
+class RenderServer {
+public:
+    /**
+     * \brief Create a render server
+     *
+     * \param output_dir
+     *     Directory receiving the images of requests with an \c output
+     *     entry (defaults to the current working directory)
+     *
+     * \param allow_remote
+     *     Permit listening on TCP interfaces other than the loopback
+     *     interface. The protocol does not authenticate clients.
+     */
+    RenderServer(const std::string &mode, const xml::ParameterList &params,
+                 bool parallel_loading, const fs::path &output_dir = fs::path(),
+                 bool allow_remote = false);
+
+    ~RenderServer();
+
+    /// Process requests read from the standard input until it is closed
+    void serve_stdio();
+
+    /**
+     * \brief Process requests from clients connecting to a UNIX domain
+     * socket or TCP endpoint (see \ref SocketChannel for the address format)
+     */
+    void serve_socket(const std::string &address);
+
+private:
+    /// Process all requests of a channel, returns \c false upon shutdown
+    bool serve(RequestChannel &channel);
+
+    /// Resolve the \c output entry of a request within the output directory
+    fs::path output_path(const std::string &name) const;
+
+    /// Process a single request, returns \c false upon shutdown
+    bool process(const std::string &request, RequestChannel &channel);
+
+private:
+    std::string m_mode;
+    xml::ParameterList m_params;
+    bool m_parallel_loading;
+    fs::path m_output_dir;
+    bool m_allow_remote;
+    xml::InstanceCache m_cache;
+
+    /// Most recently loaded version of every scene file
+    std::unordered_map<std::string, ref<Object>> m_scenes;
+};
+
+NAMESPACE_END(mitsuba)
@@ -38,6 +38,7 @@ MI_PY_DECLARE(MicrofacetType);
 MI_PY_DECLARE(PhaseFunctionExtras);
 MI_PY_DECLARE(Spiral);
 MI_PY_DECLARE(Sensor);
+MI_PY_DECLARE(serialized);
 MI_PY_DECLARE(VolumeGrid);
 MI_PY_DECLARE(FilmFlags);
 
@@ -125,6 +126,7 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     MI_PY_IMPORT(PhaseFunctionExtras);
     MI_PY_IMPORT(Spiral);
     MI_PY_IMPORT(Sensor);
+    MI_PY_IMPORT(serialized);
     MI_PY_IMPORT(FilmFlags);
 
     /* Register a cleanup callback function that is invoked when
@@ -83,6 +83,14 @@ Film<Float, Spectrum>::prepare_sample(const UnpolarizedSpectrum & /* spec */,
     NotImplementedError("prepare_sample");
 }
 
+MI_VARIANT void
+Film<Float, Spectrum>::prepare_blocks(const ScalarPoint2i & /* offset */,
+                                      const ScalarVector2u & /* size */,
+                                      uint32_t /* block_size */,
+                                      uint32_t /* passes */,
+                                      uint32_t /* partition_index */,
+                                      uint32_t /* partition_count */) { }
+
 MI_VARIANT const typename Film<Float, Spectrum>::Texture *
 Film<Float, Spectrum>::sensor_response_function() {
     return m_srf.get();
@@ -0,0 +1,617 @@
+#include <mitsuba/render/guiding.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/warp.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MI_VARIANT SDTree<Float, Spectrum>::SDTree(const Properties &props)
+    : m_iteration(0), m_training(false), m_guided_sampling(true) {
+    // Fraction of the sample budget spent on training passes
+    m_budget = props.get<ScalarFloat>("guiding_budget", .25f);
+    if (m_budget <= 0.f || m_budget >= 1.f)
+        Throw("\"guiding_budget\" must be in the interval (0, 1)!");
+
+    /* Spatial leaves are split once they receive more than
+       c * sqrt(2^k) samples in training iteration k */
+    m_spatial_threshold = props.get<ScalarFloat>("guiding_spatial_threshold", 12000.f);
+
+    // Quadrants holding more than this fraction of the energy are refined
+    m_rho = props.get<ScalarFloat>("guiding_rho", .01f);
+
+    m_max_spatial_depth = props.get<uint32_t>("guiding_max_spatial_depth", 24);
+    m_max_directional_depth = props.get<uint32_t>("guiding_max_directional_depth", 20);
+
+    // Learning rate of the BSDF selection probability optimization
+    m_learning_rate = props.get<ScalarFloat>("guiding_learning_rate", .01f);
+
+    reset(ScalarBoundingBox3f(ScalarPoint3f(0.f), ScalarPoint3f(1.f)));
+}
+
+MI_VARIANT SDTree<Float, Spectrum>::~SDTree() { }
+
+MI_VARIANT void SDTree<Float, Spectrum>::reset(const ScalarBoundingBox3f &bbox) {
+    if (!bbox.valid())
+        Throw("SDTree::reset(): invalid bounding box!");
+
+    // Slightly enlarge the box (and make it cubic) to avoid degenerate extents
+    ScalarVector3f extents = bbox.extents();
+    ScalarFloat size = dr::max(extents) * 1.001f + math::RayEpsilon<ScalarFloat>;
+    m_bbox = ScalarBoundingBox3f(bbox.center() - .5f * size,
+                                 bbox.center() + .5f * size);
+    m_inv_extents = dr::rcp(m_bbox.extents());
+
+    m_spatial.clear();
+    m_directional.clear();
+    m_dtrees.clear();
+
+    m_spatial.push_back(SpatialNode{ 0, 0 });
+    m_directional.push_back(DirectionalNode{ { 0, 0, 0, 0 },
+                                             { 1.f, 1.f, 1.f, 1.f } });
+    m_dtrees.push_back(DTree{ 0, 0.0, 0.0, 0.0, 0, 0.f });
+    m_iteration = 0;
+    m_training = false;
+
+    upload();
+}
+
+MI_VARIANT void SDTree<Float, Spectrum>::upload() {
+    size_t n_spatial = m_spatial.size(),
+           n_directional = m_directional.size(),
+           n_dtrees = m_dtrees.size();
+
+    std::unique_ptr<uint32_t[]> spatial_child(new uint32_t[n_spatial]),
+                                spatial_data(new uint32_t[n_spatial]),
+                                dir_child(new uint32_t[n_directional * 4]),
+                                dtree_root(new uint32_t[n_dtrees]);
+    std::unique_ptr<ScalarFloat[]> dir_sum(new ScalarFloat[n_directional * 4]),
+                                   dtree_alpha(new ScalarFloat[n_dtrees]),
+                                   dtree_flux(new ScalarFloat[n_dtrees]);
+
+    for (size_t i = 0; i < n_spatial; ++i) {
+        spatial_child[i] = m_spatial[i].child;
+        spatial_data[i] = m_spatial[i].data;
+    }
+
+    for (size_t i = 0; i < n_directional; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            dir_child[i * 4 + j] = m_directional[i].child[j];
+            dir_sum[i * 4 + j] = m_directional[i].sum[j];
+        }
+    }
+
+    for (size_t i = 0; i < n_dtrees; ++i) {
+        dtree_root[i] = m_dtrees[i].root;
+        /* Keep a minimum amount of BSDF and guided sampling, the former
+           covers regions that the tree has missed so far */
+        double alpha = 1.0 / (1.0 + std::exp(-m_dtrees[i].theta));
+        dtree_alpha[i] = (ScalarFloat) std::min(std::max(alpha, .05), .95);
+        dtree_flux[i] = m_dtrees[i].flux;
+    }
+
+    m_spatial_child = dr::load<UInt32Storage>(spatial_child.get(), n_spatial);
+    m_spatial_data  = dr::load<UInt32Storage>(spatial_data.get(), n_spatial);
+    m_dir_child     = dr::load<UInt32Storage>(dir_child.get(), n_directional * 4);
+    m_dir_sum       = dr::load<FloatStorage>(dir_sum.get(), n_directional * 4);
+    m_dtree_root    = dr::load<UInt32Storage>(dtree_root.get(), n_dtrees);
+    m_dtree_alpha   = dr::load<FloatStorage>(dtree_alpha.get(), n_dtrees);
+    m_dtree_flux    = dr::load<FloatStorage>(dtree_flux.get(), n_dtrees);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        m_dir_record   = dr::zeros<FloatStorage>(n_directional * 4);
+        m_dtree_record = dr::zeros<FloatStorage>(n_dtrees * 2);
+        dr::make_opaque(m_dir_record, m_dtree_record);
+    } else {
+        m_dir_record_host = std::unique_ptr<AtomicFloat<ScalarFloat>[]>(
+            new AtomicFloat<ScalarFloat>[n_directional * 4]);
+        m_dtree_record_host = std::unique_ptr<AtomicFloat<ScalarFloat>[]>(
+            new AtomicFloat<ScalarFloat>[n_dtrees * 2]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+MI_VARIANT typename SDTree<Float, Spectrum>::Point2f
+SDTree<Float, Spectrum>::dir_to_canonical(const Vector3f &d) const {
+    Float cos_theta = dr::clamp(d.z(), -1.f, 1.f),
+          phi       = dr::atan2(d.y(), d.x());
+    phi = dr::select(phi < 0.f, phi + dr::TwoPi<Float>, phi);
+
+    return dr::clamp(Point2f(.5f * (cos_theta + 1.f), phi * dr::InvTwoPi<Float>),
+                     0.f, dr::OneMinusEpsilon<Float>);
+}
+
+MI_VARIANT typename SDTree<Float, Spectrum>::Vector3f
+SDTree<Float, Spectrum>::canonical_to_dir(const Point2f &p) const {
+    Float cos_theta = 2.f * p.x() - 1.f,
+          sin_theta = dr::safe_sqrt(1.f - dr::sqr(cos_theta));
+    auto [s, c] = dr::sincos(dr::TwoPi<Float> * p.y());
+    return Vector3f(c * sin_theta, s * sin_theta, cos_theta);
+}
+
+MI_VARIANT typename SDTree<Float, Spectrum>::UInt32
+SDTree<Float, Spectrum>::lookup(const Point3f &p_, Mask active) const {
+    Mask valid = active;
+    Point3f p = dr::clamp((p_ - m_bbox.min) * m_inv_extents, 0.f,
+                          dr::OneMinusEpsilon<Float>);
+    UInt32 node = 0;
+
+    dr::Loop<Mask> loop("SDTree::lookup", p, node, active);
+    while (loop(active)) {
+        UInt32 child = dr::gather<UInt32>(m_spatial_child, node, active);
+        active &= dr::neq(child, 0u);
+
+        UInt32 axis = dr::gather<UInt32>(m_spatial_data, node, active);
+        Mask is_x = dr::eq(axis, 0u), is_y = dr::eq(axis, 1u),
+             is_z = !is_x && !is_y;
+
+        Float value = dr::select(is_x, p.x(), dr::select(is_y, p.y(), p.z()));
+        Mask right = value >= .5f;
+        value = 2.f * value - dr::select(right, Float(1.f), Float(0.f));
+
+        dr::masked(p.x(), active && is_x) = value;
+        dr::masked(p.y(), active && is_y) = value;
+        dr::masked(p.z(), active && is_z) = value;
+        dr::masked(node, active) = child + dr::select(right, UInt32(1u), UInt32(0u));
+    }
+
+    return dr::gather<UInt32>(m_spatial_data, node, valid);
+}
+
+MI_VARIANT typename SDTree<Float, Spectrum>::Vector3f
+SDTree<Float, Spectrum>::sample(const UInt32 &dtree, const Point2f &sample_,
+                                Mask active) const {
+    Mask valid = active;
+    UInt32 node = dr::gather<UInt32>(m_dtree_root, dtree, active);
+    Point2f sample = sample_, offset = 0.f;
+    Float scale = 1.f;
+
+    dr::Loop<Mask> loop("SDTree::sample", sample, offset, scale, node, active);
+    while (loop(active)) {
+        Vector4f sum = dr::gather<Vector4f>(m_dir_sum, node, active);
+
+        // Select the left or right half using the marginal density
+        Float left = sum.x() + sum.z(), total = left + sum.y() + sum.w(),
+              frac_x = dr::select(total > 0.f, left / total, .5f);
+        Mask x = sample.x() >= frac_x;
+        sample.x() = dr::select(x, (sample.x() - frac_x) / (1.f - frac_x),
+                                sample.x() / frac_x);
+
+        // .. and then the bottom or top quadrant conditioned on it
+        Float bottom = dr::select(x, sum.y(), sum.x()),
+              top    = dr::select(x, sum.w(), sum.z()),
+              frac_y = dr::select(bottom + top > 0.f, bottom / (bottom + top), .5f);
+        Mask y = sample.y() >= frac_y;
+        sample.y() = dr::select(y, (sample.y() - frac_y) / (1.f - frac_y),
+                                sample.y() / frac_y);
+
+        scale *= .5f;
+        offset += Vector2f(dr::select(x, scale, 0.f), dr::select(y, scale, 0.f));
+
+        UInt32 quadrant = dr::select(x, UInt32(1u), UInt32(0u)) +
+                          dr::select(y, UInt32(2u), UInt32(0u));
+        UInt32 child = dr::gather<UInt32>(m_dir_child, node * 4u + quadrant, active);
+        active &= dr::neq(child, 0u);
+        dr::masked(node, active) = child;
+    }
+
+    sample = dr::clamp(sample, 0.f, dr::OneMinusEpsilon<Float>);
+    return dr::select(valid, canonical_to_dir(dr::fmadd(sample, scale, offset)),
+                      Vector3f(0.f, 0.f, 1.f));
+}
+
+MI_VARIANT Float SDTree<Float, Spectrum>::pdf(const UInt32 &dtree,
+                                              const Vector3f &d,
+                                              Mask active) const {
+    UInt32 node = dr::gather<UInt32>(m_dtree_root, dtree, active);
+    Point2f p = dir_to_canonical(d);
+    Float value = dr::select(active, dr::InvFourPi<Float>, 0.f);
+
+    dr::Loop<Mask> loop("SDTree::pdf", p, node, value, active);
+    while (loop(active)) {
+        Vector4f sum = dr::gather<Vector4f>(m_dir_sum, node, active);
+        Mask x = p.x() >= .5f, y = p.y() >= .5f;
+
+        Float total = sum.x() + sum.y() + sum.z() + sum.w(),
+              child_sum = dr::select(x, dr::select(y, sum.w(), sum.y()),
+                                        dr::select(y, sum.z(), sum.x()));
+        dr::masked(value, active) *=
+            dr::select(total > 0.f, 4.f * child_sum / total, 1.f);
+
+        p = 2.f * p - Point2f(dr::select(x, Float(1.f), Float(0.f)),
+                              dr::select(y, Float(1.f), Float(0.f)));
+
+        UInt32 quadrant = dr::select(x, UInt32(1u), UInt32(0u)) +
+                          dr::select(y, UInt32(2u), UInt32(0u));
+        UInt32 child = dr::gather<UInt32>(m_dir_child, node * 4u + quadrant, active);
+        active &= dr::neq(child, 0u);
+        dr::masked(node, active) = child;
+    }
+
+    return value;
+}
+
+MI_VARIANT Float SDTree<Float, Spectrum>::bsdf_fraction(const UInt32 &dtree,
+                                                        Mask active) const {
+    return dr::gather<Float>(m_dtree_alpha, dtree, active);
+}
+
+MI_VARIANT Float SDTree<Float, Spectrum>::reflected_radiance(
+    const BSDFContext &ctx, const BSDFPtr &bsdf, const SurfaceInteraction3f &si,
+    const UInt32 &dtree, const Point2f &sample, Mask active) const {
+    if (!ready())
+        return 0.f;
+
+    /* With L_i(d) = pdf(d) * flux, the one-sample estimate of the reflected
+       radiance f(d) * L_i(d) / pdf(d) reduces to f(d) * flux */
+    Vector3f d = this->sample(dtree, sample, active);
+    Spectrum f = bsdf->eval(ctx, si, si.to_local(d), active);
+    return dr::mean(unpolarized_spectrum(f)) *
+           dr::gather<Float>(m_dtree_flux, dtree, active);
+}
+
+MI_VARIANT typename SDTree<Float, Spectrum>::Mask
+SDTree<Float, Spectrum>::guidable(const BSDFPtr &bsdf, Mask active) const {
+    UInt32 flags = bsdf->flags(active);
+
+    /* Guided samples are evaluated through eval_pdf(), which does not report
+       the relative index of refraction of transmitted directions. Lobes that
+       refract (e.g. rough dielectrics) are therefore only sampled by the BSDF,
+       as the path throughput and Russian roulette depend on it. */
+    return active && has_flag(flags, BSDFFlags::Smooth) &&
+           !has_flag(flags, BSDFFlags::Delta) &&
+           !has_flag(flags, BSDFFlags::Delta1D) &&
+           !has_flag(flags, BSDFFlags::GlossyTransmission);
+}
+
+MI_VARIANT std::tuple<typename SDTree<Float, Spectrum>::BSDFSample3f, Spectrum, Float>
+SDTree<Float, Spectrum>::sample_bsdf(const BSDFContext &ctx, const BSDFPtr &bsdf,
+                                     const SurfaceInteraction3f &si,
+                                     const UInt32 &dtree, Float sample1,
+                                     const Point2f &sample2, Mask guided,
+                                     Mask active) const {
+    guided &= active && ready() && m_guided_sampling;
+    Float alpha = dr::select(guided, bsdf_fraction(dtree, guided), 1.f);
+
+    // Reuse the lobe selection sample to choose between the two techniques
+    Mask use_bsdf = !guided || sample1 < alpha;
+    Mask use_guide = active && !use_bsdf;
+    dr::masked(sample1, guided && use_bsdf) =
+        dr::minimum(sample1 / alpha, dr::OneMinusEpsilon<Float>);
+
+    auto [bs, weight] = bsdf->sample(ctx, si, sample1, sample2, active && use_bsdf);
+
+    if (dr::none_or<false>(guided))
+        return { bs, weight, 0.f };
+
+    Spectrum value = weight * bs.pdf;
+    Float bsdf_pdf = bs.pdf;
+
+    if (dr::any_or<true>(use_guide)) {
+        Vector3f wo = si.to_local(sample(dtree, sample2, use_guide));
+        auto [value_g, pdf_g] = bsdf->eval_pdf(ctx, si, wo, use_guide);
+
+        dr::masked(bs.wo, use_guide) = wo;
+        // Guidable BSDFs do not refract (see guidable())
+        dr::masked(bs.eta, use_guide) = 1.f;
+        dr::masked(bs.sampled_component, use_guide) = 0u;
+        dr::masked(bs.sampled_type, use_guide) = dr::select(
+            Frame3f::cos_theta(wo) > 0.f, UInt32(+BSDFFlags::GlossyReflection),
+            UInt32(+BSDFFlags::GlossyTransmission));
+        dr::masked(value, use_guide) = value_g;
+        dr::masked(bsdf_pdf, use_guide) = pdf_g;
+    }
+
+    Float guide_pdf = pdf(dtree, si.to_world(bs.wo), guided),
+          mix_pdf   = dr::lerp(guide_pdf, bsdf_pdf, alpha);
+
+    dr::masked(bs.pdf, guided) = mix_pdf;
+    dr::masked(weight, guided) = dr::select(mix_pdf > 0.f, value / mix_pdf, 0.f);
+
+    /* Gradient of the KL divergence between the (normalized) product of BSDF
+       and incident radiance and the mixture density w.r.t. the logit of the
+       selection probability, up to the yet unknown incident radiance. */
+    Float grad = -dr::mean(unpolarized_spectrum(value)) * (bsdf_pdf - guide_pdf) *
+                 alpha * (1.f - alpha) / dr::sqr(mix_pdf);
+    grad = dr::select(guided && mix_pdf > 0.f && dr::isfinite(grad), grad, 0.f);
+
+    return { bs, weight, dr::detach(grad) };
+}
+
+MI_VARIANT Float SDTree<Float, Spectrum>::mixture_pdf(const UInt32 &dtree,
+                                                      const Vector3f &d,
+                                                      const Float &bsdf_pdf,
+                                                      Mask guided) const {
+    guided &= ready() && m_guided_sampling;
+    if (dr::none_or<false>(guided))
+        return bsdf_pdf;
+
+    Float alpha = bsdf_fraction(dtree, guided);
+    return dr::select(guided, dr::lerp(pdf(dtree, d, guided), bsdf_pdf, alpha),
+                      bsdf_pdf);
+}
+
+// -----------------------------------------------------------------------------
+
+MI_VARIANT void SDTree<Float, Spectrum>::accumulate(FloatStorage &buffer,
+                                                    AtomicFloat<ScalarFloat> *host,
+                                                    const Float &value,
+                                                    const UInt32 &index,
+                                                    Mask active) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        DRJIT_MARK_USED(host);
+        dr::scatter_reduce(ReduceOp::Add, buffer, value, index, active);
+    } else {
+        DRJIT_MARK_USED(buffer);
+        if (active)
+            host[index] += value;
+    }
+}
+
+MI_VARIANT void SDTree<Float, Spectrum>::record(const UInt32 &dtree,
+                                                const Vector3f &d,
+                                                const Float &radiance_,
+                                                const Float &gradient_,
+                                                Mask active) const {
+    Float radiance = dr::detach(radiance_),
+          gradient = dr::detach(gradient_);
+    active &= dr::isfinite(radiance) && radiance >= 0.f;
+
+    // Sample count and gradient of the selection probability
+    accumulate(m_dtree_record, m_dtree_record_host.get(), 1.f,
+               dtree * 2u, active);
+    accumulate(m_dtree_record, m_dtree_record_host.get(),
+               dr::select(dr::isfinite(gradient), gradient, 0.f),
+               dtree * 2u + 1u, active);
+
+    active &= radiance > 0.f;
+    if (dr::none_or<false>(active))
+        return;
+
+    // Splat the radiance into all nodes along the path to the leaf quadrant
+    UInt32 node = dr::gather<UInt32>(m_dtree_root, dtree, active);
+    Point2f p = dir_to_canonical(d);
+
+    dr::Loop<Mask> loop("SDTree::record", p, node, active);
+    while (loop(active)) {
+        Mask x = p.x() >= .5f, y = p.y() >= .5f;
+        UInt32 quadrant = dr::select(x, UInt32(1u), UInt32(0u)) +
+                          dr::select(y, UInt32(2u), UInt32(0u)),
+               index = node * 4u + quadrant;
+
+        accumulate(m_dir_record, m_dir_record_host.get(), radiance, index, active);
+
+        p = 2.f * p - Point2f(dr::select(x, Float(1.f), Float(0.f)),
+                              dr::select(y, Float(1.f), Float(0.f)));
+
+        UInt32 child = dr::gather<UInt32>(m_dir_child, index, active);
+        active &= dr::neq(child, 0u);
+        dr::masked(node, active) = child;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+MI_VARIANT uint32_t SDTree<Float, Spectrum>::copy_directional(uint32_t root) {
+    uint32_t new_root = (uint32_t) m_directional.size();
+    m_directional.push_back(m_directional[root]);
+
+    std::vector<std::pair<uint32_t, uint32_t>> stack = { { root, new_root } };
+    while (!stack.empty()) {
+        auto [src, dst] = stack.back();
+        stack.pop_back();
+
+        for (uint32_t i = 0; i < 4; ++i) {
+            uint32_t child = m_directional[src].child[i];
+            if (!child)
+                continue;
+            uint32_t index = (uint32_t) m_directional.size();
+            m_directional.push_back(m_directional[child]);
+            m_directional[dst].child[i] = index;
+            stack.emplace_back(child, index);
+        }
+    }
+
+    return new_root;
+}
+
+MI_VARIANT uint32_t SDTree<Float, Spectrum>::build_directional(
+    const ScalarFloat *records, uint32_t root,
+    std::vector<DirectionalNode> &out) const {
+    const uint32_t invalid = (uint32_t) -1;
+
+    struct Item {
+        uint32_t index, old_index, depth;
+    };
+
+    ScalarFloat total = 0.f;
+    for (uint32_t i = 0; i < 4; ++i)
+        total += records[root * 4 + i];
+
+    uint32_t new_root = (uint32_t) out.size();
+    std::vector<Item> stack;
+
+    if (!(total > 0.f)) {
+        // Nothing was recorded: keep the current distribution
+        out.push_back(m_directional[root]);
+        stack.push_back({ new_root, root, 0 });
+        while (!stack.empty()) {
+            Item item = stack.back();
+            stack.pop_back();
+            for (uint32_t i = 0; i < 4; ++i) {
+                uint32_t child = m_directional[item.old_index].child[i];
+                if (!child)
+                    continue;
+                uint32_t index = (uint32_t) out.size();
+                out.push_back(m_directional[child]);
+                out[item.index].child[i] = index;
+                stack.push_back({ index, child, item.depth + 1 });
+            }
+        }
+        return new_root;
+    }
+
+    DirectionalNode node;
+    for (uint32_t i = 0; i < 4; ++i) {
+        node.child[i] = 0;
+        node.sum[i] = records[root * 4 + i];
+    }
+    out.push_back(node);
+    stack.push_back({ new_root, root, 1 });
+
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+
+        for (uint32_t i = 0; i < 4; ++i) {
+            ScalarFloat energy = out[item.index].sum[i];
+            if (item.depth >= m_max_directional_depth || energy <= m_rho * total)
+                continue;
+
+            /* Refine the quadrant. If it was already subdivided, use the
+               recorded energy of its children, otherwise assume that the
+               energy is uniformly distributed. */
+            uint32_t old_child = item.old_index != invalid
+                                     ? m_directional[item.old_index].child[i]
+                                     : 0;
+
+            DirectionalNode child;
+            for (uint32_t j = 0; j < 4; ++j) {
+                child.child[j] = 0;
+                child.sum[j] = old_child ? records[old_child * 4 + j]
+                                         : energy * .25f;
+            }
+
+            uint32_t index = (uint32_t) out.size();
+            out.push_back(child);
+            out[item.index].child[i] = index;
+            stack.push_back({ index, old_child ? old_child : invalid,
+                              item.depth + 1 });
+        }
+    }
+
+    return new_root;
+}
+
+MI_VARIANT void SDTree<Float, Spectrum>::refine() {
+    size_t n_directional = m_directional.size(),
+           n_dtrees = m_dtrees.size();
+
+    // Fetch the recorded statistics
+    std::vector<ScalarFloat> dir_record(n_directional * 4),
+                             dtree_record(n_dtrees * 2);
+
+    if constexpr (dr::is_jit_v<Float>) {
+        FloatStorage dir_record_h = dr::migrate(m_dir_record, AllocType::Host),
+                     dtree_record_h = dr::migrate(m_dtree_record, AllocType::Host);
+        dr::sync_thread();
+        memcpy(dir_record.data(), dir_record_h.data(),
+               n_directional * 4 * sizeof(ScalarFloat));
+        memcpy(dtree_record.data(), dtree_record_h.data(),
+               n_dtrees * 2 * sizeof(ScalarFloat));
+    } else {
+        for (size_t i = 0; i < n_directional * 4; ++i)
+            dir_record[i] = m_dir_record_host[i];
+        for (size_t i = 0; i < n_dtrees * 2; ++i)
+            dtree_record[i] = m_dtree_record_host[i];
+    }
+
+    // 1. Optimize the BSDF selection probabilities using Adam
+    const double beta_1 = 0.9, beta_2 = 0.999, epsilon = 1e-8;
+    for (size_t i = 0; i < n_dtrees; ++i) {
+        DTree &dt = m_dtrees[i];
+        double count = dtree_record[i * 2];
+        if (count <= 0.0)
+            continue;
+        double grad = dtree_record[i * 2 + 1] / count;
+        dt.adam_steps++;
+        dt.adam_m = beta_1 * dt.adam_m + (1.0 - beta_1) * grad;
+        dt.adam_v = beta_2 * dt.adam_v + (1.0 - beta_2) * grad * grad;
+        double m_hat = dt.adam_m / (1.0 - std::pow(beta_1, dt.adam_steps)),
+               v_hat = dt.adam_v / (1.0 - std::pow(beta_2, dt.adam_steps));
+        dt.theta -= m_learning_rate * m_hat / (std::sqrt(v_hat) + epsilon);
+        dt.theta = std::min(std::max(dt.theta, -20.0), 20.0);
+    }
+
+    /* 2. Update the radiance estimates: the records of a root node sum up
+          incident radiance divided by the sampling density */
+    for (size_t i = 0; i < n_dtrees; ++i) {
+        double count = dtree_record[i * 2], total = 0.0;
+        if (count <= 0.0)
+            continue;
+        for (uint32_t j = 0; j < 4; ++j)
+            total += dir_record[m_dtrees[i].root * 4 + j];
+        m_dtrees[i].flux = (ScalarFloat) (total / count);
+    }
+
+    // 3. Rebuild the directional trees based on the recorded energy
+    std::vector<DirectionalNode> directional;
+    directional.reserve(n_directional);
+    for (size_t i = 0; i < n_dtrees; ++i)
+        m_dtrees[i].root =
+            build_directional(dir_record.data(), m_dtrees[i].root, directional);
+    m_directional = std::move(directional);
+
+    // 4. Split spatial leaves that received sufficiently many samples
+    ScalarFloat threshold =
+        m_spatial_threshold * dr::sqrt((ScalarFloat) (1u << std::min(m_iteration, 30u)));
+
+    struct Item {
+        uint32_t index, depth;
+        ScalarFloat count;
+    };
+
+    std::vector<Item> stack = { { 0, 0, -1.f } };
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+
+        SpatialNode node = m_spatial[item.index];
+        if (node.child) {
+            stack.push_back({ node.child, item.depth + 1, -1.f });
+            stack.push_back({ node.child + 1, item.depth + 1, -1.f });
+            continue;
+        }
+
+        ScalarFloat count = item.count < 0.f ? dtree_record[node.data * 2]
+                                             : item.count;
+        if (count <= threshold || item.depth >= m_max_spatial_depth)
+            continue;
+
+        // Both children start out with (a copy of) the parent's distribution
+        uint32_t dtree = (uint32_t) m_dtrees.size();
+        m_dtrees.push_back(m_dtrees[node.data]);
+        m_dtrees.back().root = copy_directional(m_dtrees[node.data].root);
+
+        uint32_t child = (uint32_t) m_spatial.size();
+        m_spatial.push_back(SpatialNode{ 0, node.data });
+        m_spatial.push_back(SpatialNode{ 0, dtree });
+        m_spatial[item.index] = SpatialNode{ child, item.depth % 3 };
+
+        stack.push_back({ child, item.depth + 1, count * .5f });
+        stack.push_back({ child + 1, item.depth + 1, count * .5f });
+    }
+
+    m_iteration++;
+    upload();
+
+    Log(Debug, "SDTree: finished training iteration %u (%zu spatial nodes, "
+               "%zu directional trees, %zu directional nodes)",
+        m_iteration, m_spatial.size(), m_dtrees.size(), m_directional.size());
+}
+
+MI_VARIANT std::string SDTree<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "SDTree[" << std::endl
+        << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+        << "  iteration = " << m_iteration << "," << std::endl
+        << "  spatial_nodes = " << m_spatial.size() << "," << std::endl
+        << "  directional_trees = " << m_dtrees.size() << "," << std::endl
+        << "  directional_nodes = " << m_directional.size() << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(SDTree, Object)
+MI_INSTANTIATE_CLASS(SDTree)
+NAMESPACE_END(mitsuba)
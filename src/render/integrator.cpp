@@ -20,7 +20,7 @@ NAMESPACE_BEGIN(mitsuba)
 // -----------------------------------------------------------------------------
 
 MI_VARIANT Integrator<Float, Spectrum>::Integrator(const Properties & props)
-    : m_stop(false) {
+    : m_stop(false), m_preview_interval(0), m_next_preview(0) {
     m_timeout = props.get<ScalarFloat>("timeout", -1.f);
 
     // Disable direct visibility of emitters if needed
@@ -49,6 +49,31 @@ MI_VARIANT void Integrator<Float, Spectrum>::cancel() {
     m_stop = true;
 }
 
+MI_VARIANT void
+Integrator<Float, Spectrum>::set_preview_callback(const PreviewCallback &callback,
+                                                  float interval) {
+    m_preview_callback = callback;
+    m_preview_interval = (size_t) (1000.f * std::max(interval, 0.f));
+}
+
+MI_VARIANT void Integrator<Float, Spectrum>::reset_preview() {
+    m_next_preview = m_render_timer.value() + m_preview_interval;
+}
+
+MI_VARIANT void Integrator<Float, Spectrum>::preview(const Film *film) {
+    if (!m_preview_callback)
+        return;
+
+    size_t now = m_render_timer.value(),
+           due = m_next_preview.load(std::memory_order_relaxed);
+    if (now < due)
+        return;
+
+    // Only the thread that advances the deadline invokes the callback
+    if (m_next_preview.compare_exchange_strong(due, now + m_preview_interval))
+        m_preview_callback(film);
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
@@ -65,10 +90,27 @@ MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Propert
     }
 
     m_samples_per_pass = props.get<uint32_t>("samples_per_pass", (uint32_t) -1);
+
+    m_max_wavefront_size = props.get<uint32_t>("max_wavefront_size", 0);
+
+    m_record_passes = props.get<bool>("record_passes", false);
 }
 
 MI_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
 
+MI_VARIANT void
+SamplingIntegrator<Float, Spectrum>::set_block_partition(uint32_t index,
+                                                         uint32_t count) {
+    if (count == 0 || index >= count)
+        Throw("set_block_partition(): invalid partition %u/%u!", index, count);
+    if (dr::is_jit_v<Float> && count > 1)
+        Throw("set_block_partition(): block partitions are only supported in "
+              "scalar variants, split the sample count across processes "
+              "instead!");
+    m_partition_index = index;
+    m_partition_count = count;
+}
+
 MI_VARIANT typename SamplingIntegrator<Float, Spectrum>::TensorXf
 SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                                             Sensor *sensor,
@@ -106,6 +148,7 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
 
     // Start the render timer (used for timeouts & log messages)
     m_render_timer.reset();
+    reset_preview();
 
     TensorXf result;
     if constexpr (!dr::is_jit_v<Float>) {
@@ -134,12 +177,24 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         }
 
         Spiral spiral(film_size, film->crop_offset(), block_size, n_passes);
+        spiral.set_partition(m_partition_index, m_partition_count);
+
+        ScalarPoint2i grid_offset(film->crop_offset());
+        if (film->sample_border())
+            grid_offset -= film->rfilter()->border_size();
+        film->prepare_blocks(grid_offset, film_size, block_size, n_passes,
+                             m_partition_index, m_partition_count);
+
+        if (m_partition_count > 1)
+            Log(Info, "Rendering block partition %u/%u (%u of %u blocks per pass)",
+                m_partition_index + 1, m_partition_count,
+                spiral.partition_block_count(), spiral.block_count());
 
         ref<ProgressReporter> progress = new ProgressReporter("Rendering");
         std::mutex mutex;
 
         // Total number of blocks to be handled, including multiple passes.
-        uint32_t total_blocks = spiral.block_count() * n_passes,
+        uint32_t total_blocks = spiral.partition_block_count() * n_passes,
                  blocks_done = 0;
 
         // Grain size for parallelization
@@ -179,6 +234,7 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                                  spp_per_pass, seed, block_id, block_size);
 
                     film->put_block(block);
+                    preview(film);
 
                     /* Critical section: update progress bar */ {
                         std::lock_guard<std::mutex> lock(mutex);
@@ -198,32 +254,72 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             film_size.x(), film_size.y(), spp, spp == 1 ? "" : "s",
             n_passes > 1 ? tfm::format(", %u passes,", n_passes) : "");
 
-        if (n_passes > 1 && !evaluate) {
-            Log(Warn, "render(): forcing 'evaluate=true' since multi-pass "
-                      "rendering was requested.");
-            evaluate = true;
-        }
-
-        size_t wavefront_size = (size_t) film_size.x() *
-                                (size_t) film_size.y() * (size_t) spp_per_pass,
+        size_t pixel_count = (size_t) film_size.x() * (size_t) film_size.y(),
                wavefront_size_limit =
                    dr::is_llvm_v<Float> ? 0xffffffffu : 0x40000000u;
 
+        if (m_max_wavefront_size > 0)
+            wavefront_size_limit =
+                std::min(wavefront_size_limit, (size_t) m_max_wavefront_size);
+
+        /* Partition the work into multiple passes and/or image chunks to keep
+           the size of every wavefront below the limit. All of them launch
+           the same kernel, which accumulates into a single image block. */
+        size_t chunk_pixels = pixel_count;
+        uint32_t n_chunks = 1;
+        if (pixel_count * spp_per_pass > wavefront_size_limit) {
+            // Unless specified by the user, reduce the samples per pass first
+            if (m_samples_per_pass == (uint32_t) -1) {
+                size_t max_spp = std::max(wavefront_size_limit / pixel_count,
+                                          (size_t) 1);
+                while (spp_per_pass > max_spp || spp % spp_per_pass != 0)
+                    spp_per_pass--;
+                n_passes = spp / spp_per_pass;
+            }
+
+            // Then split the image into chunks of consecutive pixels
+            chunk_pixels = std::max(wavefront_size_limit / spp_per_pass,
+                                    (size_t) 1);
+            if (chunk_pixels < pixel_count) {
+                n_chunks = (uint32_t) ((pixel_count + chunk_pixels - 1) / chunk_pixels);
+                chunk_pixels = (pixel_count + n_chunks - 1) / n_chunks;
+            } else {
+                chunk_pixels = pixel_count;
+            }
+
+            Log(Info, "Wavefront limited to %zu samples, rendering %u pass%s "
+                      "of %u sample%s over %u image chunk%s.",
+                wavefront_size_limit, n_passes, n_passes == 1 ? "" : "es",
+                spp_per_pass, spp_per_pass == 1 ? "" : "s", n_chunks,
+                n_chunks == 1 ? "" : "s");
+        }
+
+        size_t wavefront_size = chunk_pixels * (size_t) spp_per_pass;
         if (wavefront_size > wavefront_size_limit)
             Throw("Tried to perform a %s-based rendering with a total sample "
-                  "count of %zu, which exceeds 2^%zu = %zu (the upper limit "
-                  "for this backend). Please use fewer samples per pixel or "
-                  "render using multiple passes.",
+                  "count of %zu, which exceeds the limit of %zu samples per "
+                  "wavefront. Please use fewer samples per pass.",
                   dr::is_llvm_v<Float> ? "LLVM JIT" : "OptiX",
-                  wavefront_size, dr::log2i(wavefront_size_limit + 1),
-                  wavefront_size_limit);
+                  wavefront_size, wavefront_size_limit);
+
+        /* Trace the passes once as a symbolic loop, which launches a
+           single kernel per image chunk */
+        bool record_passes = m_record_passes && n_passes > 1 &&
+                             jit_flag(JitFlag::LoopRecord),
+             single_launch = n_chunks == 1 && (n_passes == 1 || record_passes);
+
+        if (record_passes)
+            Log(Info, "Recording %u passes into a single kernel.", n_passes);
+
+        if (!single_launch && !evaluate) {
+            Log(Warn, "render(): forcing 'evaluate=true' since multi-pass "
+                      "rendering was requested.");
+            evaluate = true;
+        }
 
         // Inform the sampler about the passes (needed in vectorized modes)
         sampler->set_samples_per_wavefront(spp_per_pass);
 
-        // Seed the underlying random number generators, if applicable
-        sampler->seed(seed, (uint32_t) wavefront_size);
-
         // Allocate a large image block that will receive the entire rendering
         ref<ImageBlock> block = film->create_block();
         block->set_offset(film->crop_offset());
@@ -231,50 +327,94 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         // Only use the ImageBlock coalescing feature when rendering enough samples
         block->set_coalesce(block->coalesce() && spp_per_pass >= 4);
 
-        // Compute discrete sample position
-        UInt32 idx = dr::arange<UInt32>((uint32_t) wavefront_size);
+        // Scale factor that will be applied to ray differentials
+        ScalarFloat diff_scale_factor = dr::rsqrt((ScalarFloat) spp);
+
+        Timer timer;
+        std::unique_ptr<Float[]> aovs(new Float[n_channels]);
 
-        // Try to avoid a division by an unknown constant if we can help it
-        uint32_t log_spp_per_pass = dr::log2i(spp_per_pass);
-        if ((1u << log_spp_per_pass) == spp_per_pass)
-            idx >>= dr::opaque<UInt32>(log_spp_per_pass);
-        else
-            idx /= dr::opaque<UInt32>(spp_per_pass);
+        for (uint32_t chunk = 0; chunk < n_chunks && !should_stop(); ++chunk) {
+            size_t chunk_start = chunk * chunk_pixels,
+                   chunk_size  = std::min(chunk_pixels, pixel_count - chunk_start);
+            wavefront_size = chunk_size * (size_t) spp_per_pass;
 
-        // Compute the position on the image plane
-        Vector2u pos;
-        pos.y() = idx / film_size[0];
-        pos.x() = dr::fnmadd(film_size[0], pos.y(), idx);
+            /* Seed the underlying random number generators, if applicable.
+               The seed is opaque, so that all chunks share the same kernel */
+            sampler->seed(n_chunks > 1 ? seed * n_chunks + chunk : seed,
+                          (uint32_t) wavefront_size);
 
-        if (film->sample_border())
-            pos -= film->rfilter()->border_size();
+            // Compute discrete sample position
+            UInt32 idx = dr::arange<UInt32>((uint32_t) wavefront_size);
 
-        pos += film->crop_offset();
+            // Try to avoid a division by an unknown constant if we can help it
+            uint32_t log_spp_per_pass = dr::log2i(spp_per_pass);
+            if ((1u << log_spp_per_pass) == spp_per_pass)
+                idx >>= dr::opaque<UInt32>(log_spp_per_pass);
+            else
+                idx /= dr::opaque<UInt32>(spp_per_pass);
 
-        // Cast to floating point, random offset is added in \ref render_sample()
-        Vector2f pos_f = Vector2f(pos);
+            if (n_chunks > 1)
+                idx += dr::opaque<UInt32>((uint32_t) chunk_start);
 
-        // Scale factor that will be applied to ray differentials
-        ScalarFloat diff_scale_factor = dr::rsqrt((ScalarFloat) spp);
+            // Compute the position on the image plane
+            Vector2u pos;
+            pos.y() = idx / film_size[0];
+            pos.x() = dr::fnmadd(film_size[0], pos.y(), idx);
 
-        Timer timer;
-        std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+            if (film->sample_border())
+                pos -= film->rfilter()->border_size();
 
-        // Potentially render multiple passes
-        for (size_t i = 0; i < n_passes; i++) {
-            render_sample(scene, sensor, sampler, block,
-                          aovs.get(), pos, diff_scale_factor);
+            pos += film->crop_offset();
 
-            if (n_passes > 1) {
-                sampler->advance(); // Will trigger a kernel launch of size 1
-                sampler->schedule_state();
-                dr::eval(block->tensor());
+            // Cast to floating point, random offset is added in \ref render_sample()
+            Vector2f pos_f = Vector2f(pos);
+
+            if (record_passes) {
+                UInt32 pass = dr::zeros<UInt32>(wavefront_size);
+
+                dr::Loop<Mask> loop("Render passes", pass);
+                sampler->loop_put(loop);
+                loop.init();
+
+                while (loop(pass < dr::opaque<UInt32>(n_passes))) {
+                    render_sample(scene, sensor, sampler, block,
+                                  aovs.get(), pos_f, diff_scale_factor);
+                    sampler->advance();
+                    pass++;
+                }
+
+                if (n_chunks > 1) {
+                    sampler->schedule_state();
+                    dr::eval(block->tensor());
+                }
+                continue;
+            }
+
+            // Potentially render multiple passes
+            for (size_t i = 0; i < n_passes; i++) {
+                render_sample(scene, sensor, sampler, block,
+                              aovs.get(), pos_f, diff_scale_factor);
+
+                if (n_passes > 1 || n_chunks > 1) {
+                    sampler->advance(); // Will trigger a kernel launch of size 1
+                    sampler->schedule_state();
+
+                    // Merge the passes one at a time so that previews show them
+                    if (m_preview_callback) {
+                        film->put_block(block);
+                        film->schedule_storage();
+                        block->clear();
+                    }
+
+                    dr::eval(block->tensor());
+                    preview(film);
+                }
             }
         }
 
         film->put_block(block);
 
-        if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
+        if (single_launch && jit_flag(JitFlag::VCallRecord) &&
             jit_flag(JitFlag::LoopRecord)) {
             Log(Info, "Computation graph recorded. (took %s)",
                 util::time_string((float) timer.reset(), true));
@@ -290,7 +430,7 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         if (evaluate) {
             dr::eval();
 
-            if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
+            if (single_launch && jit_flag(JitFlag::VCallRecord) &&
                 jit_flag(JitFlag::LoopRecord)) {
                 Log(Info, "Code generation finished. (took %s)",
                     util::time_string((float) timer.value(), true));
@@ -443,6 +583,17 @@ SamplingIntegrator<Float, Spectrum>::sample(const Scene * /* scene */,
     NotImplementedError("sample");
 }
 
+MI_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
+SamplingIntegrator<Float, Spectrum>::sample_primary(const Scene *scene,
+                                                    Sampler *sampler,
+                                                    const RayDifferential3f &ray,
+                                                    const SurfaceInteraction3f & /* si */,
+                                                    const Medium *medium,
+                                                    Float *aovs,
+                                                    Mask active) const {
+    return sample(scene, sampler, ray, medium, aovs, active);
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Properties &props)
@@ -462,10 +613,82 @@ MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Pro
         Throw("\"rr_depth\" must be set to a value greater than zero!");
 
     m_rr_depth = (uint32_t) rr_depth;
+
+    m_adrrs = false;
+    m_adrrs_window = 5.f;
+    m_adrrs_max_split = 8;
 }
 
 MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::~MonteCarloIntegrator() { }
 
+MI_VARIANT void MonteCarloIntegrator<Float, Spectrum>::init_guiding(const Properties &props) {
+    bool guiding = props.get<bool>("guiding", false);
+
+    std::string rr_mode = props.string("rr_mode", "throughput");
+    if (rr_mode == "adrrs")
+        m_adrrs = true;
+    else if (rr_mode != "throughput")
+        Throw("Invalid \"rr_mode\" value \"%s\", must be one of: "
+              "\"throughput\", \"adrrs\"", rr_mode);
+
+    m_adrrs_window = props.get<ScalarFloat>("adrrs_window", 5.f);
+    if (!(m_adrrs_window > 1.f))
+        Throw("\"adrrs_window\" must be larger than 1!");
+
+    int max_split = props.get<int>("adrrs_max_split", 8);
+    if (max_split < 1)
+        Throw("\"adrrs_max_split\" must be set to a value greater than zero!");
+    m_adrrs_max_split = (uint32_t) max_split;
+
+    if (guiding || m_adrrs) {
+        m_guide = new SDTree(props);
+        m_guide->set_guided_sampling(guiding);
+    }
+}
+
+MI_VARIANT typename MonteCarloIntegrator<Float, Spectrum>::TensorXf
+MonteCarloIntegrator<Float, Spectrum>::render(Scene *scene,
+                                              Sensor *sensor,
+                                              uint32_t seed,
+                                              uint32_t spp,
+                                              bool develop,
+                                              bool evaluate) {
+    if (!m_guide)
+        return Base::render(scene, sensor, seed, spp, develop, evaluate);
+
+    if (spp == 0)
+        spp = sensor->sampler()->sample_count();
+
+    /* Training passes with 1, 2, 4, .. samples per pixel. Each of them
+       records into the distribution learned by its predecessors. They are
+       part of the sample budget, the final pass renders the remainder. */
+    m_guide->reset(scene->bbox());
+    uint32_t training_spp = (uint32_t) (spp * m_guide->budget()),
+             pass_spp = 1, iteration = 0, spent_spp = 0;
+
+    while (pass_spp <= training_spp && !this->m_stop) {
+        Log(Info, "Path guiding: training pass %u (%u sample%s per pixel)",
+            iteration + 1, pass_spp, pass_spp == 1 ? "" : "s");
+
+        m_guide->set_training(true);
+        Base::render(scene, sensor, seed + ++iteration, pass_spp,
+                     false /* develop */, true /* evaluate */);
+        m_guide->set_training(false);
+        m_guide->refine();
+
+        training_spp -= pass_spp;
+        spent_spp += pass_spp;
+        pass_spp *= 2;
+    }
+
+    TensorXf result = Base::render(scene, sensor, seed, spp - spent_spp,
+                                   develop, evaluate);
+
+    // Restore the sample count for subsequent calls with spp == 0
+    sensor->sampler()->set_sample_count(spp);
+    return result;
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT AdjointIntegrator<Float, Spectrum>::AdjointIntegrator(const Properties &props)
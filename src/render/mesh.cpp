@@ -29,6 +29,33 @@ MI_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
 
     m_face_normals = props.get<bool>("face_normals", false);
     m_flip_normals = props.get<bool>("flip_normals", false);
+
+    /* When set to ``true``, vertex normals are stored using 32-bit octahedral
+       encoding and texture coordinates in half precision, respectively. This
+       reduces the storage cost of these attributes by a factor of 3 and 2.
+       Default: ``false`` */
+    m_compact_normals   = props.get<bool>("compact_normals", false);
+    m_compact_texcoords = props.get<bool>("compact_texcoords", false);
+
+    /* When set to ``true``, triangles are sampled by area using an alias
+       table, which replaces the binary search over the CDF by a constant
+       number of lookups. Default: ``false`` */
+    m_alias_sampling = props.get<bool>("alias_sampling", false);
+
+    /* Strategy used when sampling directions towards the mesh (e.g. when it
+       is an area emitter): one of "area", "solid_angle" or
+       "projected_solid_angle". Default: "area" */
+    std::string emitter_sampling = props.string("emitter_sampling", "area");
+    if (emitter_sampling == "area")
+        m_emitter_sampling = EmitterSampling::Area;
+    else if (emitter_sampling == "solid_angle")
+        m_emitter_sampling = EmitterSampling::SolidAngle;
+    else if (emitter_sampling == "projected_solid_angle")
+        m_emitter_sampling = EmitterSampling::ProjectedSolidAngle;
+    else
+        Throw("Invalid emitter sampling strategy \"%s\", must be one of: "
+              "\"area\", \"solid_angle\" or \"projected_solid_angle\"!",
+              emitter_sampling);
 }
 
 MI_VARIANT
@@ -52,6 +79,7 @@ Mesh<Float, Spectrum>::Mesh(const std::string &name, ScalarSize vertex_count,
 
 MI_VARIANT
 void Mesh<Float, Spectrum>::initialize() {
+    update_attribute_encoding();
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
     m_vertex_positions_ptr = m_vertex_positions.data();
     m_faces_ptr = m_faces.data();
@@ -80,11 +108,17 @@ MI_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std::string> &keys) {
+    if (keys.empty() || string::contains(keys, "vertex_normals") ||
+        string::contains(keys, "vertex_texcoords"))
+        update_attribute_encoding();
+
     if (keys.empty() || string::contains(keys, "vertex_positions")) {
         recompute_bbox();
 
-        if (has_vertex_normals())
+        if (has_vertex_normals()) {
             recompute_vertex_normals();
+            update_attribute_encoding();
+        }
 
         if (!m_area_pmf.empty())
             m_area_pmf = DiscreteDistribution<Float>();
@@ -128,9 +162,12 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index) const {
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) const {
+    FloatStorage normals   = decoded_vertex_normals(),
+                 texcoords = decoded_vertex_texcoords();
+
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
-    auto&& vertex_normals   = dr::migrate(m_vertex_normals, AllocType::Host);
-    auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    auto&& vertex_normals   = dr::migrate(normals, AllocType::Host);
+    auto&& vertex_texcoords = dr::migrate(texcoords, AllocType::Host);
     auto&& faces = dr::migrate(m_faces, AllocType::Host);
 
     std::vector<std::pair<std::string, MeshAttribute>> vertex_attributes;
@@ -259,6 +296,13 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
         Throw("Storing new normals in a Mesh that didn't have normals at "
               "construction time is not implemented yet.");
 
+    /* Compact normals are recomputed in single precision and encoded again
+       by the next call to initialize() or parameters_changed() */
+    if (!m_vertex_normals_oct.empty()) {
+        m_vertex_normals = dr::zeros<FloatStorage>(m_vertex_count * 3);
+        m_vertex_normals_oct = DynamicBuffer<UInt32>();
+    }
+
     /* Weighting scheme based on "Computing Vertex Normals from Polygonal Facets"
        by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3 */
 
@@ -345,6 +389,84 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
     }
 }
 
+MI_VARIANT void Mesh<Float, Spectrum>::update_attribute_encoding() {
+    if (m_compact_normals && !m_vertex_normals.empty()) {
+        if (dr::grad_enabled(m_vertex_normals))
+            Throw("Mesh \"%s\": compact vertex normals are not differentiable!", m_name);
+
+        auto&& vertex_normals = dr::migrate(m_vertex_normals, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        const InputFloat *ptr = vertex_normals.data();
+        std::unique_ptr<uint32_t[]> packed(new uint32_t[m_vertex_count]);
+        for (ScalarSize i = 0; i < m_vertex_count; ++i)
+            packed[i] = encode_octahedral(dr::load<InputNormal3f>(ptr + 3 * i));
+
+        m_vertex_normals_oct =
+            dr::load<DynamicBuffer<UInt32>>(packed.get(), m_vertex_count);
+        m_vertex_normals = FloatStorage();
+    } else if (!m_compact_normals && !m_vertex_normals_oct.empty()) {
+        m_vertex_normals = decoded_vertex_normals();
+        m_vertex_normals_oct = DynamicBuffer<UInt32>();
+    }
+
+    if (m_compact_texcoords && !m_vertex_texcoords.empty()) {
+        if (dr::grad_enabled(m_vertex_texcoords))
+            Throw("Mesh \"%s\": compact texture coordinates are not differentiable!", m_name);
+
+        auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        const InputFloat *ptr = vertex_texcoords.data();
+        std::unique_ptr<uint32_t[]> packed(new uint32_t[m_vertex_count]);
+        for (ScalarSize i = 0; i < m_vertex_count; ++i)
+            packed[i] = encode_half2(ptr[2 * i], ptr[2 * i + 1]);
+
+        m_vertex_texcoords_half =
+            dr::load<DynamicBuffer<UInt32>>(packed.get(), m_vertex_count);
+        m_vertex_texcoords = FloatStorage();
+    } else if (!m_compact_texcoords && !m_vertex_texcoords_half.empty()) {
+        m_vertex_texcoords = decoded_vertex_texcoords();
+        m_vertex_texcoords_half = DynamicBuffer<UInt32>();
+    }
+}
+
+MI_VARIANT typename Mesh<Float, Spectrum>::FloatStorage
+Mesh<Float, Spectrum>::decoded_vertex_normals() const {
+    if (m_vertex_normals_oct.empty())
+        return m_vertex_normals;
+
+    auto&& packed = dr::migrate(m_vertex_normals_oct, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    const uint32_t *ptr = packed.data();
+    std::unique_ptr<InputFloat[]> normals(new InputFloat[m_vertex_count * 3]);
+    for (ScalarSize i = 0; i < m_vertex_count; ++i)
+        dr::store(normals.get() + 3 * i, decode_octahedral(ptr[i]));
+
+    return dr::load<FloatStorage>(normals.get(), m_vertex_count * 3);
+}
+
+MI_VARIANT typename Mesh<Float, Spectrum>::FloatStorage
+Mesh<Float, Spectrum>::decoded_vertex_texcoords() const {
+    if (m_vertex_texcoords_half.empty())
+        return m_vertex_texcoords;
+
+    auto&& packed = dr::migrate(m_vertex_texcoords_half, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    const uint32_t *ptr = packed.data();
+    std::unique_ptr<InputFloat[]> texcoords(new InputFloat[m_vertex_count * 2]);
+    for (ScalarSize i = 0; i < m_vertex_count; ++i)
+        dr::store(texcoords.get() + 2 * i, decode_half2(ptr[i]));
+
+    return dr::load<FloatStorage>(texcoords.get(), m_vertex_count * 2);
+}
+
 MI_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
@@ -388,7 +510,8 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
 
     m_area_pmf = DiscreteDistribution<Float>(
         table.data(),
-        m_face_count
+        m_face_count,
+        m_alias_sampling
     );
 }
 
@@ -418,6 +541,9 @@ Mesh<Float, Spectrum>::merge(const Mesh *other) const {
     if (m_emitter)
         props.set_object("emitter", (Object *) m_emitter.get());
     props.set_bool("face_normals", m_face_normals);
+    props.set_bool("compact_normals", m_compact_normals);
+    props.set_bool("compact_texcoords", m_compact_texcoords);
+    props.set_bool("alias_sampling", m_alias_sampling);
 
     ref<Mesh> result = new Mesh(
         m_name + " + " + other->m_name, m_vertex_count + other->vertex_count(),
@@ -429,11 +555,11 @@ Mesh<Float, Spectrum>::merge(const Mesh *other) const {
 
     if (has_vertex_normals())
         result->m_vertex_normals =
-            dr::concat(m_vertex_normals, other->m_vertex_normals);
+            dr::concat(decoded_vertex_normals(), other->decoded_vertex_normals());
 
     if (has_vertex_texcoords())
         result->m_vertex_texcoords =
-            dr::concat(m_vertex_texcoords, other->m_vertex_texcoords);
+            dr::concat(decoded_vertex_texcoords(), other->decoded_vertex_texcoords());
 
     result->m_faces = dr::concat(m_faces, other->m_faces);
     result->m_bbox = m_bbox;
@@ -475,7 +601,8 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
                  props, false, false);
     mesh->m_faces = m_faces;
 
-    auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    FloatStorage texcoords = decoded_vertex_texcoords();
+    auto&& vertex_texcoords = dr::migrate(texcoords, AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
         dr::sync_thread();
 
@@ -522,19 +649,27 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
         m_area_pmf.sample_reuse(sample.y(), active);
 
     Vector3u fi = face_indices(face_idx, active);
+    Point2f b = warp::square_to_uniform_triangle(sample);
+
+    PositionSample3f ps = face_position_sample(fi, b, active);
+    ps.time  = time;
+    ps.pdf   = m_area_pmf.normalization();
+    ps.delta = false;
+
+    return ps;
+}
 
+MI_VARIANT typename Mesh<Float, Spectrum>::PositionSample3f
+Mesh<Float, Spectrum>::face_position_sample(const Vector3u &fi, const Point2f &b,
+                                            Mask active) const {
     Point3f p0 = vertex_position(fi[0], active),
             p1 = vertex_position(fi[1], active),
             p2 = vertex_position(fi[2], active);
 
     Vector3f e0 = p1 - p0, e1 = p2 - p0;
-    Point2f b = warp::square_to_uniform_triangle(sample);
 
-    PositionSample3f ps;
-    ps.p     = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
-    ps.time  = time;
-    ps.pdf   = m_area_pmf.normalization();
-    ps.delta = false;
+    PositionSample3f ps = dr::zeros<PositionSample3f>();
+    ps.p = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
 
     if (has_vertex_texcoords()) {
         Point2f uv0 = vertex_texcoord(fi[0], active),
@@ -566,6 +701,228 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
     return ps;
 }
 
+/* Triangles subtending a smaller solid angle are sampled by area, since the
+   spherical triangle computations become numerically unstable. Larger ones
+   (i.e. when the reference point nearly lies on the triangle) suffer from the
+   same problem. */
+static constexpr float SphericalSamplingMinSolidAngle = 3e-4f;
+static constexpr float SphericalSamplingMaxSolidAngle = 6.22f;
+
+/**
+ * \brief Spherical triangle subtended by a mesh face as seen from a reference
+ * point, with routines for uniform sampling by solid angle.
+ *
+ * Based on "Stratified Sampling of Spherical Triangles" by James Arvo
+ * (SIGGRAPH 1995), using the formulation of PBRT-v4, which also provides the
+ * inverse mapping. The first sample dimension selects the sub-triangle area
+ * and the second one the position along the arc starting at vertex \c b.
+ */
+template <typename Vector3f> struct SphericalTriangle {
+    using Float   = dr::value_t<Vector3f>;
+    using Point2f = Point<Float, 2>;
+
+    /// Unit directions towards the triangle vertices
+    Vector3f a, b, c;
+    /// Unit normals of the great circles through the triangle edges
+    Vector3f n_ab, n_bc, n_ca;
+    /// Interior angles at the vertices
+    Float alpha, beta, gamma;
+
+    SphericalTriangle(const Vector3f &a, const Vector3f &b, const Vector3f &c)
+        : a(a), b(b), c(c) {
+        n_ab  = dr::normalize(dr::cross(a, b));
+        n_bc  = dr::normalize(dr::cross(b, c));
+        n_ca  = dr::normalize(dr::cross(c, a));
+        alpha = dr::unit_angle(n_ab, -n_ca);
+        beta  = dr::unit_angle(n_bc, -n_ab);
+        gamma = dr::unit_angle(n_ca, -n_bc);
+    }
+
+    /// Solid angle subtended by the triangle (NaN for degenerate triangles)
+    Float solid_angle() const { return alpha + beta + gamma - dr::Pi<Float>; }
+
+    /// Map a uniform sample onto a direction within the triangle
+    Vector3f sample(const Point2f &u) const {
+        // Sample the area of the sub-triangle and find the matching vertex c'
+        Float area_pi = dr::lerp(dr::Pi<Float>, alpha + beta + gamma, u.x());
+
+        auto [sin_alpha, cos_alpha] = dr::sincos(alpha);
+        auto [sin_area, cos_area]   = dr::sincos(area_pi);
+
+        Float sin_phi = sin_area * cos_alpha - cos_area * sin_alpha,
+              cos_phi = cos_area * cos_alpha + sin_area * sin_alpha,
+              k1      = cos_phi + cos_alpha,
+              k2      = sin_phi - sin_alpha * dr::dot(a, b);
+
+        Float cos_bp = (k2 + dr::fmsub(k2, cos_phi, k1 * sin_phi) * cos_alpha) /
+                       (dr::fmadd(k2, sin_phi, k1 * cos_phi) * sin_alpha);
+        cos_bp = dr::clamp(cos_bp, -1.f, 1.f);
+
+        Vector3f cp = dr::fmadd(a, cos_bp, dr::safe_sqrt(1.f - dr::sqr(cos_bp)) *
+                                dr::normalize(dr::fnmadd(a, dr::dot(c, a), c)));
+
+        // Sample a direction along the arc between b and c'
+        Float cos_theta = 1.f - u.y() * (1.f - dr::dot(cp, b)),
+              sin_theta = dr::safe_sqrt(1.f - dr::sqr(cos_theta));
+
+        return dr::fmadd(b, cos_theta, sin_theta *
+                         dr::normalize(dr::fnmadd(b, dr::dot(cp, b), cp)));
+    }
+
+    /// Inverse of \ref sample()
+    Point2f invert(const Vector3f &w) const {
+        // Find the vertex c' on the arc between a and c
+        Vector3f cp = dr::normalize(dr::cross(dr::cross(b, w), dr::cross(c, a)));
+        dr::masked(cp, dr::dot(cp, a + c) < 0.f) = -cp;
+
+        // Relative area of the sub-triangle (a, b, c')
+        Vector3f n_cpb = dr::normalize(dr::cross(cp, b)),
+                 n_acp = dr::normalize(dr::cross(a, cp));
+        Float area = alpha + dr::unit_angle(n_ab, n_cpb) +
+                     dr::unit_angle(n_acp, -n_cpb) - dr::Pi<Float>;
+        Float u0 = area / solid_angle();
+        u0 = dr::select(dr::dot(a, cp) > 0.99999847691f || !dr::isfinite(u0),
+                        0.f, u0);
+
+        Float u1 = (1.f - dr::dot(w, b)) / (1.f - dr::dot(cp, b));
+
+        return { dr::clamp(u0, 0.f, 1.f), dr::clamp(u1, 0.f, 1.f) };
+    }
+
+    /**
+     * \brief Bilinear approximation of the cosine foreshortening at a
+     * reference point with normal \c n over the sample space of \ref sample()
+     *
+     * Returns the four corner values, normalized to a unit integral. A zero
+     * normal (e.g. for medium interactions) produces a uniform density.
+     */
+    std::array<Float, 4> cosine_weights(const Vector3f &n) const {
+        Float w_a = dr::maximum(dr::abs_dot(n, a), .01f),
+              w_b = dr::maximum(dr::abs_dot(n, b), .01f),
+              w_c = dr::maximum(dr::abs_dot(n, c), .01f),
+              inv_norm = 4.f / (2.f * w_b + w_a + w_c);
+
+        // The corners u.y() == 0 both map onto vertex b
+        return { w_b * inv_norm, w_b * inv_norm, w_a * inv_norm, w_c * inv_norm };
+    }
+};
+
+MI_VARIANT typename Mesh<Float, Spectrum>::DirectionSample3f
+Mesh<Float, Spectrum>::sample_direction(const Interaction3f &it,
+                                        const Point2f &sample_,
+                                        Mask active) const {
+    MI_MASK_ARGUMENT(active);
+
+    if (m_emitter_sampling == EmitterSampling::Area)
+        return Base::sample_direction(it, sample_, active);
+
+    ensure_pmf_built();
+
+    using Index = dr::replace_scalar_t<Float, ScalarIndex>;
+    Index face_idx;
+    Point2f sample = sample_;
+
+    std::tie(face_idx, sample.y()) =
+        m_area_pmf.sample_reuse(sample.y(), active);
+
+    Vector3u fi = face_indices(face_idx, active);
+
+    Point3f p0 = vertex_position(fi[0], active),
+            p1 = vertex_position(fi[1], active),
+            p2 = vertex_position(fi[2], active);
+
+    SphericalTriangle<Vector3f> tri(dr::normalize(p0 - it.p),
+                                    dr::normalize(p1 - it.p),
+                                    dr::normalize(p2 - it.p));
+
+    Float solid_angle = tri.solid_angle();
+    Mask spherical = solid_angle >= SphericalSamplingMinSolidAngle &&
+                     solid_angle <= SphericalSamplingMaxSolidAngle;
+
+    // Optionally account for the cosine factor at the reference point
+    Point2f sample_sph = sample;
+    Float pdf_warp = 1.f;
+    if (m_emitter_sampling == EmitterSampling::ProjectedSolidAngle) {
+        auto [w00, w10, w01, w11] = tri.cosine_weights(it.n);
+        std::tie(sample_sph, pdf_warp) =
+            warp::square_to_bilinear(w00, w10, w01, w11, sample);
+    }
+
+    /* Compute barycentric coordinates of the sampled direction by
+       intersecting it with the triangle */
+    Vector3f d  = tri.sample(sample_sph),
+             e0 = p1 - p0,
+             e1 = p2 - p0,
+             s  = it.p - p0,
+             s1 = dr::cross(d, e1);
+
+    Float inv_det = dr::rcp(dr::dot(s1, e0));
+    Point2f b(dr::clamp(dr::dot(s, s1) * inv_det, 0.f, 1.f),
+              dr::clamp(dr::dot(d, dr::cross(s, e0)) * inv_det, 0.f, 1.f));
+    Float b_sum = b.x() + b.y();
+    dr::masked(b, b_sum > 1.f) = b / b_sum;
+
+    b = dr::select(spherical, b, warp::square_to_uniform_triangle(sample));
+
+    DirectionSample3f ds(face_position_sample(fi, b, active));
+    ds.time       = it.time;
+    ds.delta      = false;
+    ds.prim_index = face_idx;
+    ds.d          = ds.p - it.p;
+
+    Float dist_squared = dr::squared_norm(ds.d);
+    ds.dist = dr::sqrt(dist_squared);
+    ds.d /= ds.dist;
+
+    // Fall back to the density of area sampling where necessary
+    Float x = dist_squared / dr::abs_dot(ds.d, ds.n);
+    ds.pdf = dr::select(
+        spherical,
+        m_area_pmf.eval_pmf_normalized(face_idx, active) * pdf_warp / solid_angle,
+        m_area_pmf.normalization() * dr::select(dr::isfinite(x), x, 0.f));
+
+    return ds;
+}
+
+MI_VARIANT Float Mesh<Float, Spectrum>::pdf_direction(const Interaction3f &it,
+                                                       const DirectionSample3f &ds,
+                                                       Mask active) const {
+    MI_MASK_ARGUMENT(active);
+
+    if (m_emitter_sampling == EmitterSampling::Area)
+        return Base::pdf_direction(it, ds, active);
+
+    ensure_pmf_built();
+
+    Vector3u fi = face_indices(ds.prim_index, active);
+
+    Point3f p0 = vertex_position(fi[0], active),
+            p1 = vertex_position(fi[1], active),
+            p2 = vertex_position(fi[2], active);
+
+    SphericalTriangle<Vector3f> tri(dr::normalize(p0 - it.p),
+                                    dr::normalize(p1 - it.p),
+                                    dr::normalize(p2 - it.p));
+
+    Float solid_angle = tri.solid_angle();
+    Mask spherical = solid_angle >= SphericalSamplingMinSolidAngle &&
+                     solid_angle <= SphericalSamplingMaxSolidAngle;
+
+    Float pdf = m_area_pmf.eval_pmf_normalized(ds.prim_index, active) / solid_angle;
+
+    if (m_emitter_sampling == EmitterSampling::ProjectedSolidAngle) {
+        auto [w00, w10, w01, w11] = tri.cosine_weights(it.n);
+        pdf *= warp::square_to_bilinear_pdf(w00, w10, w01, w11,
+                                            tri.invert(ds.d));
+    }
+
+    Float dp = dr::abs_dot(ds.d, ds.n);
+    Float pdf_area = m_area_pmf.normalization() *
+                     dr::select(dr::neq(dp, 0.f), (ds.dist * ds.dist) / dp, 0.f);
+
+    return dr::select(spherical, pdf, pdf_area);
+}
+
 MI_VARIANT
 
 typename Mesh<Float, Spectrum>::SurfaceInteraction3f
@@ -1096,9 +1453,14 @@ MI_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
 MI_VARIANT size_t Mesh<Float, Spectrum>::vertex_data_bytes() const {
     size_t vertex_data_bytes = 3 * sizeof(InputFloat);
 
-    if (has_vertex_normals())
+    if (!m_vertex_normals_oct.empty())
+        vertex_data_bytes += sizeof(uint32_t);
+    else if (has_vertex_normals())
         vertex_data_bytes += 3 * sizeof(InputFloat);
-    if (has_vertex_texcoords())
+
+    if (!m_vertex_texcoords_half.empty())
+        vertex_data_bytes += sizeof(uint32_t);
+    else if (has_vertex_texcoords())
         vertex_data_bytes += 2 * sizeof(InputFloat);
 
     for (const auto&[name, attribute]: m_mesh_attributes)
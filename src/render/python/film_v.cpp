@@ -52,6 +52,14 @@ public:
         PYBIND11_OVERRIDE_PURE(ref<ImageBlock>, Film, create_block, size, normalize, border);
     }
 
+    void prepare_blocks(const ScalarPoint2i &offset, const ScalarVector2u &size,
+                        uint32_t block_size, uint32_t passes,
+                        uint32_t partition_index = 0,
+                        uint32_t partition_count = 1) override {
+        PYBIND11_OVERRIDE(void, Film, prepare_blocks, offset, size, block_size,
+                          passes, partition_index, partition_count);
+    }
+
     std::string to_string() const override {
         PYBIND11_OVERRIDE_PURE(std::string, Film, to_string,);
     }
@@ -79,6 +87,7 @@ MI_PY_EXPORT(Film) {
         .def_method(Film, bitmap, "raw"_a = false)
         .def_method(Film, write, "path"_a)
         .def_method(Film, sample_border)
+        .def_method(Film, streams_output)
         // Make sure to return a copy of those members as they might also be
         // exposed by-references via `mi.traverse`. In which case the return
         // policy of `mi.traverse` might overrule the ones of those bindings.
@@ -105,6 +114,9 @@ MI_PY_EXPORT(Film) {
             D(Film, prepare_sample))
         .def_method(Film, create_block, "size"_a = ScalarVector2u(0, 0),
                     "normalize"_a = false, "borders"_a = false)
+        .def_method(Film, prepare_blocks, "offset"_a, "size"_a,
+                    "block_size"_a, "passes"_a, "partition_index"_a = 0,
+                    "partition_count"_a = 1)
         .def_method(Film, schedule_storage)
         .def_method(Film, sensor_response_function)
         .def_method(Film, flags);
@@ -247,7 +247,8 @@ MI_PY_EXPORT(Integrator) {
                 return std::make_tuple(spec, mask, aovs);
             },
             "scene"_a, "sampler"_a, "ray"_a, "medium"_a = nullptr,
-            "active"_a = true, D(SamplingIntegrator, sample));
+            "active"_a = true, D(SamplingIntegrator, sample))
+        .def_method(SamplingIntegrator, set_block_partition, "index"_a, "count"_a);
 
     MI_PY_REGISTER_OBJECT("register_integrator", Integrator)
 
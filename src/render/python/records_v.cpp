@@ -37,7 +37,8 @@ MI_PY_EXPORT(DirectionSample) {
         .def_readwrite("d",     &DirectionSample3f::d,     D(DirectionSample, d))
         .def_readwrite("dist",  &DirectionSample3f::dist,  D(DirectionSample, dist))
         .def_readwrite("emitter", &DirectionSample3f::emitter, D(DirectionSample, emitter))
+        .def_readwrite("prim_index", &DirectionSample3f::prim_index, D(DirectionSample, prim_index))
         .def_repr(DirectionSample3f);
 
-    MI_PY_DRJIT_STRUCT(pos, DirectionSample3f, p, n, uv, time, pdf, delta, emitter, d, dist)
+    MI_PY_DRJIT_STRUCT(pos, DirectionSample3f, p, n, uv, time, pdf, delta, emitter, d, dist, prim_index)
 }
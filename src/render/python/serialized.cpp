@@ -0,0 +1,9 @@
+#include <mitsuba/render/serialized.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(serialized) {
+    m.def("convert_serialized", &convert_serialized, "source"_a, "target"_a,
+          "compress"_a = true, "chunk_size"_a = MI_SERIALIZED_CHUNK_SIZE,
+          "compact_normals"_a = false, "compact_texcoords"_a = false,
+          D(convert_serialized));
+}
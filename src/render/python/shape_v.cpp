@@ -148,6 +148,8 @@ MI_PY_EXPORT(Shape) {
         .def_method(Mesh, face_count)
         .def_method(Mesh, has_vertex_normals)
         .def_method(Mesh, has_vertex_texcoords)
+        .def_method(Mesh, has_compact_normals)
+        .def_method(Mesh, has_compact_texcoords)
         .def("write_ply", &Mesh::write_ply, "filename"_a,
              "Export mesh as a binary PLY file")
         .def("add_attribute", &Mesh::add_attribute, "name"_a, "size"_a, "buffer"_a,
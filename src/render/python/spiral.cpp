@@ -10,5 +10,7 @@ MI_PY_EXPORT(Spiral) {
         .def_method(Spiral, max_block_size)
         .def_method(Spiral, block_count)
         .def_method(Spiral, reset)
+        .def_method(Spiral, set_partition, "index"_a, "count"_a)
+        .def_method(Spiral, partition_block_count)
         .def_method(Spiral, next_block);
 }
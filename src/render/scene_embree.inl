@@ -128,8 +128,30 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
         rtcDetachGeometry(s.accel, geo);
     s.geometries.clear();
 
-    for (Shape *shape : m_shapes) {
-        RTCGeometry geom = shape->embree_geometry(embree_device);
+    /* Create and commit the geometries of all shapes in parallel (scalar
+       variants only, since this accesses the shape data buffers). Instances
+       are handled sequentially, as they share the BVH of their shape group. */
+    std::vector<RTCGeometry> geometries(m_shapes.size(), nullptr);
+    if constexpr (!dr::is_jit_v<Float>) {
+        ThreadEnvironment env;
+        dr::parallel_for(
+            dr::blocked_range<size_t>(
+                0, m_shapes.size(),
+                std::max(m_shapes.size() / (4 * embree_threads), (size_t) 1)),
+            [&](const dr::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    if (!m_shapes[i]->is_instance())
+                        geometries[i] = m_shapes[i]->embree_geometry(embree_device);
+                }
+            }
+        );
+    }
+
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        RTCGeometry geom = geometries[i];
+        if (!geom)
+            geom = m_shapes[i]->embree_geometry(embree_device);
         s.geometries.push_back(rtcAttachGeometry(s.accel, geom));
         rtcReleaseGeometry(geom);
     }
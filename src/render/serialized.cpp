@@ -0,0 +1,262 @@
+#include <mitsuba/render/serialized.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/zstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+#include <functional>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Callback that reads the next \c size bytes of a buffer into \c data
+using SerializedReader = std::function<void(uint8_t *data, size_t size)>;
+
+/**
+ * Write a buffer of \c size bytes to \c stream and return its offset. In
+ * compressed mode, the compressed size of every chunk is appended to
+ * \c chunk_sizes. Chunks are produced sequentially by \c read and compressed
+ * in batches that keep all worker threads busy.
+ */
+static uint64_t write_buffer(Stream *stream, size_t size, bool compress,
+                             uint32_t chunk_size, const SerializedReader &read,
+                             std::vector<uint32_t> &chunk_sizes) {
+    if (!compress) {
+        // Align the buffer so that it can be memory-mapped in place
+        size_t padding = (MI_SERIALIZED_PAGE_SIZE -
+                          stream->tell() % MI_SERIALIZED_PAGE_SIZE) %
+                         MI_SERIALIZED_PAGE_SIZE;
+        uint8_t zero[MI_SERIALIZED_PAGE_SIZE] = { };
+        stream->write(zero, padding);
+    }
+
+    uint64_t offset = (uint64_t) stream->tell();
+    size_t chunk_count = (size + chunk_size - 1) / chunk_size,
+           batch_size  = compress ? std::max<size_t>(1, pool_size()) : 1;
+
+    std::unique_ptr<uint8_t[]> input(new uint8_t[batch_size * chunk_size]);
+    std::vector<std::vector<uint8_t>> output(batch_size);
+
+    for (size_t first = 0; first < chunk_count; first += batch_size) {
+        size_t count = std::min(batch_size, chunk_count - first),
+               start = first * chunk_size,
+               end   = std::min(size, (first + count) * chunk_size);
+
+        read(input.get(), end - start);
+
+        if (!compress) {
+            stream->write(input.get(), end - start);
+            continue;
+        }
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, count, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    size_t lo = i * chunk_size,
+                           hi = std::min(lo + chunk_size, end - start);
+                    output[i] = ZStream::compress(input.get() + lo, hi - lo);
+                }
+            }
+        );
+
+        for (size_t i = 0; i < count; ++i) {
+            stream->write(output[i].data(), output[i].size());
+            chunk_sizes.push_back((uint32_t) output[i].size());
+        }
+    }
+
+    return offset;
+}
+
+void convert_serialized(const fs::path &source, const fs::path &target,
+                        bool compress, uint32_t chunk_size,
+                        bool compact_normals, bool compact_texcoords) {
+    auto fail = [&](const std::string &descr) {
+        Throw("Error while converting serialized file \"%s\": %s!",
+              source.string(), descr);
+    };
+
+    if (chunk_size == 0 || chunk_size % sizeof(float) != 0 ||
+        chunk_size > (1u << 30))
+        Throw("convert_serialized(): the chunk size must be a positive "
+              "multiple of four that does not exceed 1 GiB!");
+
+    ref<FileStream> in = new FileStream(source);
+    in->set_byte_order(Stream::ELittleEndian);
+
+    uint16_t format = 0, version = 0;
+    in->read(format);
+    in->read(version);
+
+    if (format != MI_FILEFORMAT_HEADER)
+        fail("encountered an invalid file format");
+    if (version != MI_FILEFORMAT_VERSION_V3 &&
+        version != MI_FILEFORMAT_VERSION_V4)
+        fail(tfm::format("cannot convert files with version %i", version));
+
+    // Read the end-of-file dictionary
+    size_t file_size = in->size();
+    uint32_t mesh_count = 0;
+    in->seek(file_size - sizeof(uint32_t));
+    in->read(mesh_count);
+
+    std::vector<uint64_t> offsets(mesh_count);
+    if (version == MI_FILEFORMAT_VERSION_V4) {
+        in->seek(file_size - sizeof(uint64_t) * mesh_count - sizeof(uint32_t));
+        in->read_array(offsets.data(), mesh_count);
+    } else {
+        std::vector<uint32_t> offsets_v3(mesh_count);
+        in->seek(file_size - sizeof(uint32_t) * (mesh_count + 1));
+        in->read_array(offsets_v3.data(), mesh_count);
+        for (uint32_t i = 0; i < mesh_count; ++i)
+            offsets[i] = offsets_v3[i];
+    }
+
+    Log(Info, "Converting \"%s\" (%i meshes) to \"%s\" ..",
+        source.filename().string(), mesh_count, target.filename().string());
+    Timer timer;
+
+    ref<FileStream> out = new FileStream(target, FileStream::ETruncReadWrite);
+    out->set_byte_order(Stream::ELittleEndian);
+
+    std::vector<uint64_t> offsets_out;
+    for (uint32_t mesh = 0; mesh < mesh_count; ++mesh) {
+        in->seek(offsets[mesh]);
+        in->skip(sizeof(uint16_t) * 2); // Skip the header
+
+        ref<ZStream> zstream = new ZStream(in);
+        zstream->set_byte_order(Stream::ELittleEndian);
+
+        uint32_t flags = 0;
+        zstream->read(flags);
+
+        std::string name;
+        if (version == MI_FILEFORMAT_VERSION_V4) {
+            char ch = 0;
+            while (true) {
+                zstream->read(ch);
+                if (ch == 0)
+                    break;
+                name += ch;
+            }
+        }
+
+        uint64_t vertex_count = 0, face_count = 0;
+        zstream->read(vertex_count);
+        zstream->read(face_count);
+
+        if (vertex_count > 0xFFFFFFFFull)
+            fail("64-bit vertex indices are not supported");
+
+        bool double_precision =
+            flags & (uint32_t) SerializedFlags::DoublePrecision;
+
+        flags &= ~(uint32_t) SerializedFlags::DoublePrecision;
+        flags |= (uint32_t) SerializedFlags::SinglePrecision;
+        if (!compress)
+            flags |= (uint32_t) SerializedFlags::Uncompressed;
+        if (compact_normals && (flags & (uint32_t) SerializedFlags::HasNormals))
+            flags |= (uint32_t) SerializedFlags::OctahedralNormals;
+        if (compact_texcoords && (flags & (uint32_t) SerializedFlags::HasTexcoords))
+            flags |= (uint32_t) SerializedFlags::HalfTexcoords;
+
+        offsets_out.push_back((uint64_t) out->tell());
+        out->write((uint16_t) MI_FILEFORMAT_HEADER);
+        out->write((uint16_t) MI_FILEFORMAT_VERSION_V5);
+        out->write(flags);
+        out->write(vertex_count);
+        out->write(face_count);
+        out->write(chunk_size);
+        size_t table_pos = out->tell();
+        out->write((uint64_t) 0); // Chunk table offset, written below
+        out->write(name.c_str(), name.length() + 1);
+
+        // Reads vertex data, converting double precision values on the fly
+        std::unique_ptr<double[]> temp;
+        SerializedReader read_vertex_data = [&](uint8_t *data, size_t size) {
+            size_t count = size / sizeof(float);
+            if (double_precision) {
+                if (!temp)
+                    temp.reset(new double[chunk_size / sizeof(float)]);
+                float *ptr = (float *) data;
+                for (size_t i = 0; i < count; i += chunk_size / sizeof(float)) {
+                    size_t n = std::min((size_t) chunk_size / sizeof(float), count - i);
+                    zstream->read_array(temp.get(), n);
+                    for (size_t j = 0; j < n; ++j)
+                        ptr[i + j] = (float) temp[j];
+                }
+            } else {
+                zstream->read_array((float *) data, count);
+            }
+        };
+
+        SerializedReader read_indices = [&](uint8_t *data, size_t size) {
+            zstream->read_array((uint32_t *) data, size / sizeof(uint32_t));
+        };
+
+        // Read vertex data and pack it into one 32-bit word per vertex
+        std::vector<float> values;
+        SerializedReader read_normals_oct = [&](uint8_t *data, size_t size) {
+            size_t count = size / sizeof(uint32_t);
+            values.resize(count * 3);
+            read_vertex_data((uint8_t *) values.data(), count * 3 * sizeof(float));
+            for (size_t i = 0; i < count; ++i)
+                ((uint32_t *) data)[i] = encode_octahedral(
+                    dr::load<Normal<float, 3>>(values.data() + 3 * i));
+        };
+
+        SerializedReader read_texcoords_half = [&](uint8_t *data, size_t size) {
+            size_t count = size / sizeof(uint32_t);
+            values.resize(count * 2);
+            read_vertex_data((uint8_t *) values.data(), count * 2 * sizeof(float));
+            for (size_t i = 0; i < count; ++i)
+                ((uint32_t *) data)[i] =
+                    encode_half2(values[2 * i], values[2 * i + 1]);
+        };
+
+        // Buffers in the order in which they are stored in the file
+        std::vector<std::pair<size_t, const SerializedReader *>> buffers;
+        buffers.emplace_back(vertex_count * 3 * sizeof(float), &read_vertex_data);
+        if (flags & (uint32_t) SerializedFlags::OctahedralNormals)
+            buffers.emplace_back(vertex_count * sizeof(uint32_t), &read_normals_oct);
+        else if (flags & (uint32_t) SerializedFlags::HasNormals)
+            buffers.emplace_back(vertex_count * 3 * sizeof(float), &read_vertex_data);
+        if (flags & (uint32_t) SerializedFlags::HalfTexcoords)
+            buffers.emplace_back(vertex_count * sizeof(uint32_t), &read_texcoords_half);
+        else if (flags & (uint32_t) SerializedFlags::HasTexcoords)
+            buffers.emplace_back(vertex_count * 2 * sizeof(float), &read_vertex_data);
+        if (flags & (uint32_t) SerializedFlags::HasColors)
+            buffers.emplace_back(vertex_count * 3 * sizeof(float), &read_vertex_data);
+        buffers.emplace_back(face_count * 3 * sizeof(uint32_t), &read_indices);
+
+        std::vector<uint64_t> buffer_offsets;
+        std::vector<std::vector<uint32_t>> chunk_sizes(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+            buffer_offsets.push_back(write_buffer(out, buffers[i].first, compress,
+                                                  chunk_size, *buffers[i].second,
+                                                  chunk_sizes[i]));
+
+        // Append the chunk table and store its position in the header
+        uint64_t table_offset = (uint64_t) out->tell();
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            out->write(buffer_offsets[i]);
+            out->write_array(chunk_sizes[i].data(), chunk_sizes[i].size());
+        }
+        out->seek(table_pos);
+        out->write(table_offset);
+        out->seek(out->size());
+    }
+
+    // Write the end-of-file dictionary
+    out->write_array(offsets_out.data(), offsets_out.size());
+    out->write(mesh_count);
+    out->close();
+
+    Log(Info, "\"%s\": converted %i meshes (%s in %s)",
+        target.filename().string(), mesh_count,
+        util::mem_string(file_size), util::time_string((float) timer.value()));
+}
+
+NAMESPACE_END(mitsuba)
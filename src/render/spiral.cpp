@@ -7,7 +7,7 @@ NAMESPACE_BEGIN(mitsuba)
 Spiral::Spiral(const Vector2u &size, const Vector2u &offset,
                uint32_t block_size, uint32_t passes)
     : m_size(size), m_offset(offset), m_passes_left(passes),
-      m_block_size(block_size) {
+      m_block_size(block_size), m_partition_index(0), m_partition_count(1) {
 
     m_blocks = (size + (block_size - 1)) / block_size;
     m_block_count = dr::prod(m_blocks);
@@ -23,10 +23,35 @@ void Spiral::reset() {
     m_spiral_size = 1;
 }
 
+void Spiral::set_partition(uint32_t index, uint32_t count) {
+    if (count == 0 || index >= count)
+        Throw("Spiral::set_partition(): invalid partition %u/%u!", index, count);
+    m_partition_index = index;
+    m_partition_count = count;
+}
+
+uint32_t Spiral::partition_block_count() const {
+    if (m_block_count <= m_partition_index)
+        return 0;
+    return (m_block_count - m_partition_index + m_partition_count - 1) /
+           m_partition_count;
+}
+
 std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t> Spiral::next_block() {
-    // Reimplementation of the spiraling block generator by Adam Arbree.
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    // Skip the blocks that belong to other partitions
+    while (true) {
+        auto result = next_block_unlocked();
+        uint32_t block_id = std::get<2>(result);
+        if (block_id == (uint32_t) -1 ||
+            (block_id % m_block_count) % m_partition_count == m_partition_index)
+            return result;
+    }
+}
+
+std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t> Spiral::next_block_unlocked() {
+    // Reimplementation of the spiraling block generator by Adam Arbree.
     if (m_block_counter == m_block_count) {
         if (m_passes_left > 1) {
             --m_passes_left;
@@ -938,3 +938,182 @@ def test22_boundary_test_face_normal(variants_all_ad_rgb):
     ray = mi.Ray3f([0.9, 0.0, -1], [0, 0, 1], 0.0, [])
     B = scene.ray_intersect(ray, mi.RayFlags.BoundaryTest, True).boundary_test
     assert dr.all(B > 1e-1)
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('mode', ['solid_angle', 'projected_solid_angle'])
+def test23_sample_direction_solid_angle(variants_vec_rgb, mode):
+    shape = mi.load_dict({
+        'type' : 'obj',
+        'filename' : 'resources/data/common/meshes/rectangle.obj',
+        'emitter_sampling' : mode
+    })
+
+    n = 100000
+    sampler = mi.load_dict({ 'type': 'independent' })
+    sampler.seed(0, n)
+
+    it = dr.zeros(mi.SurfaceInteraction3f)
+    it.n = mi.Normal3f(0, 0, -1)
+
+    # The density must match pdf_direction(), including the area fallback
+    for p in [[0, 0, 1], [0.5, -0.3, 0.2], [0.2, 0.1, 1000]]:
+        it.p = mi.Point3f(p)
+        ds = shape.sample_direction(it, sampler.next_2d())
+        assert dr.allclose(ds.pdf, shape.pdf_direction(it, ds), rtol=1e-3)
+        assert dr.allclose(dr.mean(dr.abs(ds.p.z)), 0)
+
+    # Estimate the (projected) solid angle of the square seen from its center
+    it.p = mi.Point3f(0, 0, 1)
+    ds = shape.sample_direction(it, sampler.next_2d())
+    cos_theta = dr.abs(ds.d.z)
+
+    assert dr.allclose(dr.mean(1 / ds.pdf), 2 * dr.pi / 3, rtol=1e-2)
+    assert dr.allclose(dr.mean(cos_theta / ds.pdf),
+                       2 * dr.sqrt(2) * dr.atan(1 / dr.sqrt(2)), rtol=1e-2)
+
+    # Solid angle sampling alone makes the first estimator exact
+    if mode == 'solid_angle':
+        assert dr.allclose(1 / ds.pdf, 2 * dr.pi / 3, rtol=1e-3)
+
+
+def test24_invalid_emitter_sampling(variant_scalar_rgb):
+    props = mi.Properties()
+    props['emitter_sampling'] = 'foo'
+    with pytest.raises(RuntimeError, match='emitter sampling'):
+        mi.Mesh("MyMesh", 3, 1, props=props)
+
+
+@pytest.mark.parametrize('features', ['normals', 'uv', 'normals_uv'])
+@pytest.mark.parametrize('compress', [True, False])
+@pytest.mark.parametrize('face_normals', [True, False])
+def test25_convert_serialized(variants_all_rgb, tmp_path, features, compress, face_normals):
+    """Converts .serialized files to the chunked format and compares the meshes"""
+    def test():
+        filename = f"resources/data/tests/serialized/rectangle_{features}.serialized"
+        source = mi.Thread.thread().file_resolver().resolve(filename)
+        target = str(tmp_path / f"rectangle_{features}.serialized")
+
+        # Use tiny chunks so that every buffer consists of several of them
+        mi.convert_serialized(source, target, compress=compress, chunk_size=16)
+
+        to_world = mi.ScalarTransform4f.translate([1, 2, 3]) @ \
+                   mi.ScalarTransform4f.scale([2, 1, 1])
+
+        shapes = [mi.load_dict({
+            "type" : "serialized",
+            "filename" : f,
+            "face_normals" : face_normals,
+            "to_world" : to_world,
+        }) for f in [filename, target]]
+
+        assert shapes[0].has_vertex_normals() == shapes[1].has_vertex_normals()
+        assert shapes[0].has_vertex_texcoords() == shapes[1].has_vertex_texcoords()
+        assert dr.allclose(shapes[0].bbox().min, shapes[1].bbox().min)
+        assert dr.allclose(shapes[0].bbox().max, shapes[1].bbox().max)
+
+        params = [mi.traverse(shape) for shape in shapes]
+        assert dr.all(params[0]['faces'] == params[1]['faces'])
+        for key in ['vertex_positions', 'vertex_normals', 'vertex_texcoords']:
+            assert dr.allclose(params[0][key], params[1][key])
+
+    return fresolver_append_path(test)()
+
+
+@pytest.mark.parametrize('convert', [True, False])
+def test26_compact_attributes(variants_vec_rgb, tmp_path, convert):
+    """Compares meshes with compact normals/texture coordinates to the originals"""
+    def test():
+        filename = "resources/data/tests/serialized/rectangle_normals_uv.serialized"
+        if convert:
+            # Store compact attributes in the file as well
+            source = mi.Thread.thread().file_resolver().resolve(filename)
+            filename = str(tmp_path / "rectangle_compact.serialized")
+            mi.convert_serialized(source, filename, compact_normals=True,
+                                  compact_texcoords=True)
+
+        to_world = mi.ScalarTransform4f.rotate([1, 1, 0], 30) @ \
+                   mi.ScalarTransform4f.scale([2, 1, 1])
+
+        shapes = [mi.load_dict({
+            "type" : "serialized",
+            "filename" : filename,
+            "to_world" : to_world,
+            "compact_normals" : compact,
+            "compact_texcoords" : compact,
+        }) for compact in [False, True]]
+
+        assert not shapes[0].has_compact_normals()
+        assert shapes[1].has_compact_normals()
+        assert shapes[1].has_compact_texcoords()
+        assert shapes[1].has_vertex_normals()
+        assert shapes[1].has_vertex_texcoords()
+
+        index = dr.arange(mi.UInt32, shapes[0].vertex_count())
+        assert dr.allclose(shapes[0].vertex_normal(index),
+                           shapes[1].vertex_normal(index), atol=1e-4)
+        assert dr.allclose(shapes[0].vertex_texcoord(index),
+                           shapes[1].vertex_texcoord(index), atol=1e-3)
+
+        # Single precision values are only exposed after an update
+        params = mi.traverse(shapes[1])
+        assert dr.width(params['vertex_normals']) == 0
+        params['vertex_normals'] = mi.traverse(shapes[0])['vertex_normals']
+        params.update()
+        assert dr.width(params['vertex_normals']) == 0
+        assert dr.allclose(shapes[0].vertex_normal(index),
+                           shapes[1].vertex_normal(index), atol=1e-4)
+
+    return fresolver_append_path(test)()
+
+
+def test27_alias_sampling(variants_vec_rgb):
+    # Two triangles with areas 0.5 and 4.5
+    def make_mesh(alias):
+        props = mi.Properties()
+        props['alias_sampling'] = alias
+        m = mi.Mesh("MyMesh", 6, 2, props=props)
+        params = mi.traverse(m)
+        params['vertex_positions'] = [0, 0, 0, 1, 0, 0, 0, 1, 0,
+                                      2, 0, 0, 5, 0, 0, 2, 3, 0]
+        params['faces'] = [0, 1, 2, 3, 4, 5]
+        params.update()
+        return m
+
+    n = 100000
+    sampler = mi.load_dict({ 'type': 'independent' })
+    sampler.seed(0, n)
+    sample = sampler.next_2d()
+
+    for alias in [False, True]:
+        mesh = make_mesh(alias)
+        ps = mesh.sample_position(0, sample)
+        assert dr.allclose(ps.pdf, 1 / 5)
+        assert dr.allclose(dr.count(ps.p.x < 1.5) / n, 0.1, atol=5e-3)
+
+
+def test28_misaligned_serialized_buffer(variant_scalar_rgb, tmp_path):
+    import struct
+
+    def test():
+        source = mi.Thread.thread().file_resolver().resolve(
+            "resources/data/tests/serialized/rectangle_normals_uv.serialized")
+        target = str(tmp_path / "rectangle_uncompressed.serialized")
+        mi.convert_serialized(source, target, compress=False)
+
+        with open(target, 'rb') as f:
+            data = bytearray(f.read())
+
+        # Header: format, version, flags, vertex/face count, chunk size and
+        # the offset of the buffer table (whose first entry is the positions)
+        assert struct.unpack_from('<HH', data, 0) == (0x041C, 5)
+        table_offset, = struct.unpack_from('<Q', data, 28)
+        positions, = struct.unpack_from('<Q', data, table_offset)
+        struct.pack_into('<Q', data, table_offset, positions + 2)
+        with open(target, 'wb') as f:
+            f.write(data)
+
+        with pytest.raises(RuntimeError, match='multiples of 4 bytes'):
+            mi.load_dict({ "type" : "serialized", "filename" : target })
+
+    return fresolver_append_path(test)()
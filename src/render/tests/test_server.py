@@ -0,0 +1,194 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+import json
+import os
+import shutil
+import subprocess
+
+
+def find_executable():
+    # The executable is either part of the Python package (wheels), or located
+    # in the build directory next to the 'python' folder
+    package = os.path.dirname(mi.__file__)
+    name = 'mitsuba' + ('.exe' if os.name == 'nt' else '')
+    for candidate in [os.path.join(package, name),
+                      os.path.join(package, '..', '..', name)]:
+        if os.path.isfile(candidate):
+            return candidate
+    return shutil.which('mitsuba')
+
+
+class Server:
+    """Render server communicating over the standard input and output"""
+    def __init__(self, output_dir, *args):
+        executable = find_executable()
+        if executable is None:
+            pytest.skip('The mitsuba executable could not be found')
+        self.process = subprocess.Popen(
+            [executable, '-m', mi.variant(), '--server',
+             '--output-dir', str(output_dir), *args],
+            stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL)
+
+    def send(self, line):
+        if not isinstance(line, str):
+            line = json.dumps(line)
+        self.process.stdin.write((line + '\n').encode())
+        self.process.stdin.flush()
+        reply = json.loads(self.process.stdout.readline())
+        if reply['status'] == 'ok' and 'size' in reply:
+            reply['data'] = self.process.stdout.read(reply['size'])
+        return reply
+
+    def close(self):
+        assert self.send({'command': 'quit'})['status'] == 'ok'
+        assert self.process.wait(timeout=30) == 0
+
+
+def write_scene(path, envmap):
+    with open(path, 'w') as f:
+        f.write(f'''<scene version="3.0.0">
+    <integrator type="path">
+        <integer name="max_depth" value="1"/>
+    </integrator>
+    <sensor type="perspective">
+        <film type="hdrfilm">
+            <integer name="width" value="4"/>
+            <integer name="height" value="3"/>
+            <string name="pixel_format" value="rgb"/>
+            <rfilter type="box"/>
+        </film>
+        <sampler type="independent">
+            <integer name="sample_count" value="$spp"/>
+        </sampler>
+    </sensor>
+    <emitter type="envmap">
+        <string name="filename" value="{envmap}"/>
+    </emitter>
+</scene>''')
+
+
+def write_envmap(path, value, size):
+    data = dr.full(mi.Float, value, size * 2 * size * 3)
+    mi.Bitmap(mi.TensorXf(data, [size, 2 * size, 3])).write(str(path))
+
+
+def load_exr(tmpdir, data):
+    path = os.path.join(str(tmpdir), 'streamed.exr')
+    with open(path, 'wb') as f:
+        f.write(data)
+    return mi.TensorXf(mi.Bitmap(path))
+
+
+def test01_protocol_errors(variant_scalar_rgb, tmpdir):
+    # Malformed or invalid requests produce an error reply, but do not
+    # terminate the server
+    server = Server(tmpdir)
+    requests = [
+        '{"scene": ',
+        '{"scene": "a.xml"} trailing',
+        '[1, 2]',
+        '"render"',
+        '{"command": "unknown"}',
+        '{"spp": 4}',
+        '{"scene": "a.xml", "spp": "four"}',
+        '{"scene": 3}',
+    ]
+    for request in requests:
+        reply = server.send(request)
+        assert reply['status'] == 'error'
+        assert len(reply['message']) > 0
+
+    # Escape sequences are decoded
+    reply = server.send('{"scene": "missing\\u0041\\n.xml"}')
+    assert reply['status'] == 'error'
+    assert 'missingA' in reply['message']
+
+    assert server.send({'command': 'clear'}) == {'status': 'ok'}
+    server.close()
+
+
+def test02_render_round_trip(variant_scalar_rgb, tmpdir):
+    write_envmap(tmpdir.join('env.exr'), 0.5, 4)
+    write_scene(tmpdir.join('scene.xml'), 'env.exr')
+    scene_path = str(tmpdir.join('scene.xml'))
+
+    server = Server(tmpdir)
+
+    # The image is streamed back following the reply
+    reply = server.send({'scene': scene_path, 'defines': {'spp': 4}})
+    assert reply['status'] == 'ok'
+    assert reply['width'] == 4 and reply['height'] == 3
+    image = load_exr(tmpdir, reply['data'])
+    assert image.shape == (3, 4, 3)
+
+    ref = mi.render(mi.load_file(scene_path, spp=4), spp=4)
+    assert dr.allclose(image.array, ref.array, rtol=1e-4)
+
+    # ... or written to the output directory
+    reply = server.send({'scene': scene_path, 'defines': {'spp': 4},
+                         'output': 'out.exr'})
+    assert reply['status'] == 'ok'
+    assert os.path.isfile(str(tmpdir.join('out.exr')))
+    image = mi.TensorXf(mi.Bitmap(str(tmpdir.join('out.exr'))))
+    assert dr.allclose(image.array, ref.array, rtol=1e-4)
+
+    server.close()
+
+
+def test03_output_directory(variant_scalar_rgb, tmpdir):
+    write_envmap(tmpdir.join('env.exr'), 0.5, 4)
+    write_scene(tmpdir.join('scene.xml'), 'env.exr')
+    out_dir = tmpdir.mkdir('out')
+
+    server = Server(out_dir)
+    request = {'scene': str(tmpdir.join('scene.xml')), 'defines': {'spp': 1}}
+
+    # Outputs may not escape from the output directory
+    for output in ['../escaped.exr', 'a/../../escaped.exr',
+                   str(tmpdir.join('escaped.exr')), '']:
+        reply = server.send(dict(request, output=output))
+        assert reply['status'] == 'error'
+    assert not os.path.exists(str(tmpdir.join('escaped.exr')))
+
+    reply = server.send(dict(request, output='image.exr'))
+    assert reply['status'] == 'ok'
+    assert os.path.isfile(str(out_dir.join('image.exr')))
+    server.close()
+
+
+def test04_cache_invalidation(variant_scalar_rgb, tmpdir):
+    env_path = tmpdir.join('env.exr')
+    write_envmap(env_path, 0.5, 4)
+    write_scene(tmpdir.join('scene.xml'), 'env.exr')
+    request = {'scene': str(tmpdir.join('scene.xml')), 'defines': {'spp': 1}}
+
+    server = Server(tmpdir)
+    image_1 = load_exr(tmpdir, server.send(request)['data'])
+    assert dr.allclose(image_1.array, 0.5)
+
+    # The unchanged environment map is reused
+    image_2 = load_exr(tmpdir, server.send(request)['data'])
+    assert dr.all(dr.eq(image_1.array, image_2.array))
+
+    # Modifying the file (different size) invalidates the cached object
+    write_envmap(env_path, 2.0, 8)
+    image_3 = load_exr(tmpdir, server.send(request)['data'])
+    assert dr.allclose(image_3.array, 2.0)
+
+    server.close()
+
+
+def test05_refuse_remote_bind(variant_scalar_rgb, tmpdir):
+    executable = find_executable()
+    if executable is None or os.name == 'nt':
+        pytest.skip('The mitsuba executable could not be found')
+
+    # Listening on all interfaces requires --allow-remote
+    result = subprocess.run(
+        [executable, '-m', mi.variant(), '--server', '--socket', '*:0'],
+        stdin=subprocess.DEVNULL, capture_output=True, timeout=30)
+    assert result.returncode != 0
+    assert b'--allow-remote' in result.stdout + result.stderr
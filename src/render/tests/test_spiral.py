@@ -77,3 +77,85 @@ def test03_normal_film(variant_scalar_rgb):
     # Resetting and re-querying the blocks should yield the exact same results.
     s.reset()
     check_first_blocks(extract_blocks(s), expected, n_total=110)
+
+
+def test04_partition(variant_scalar_rgb):
+    f = make_film(318, 322)
+    s = mi.Spiral(f.size(), f.crop_offset(), passes=2)
+    all_blocks = extract_blocks(s)
+    assert len(all_blocks) == 220
+
+    # Interleaved partitions cover every block exactly once, and keep the
+    # block identifiers of the complete traversal
+    ids = []
+    for index in range(3):
+        s = mi.Spiral(f.size(), f.crop_offset(), passes=2)
+        s.set_partition(index, 3)
+        blocks = extract_blocks(s)
+        assert len(blocks) == 2 * s.partition_block_count()
+        for b in blocks:
+            assert (b[2] % s.block_count()) % 3 == index
+        ids += [b[2] for b in blocks]
+
+    assert sorted(ids) == sorted(b[2] for b in all_blocks)
+
+    with pytest.raises(RuntimeError, match='invalid partition'):
+        s.set_partition(3, 3)
+
+
+def test05_render_partitions(variant_scalar_rgb):
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = 64
+    scene_dict['sensor']['film']['height'] = 48
+    scene_dict['sensor']['sampler']['sample_count'] = 4
+    scene = mi.load_dict(scene_dict)
+    integrator = scene.integrator()
+    film = scene.sensors()[0].film()
+
+    integrator.render(scene, seed=0, spp=4, develop=False)
+    ref = np.array(film.bitmap(raw=True))
+
+    # The raw contents of all block partitions sum up to the full rendering
+    total = np.zeros_like(ref)
+    for index in range(3):
+        integrator.set_block_partition(index, 3)
+        integrator.render(scene, seed=0, spp=4, develop=False)
+        part = np.array(film.bitmap(raw=True))
+        assert np.count_nonzero(part[..., -1]) < part[..., -1].size
+        total += part
+    integrator.set_block_partition(0, 1)
+
+    assert np.allclose(total, ref, atol=1e-4)
+
+
+@pytest.mark.parametrize('count', [2, 3, 5])
+def test06_merge_partitions(variant_scalar_rgb, count):
+    scene_dict = mi.cornell_box()
+    scene_dict['sensor']['film']['width'] = 61
+    scene_dict['sensor']['film']['height'] = 45
+    scene_dict['sensor']['film']['rfilter'] = { 'type': 'gaussian' }
+    scene = mi.load_dict(scene_dict)
+    integrator = scene.integrator()
+    film = scene.sensors()[0].film()
+
+    # Single-process rendering
+    ref = mi.render(scene, seed=0, spp=4)
+
+    # Render each partition separately and retain its raw film contents
+    parts = []
+    for index in range(count):
+        integrator.set_block_partition(index, count)
+        integrator.render(scene, seed=0, spp=4, develop=False)
+        parts.append(mi.TensorXf(film.bitmap(raw=True)))
+    integrator.set_block_partition(0, 1)
+
+    # Merge them like the distributed rendering coordinator
+    film.prepare(integrator.aov_names())
+    for part in parts:
+        block = mi.ImageBlock(part, offset=film.crop_offset(), border=False,
+                              normalize=False, warn_negative=False)
+        film.put_block(block)
+    merged = film.develop()
+
+    assert merged.shape == ref.shape
+    assert dr.allclose(merged.array, ref.array, rtol=1e-4, atol=1e-5)
@@ -0,0 +1,285 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-meterarray:
+
+Meter array (:monosp:`meterarray`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - mode
+   - |string|
+   - Quantity measured by every meter of the array: :monosp:`radiance`
+     (like :ref:`radiancemeter <sensor-radiancemeter>`) or :monosp:`irradiance`
+     (incident irradiance on an infinitesimal patch). (Default: :monosp:`radiance`)
+
+ * - origins
+   - |string|
+   - Comma or space separated list of :math:`3N` floating point values that
+     specify the location of each of the :math:`N` meters in world coordinates.
+   - |exposed|, |differentiable|
+
+ * - directions
+   - |string|
+   - Comma or space separated list of :math:`3N` floating point values that
+     specify the viewing direction (:monosp:`radiance` mode) or the patch
+     normal (:monosp:`irradiance` mode) of each meter. The vectors do not
+     need to be normalized.
+   - |exposed|, |differentiable|
+
+ * - count
+   - |int|
+   - Number of meters :math:`N`. Only needed when :monosp:`origins` and
+     :monosp:`directions` are not specified, in which case both arrays are
+     zero-initialized and are expected to be filled in later using
+     :py:func:`mitsuba.traverse`. (Default: inferred from :monosp:`origins`)
+
+ * - srf
+   - |spectrum|
+   - Sensor Response Function that defines the :ref:`spectral sensitivity <explanation_srf_sensor>`
+     of the sensor (Default: :monosp:`none`)
+
+This sensor plugin evaluates a whole array of point sensors in a single
+rendering pass. Each meter is assigned to one pixel of the film, in scanline
+order (i.e. meter :math:`i` is written to pixel
+:math:`(i \bmod w, \lfloor i / w \rfloor)`), so that the film must have exactly
+:math:`N` pixels. Rendering the scene then returns all measurements at once as
+a tensor, amortizing scene setup, kernel compilation and thread startup across
+the entire batch instead of paying these costs for every individual
+:ref:`radiancemeter <sensor-radiancemeter>` or
+:ref:`irradiancemeter <sensor-irradiancemeter>`.
+
+The film must use a reconstruction filter of radius 0.5 or lower (e.g. the
+:monosp:`box` filter), since wider filters would mix the measurements of
+neighbouring meters.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: meterarray
+
+        <sensor type="meterarray">
+            <string name="origins" value="0, 0, 0, 1, 0, 0"/>
+            <string name="directions" value="0, 0, 1, 0, 0, 1"/>
+            <film type="hdrfilm">
+                <integer name="width" value="2"/>
+                <integer name="height" value="1"/>
+                <rfilter type="box"/>
+            </film>
+        </sensor>
+
+    .. code-tab:: python
+
+        sensor = mi.load_dict({
+            'type': 'meterarray',
+            'count': n,
+            'film': {
+                'type': 'hdrfilm',
+                'width': n,
+                'height': 1,
+                'rfilter': { 'type': 'box' }
+            }
+        })
+
+        params = mi.traverse(sensor)
+        params['origins'] = dr.ravel(origins)       # mi.Point3f with n entries
+        params['directions'] = dr.ravel(directions) # mi.Vector3f with n entries
+        params.update()
+
+*/
+
+MI_VARIANT class MeterArray final : public Sensor<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sensor, m_film, m_needs_sample_2, m_needs_sample_3,
+                   sample_wavelengths)
+    MI_IMPORT_TYPES()
+
+    using FloatStorage = DynamicBuffer<Float>;
+
+    MeterArray(const Properties &props) : Base(props) {
+        if (props.has_property("to_world"))
+            Throw("Found a 'to_world' transformation -- this is not allowed. "
+                  "The meter locations are specified using the 'origins' and "
+                  "'directions' parameters.");
+
+        std::string mode = props.string("mode", "radiance");
+        if (mode == "radiance")
+            m_irradiance = false;
+        else if (mode == "irradiance")
+            m_irradiance = true;
+        else
+            Throw("Invalid mode \"%s\", must be one of: \"radiance\" or "
+                  "\"irradiance\"!", mode);
+
+        if (props.has_property("origins") != props.has_property("directions"))
+            Throw("The 'origins' and 'directions' parameters must be specified "
+                  "together!");
+
+        if (props.has_property("origins")) {
+            std::vector<ScalarFloat> origins    = parse_list(props, "origins"),
+                                     directions = parse_list(props, "directions");
+            if (origins.size() != directions.size())
+                Throw("The 'origins' and 'directions' parameters must have "
+                      "the same size!");
+            m_count = (uint32_t) (origins.size() / 3);
+            if (props.has_property("count") &&
+                props.get<uint32_t>("count") != m_count)
+                Throw("The 'count' parameter (%u) does not match the number of "
+                      "entries in 'origins' (%u)!", props.get<uint32_t>("count"),
+                      m_count);
+
+            m_origins    = dr::load<FloatStorage>(origins.data(), origins.size());
+            m_directions = dr::load<FloatStorage>(directions.data(), directions.size());
+        } else {
+            m_count      = props.get<uint32_t>("count");
+            m_origins    = dr::zeros<FloatStorage>(m_count * 3);
+            m_directions = dr::zeros<FloatStorage>(m_count * 3);
+        }
+
+        if (m_count == 0)
+            Throw("The meter array must contain at least one meter!");
+
+        ScalarVector2u size = m_film->size();
+        if ((size_t) size.x() * size.y() != m_count)
+            Throw("The film size (%u x %u) does not match the number of meters "
+                  "(%u)!", size.x(), size.y(), m_count);
+
+        if (m_film->rfilter()->radius() > .5f + math::RayEpsilon<Float>)
+            Throw("This sensor must be used with a reconstruction filter of "
+                  "radius 0.5 or lower (e.g. default 'box' filter)");
+
+        dr::make_opaque(m_origins, m_directions);
+
+        m_needs_sample_2 = true;
+        m_needs_sample_3 = m_irradiance;
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("origins",    m_origins,    +ParamFlags::Differentiable);
+        callback->put_parameter("directions", m_directions, +ParamFlags::Differentiable);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        if (dr::width(m_origins) != m_count * 3 ||
+            dr::width(m_directions) != m_count * 3)
+            Throw("The 'origins' and 'directions' arrays must contain exactly "
+                  "%u entries!", m_count * 3);
+        dr::make_opaque(m_origins, m_directions);
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Sample spectrum
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(dr::zeros<SurfaceInteraction3f>(),
+                               wavelength_sample,
+                               active);
+
+        // 2. Look up the meter associated with the film pixel
+        UInt32 index = meter_index(position_sample);
+        Point3f origin = dr::gather<Point3f>(m_origins, index, active);
+        Vector3f direction =
+            dr::normalize(dr::gather<Vector3f>(m_directions, index, active));
+
+        // 3. Set ray origin and direction
+        Spectrum weight = wav_weight;
+        if (m_irradiance) {
+            direction = Frame3f(direction).to_world(
+                warp::square_to_cosine_hemisphere(aperture_sample));
+            weight *= dr::Pi<ScalarFloat>;
+        }
+
+        Ray3f ray(origin + direction * math::RayEpsilon<Float>, direction,
+                  time, wavelengths);
+
+        return { ray, weight };
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f &aperture_sample,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        auto [ray, weight] = sample_ray(time, wavelength_sample, position_sample,
+                                        aperture_sample, active);
+
+        // Every meter covers exactly one pixel, there are no differentials
+        RayDifferential3f ray_diff(ray);
+        ray_diff.has_differentials = false;
+
+        return { ray_diff, weight };
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        // Return an invalid bounding box
+        return ScalarBoundingBox3f();
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MeterArray[" << std::endl
+            << "  mode = " << (m_irradiance ? "irradiance" : "radiance") << "," << std::endl
+            << "  count = " << m_count << "," << std::endl
+            << "  film = " << string::indent(m_film) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Map a film position sample onto the index of the corresponding meter
+    UInt32 meter_index(const Point2f &position_sample) const {
+        // Position samples are relative to the crop window of the film
+        ScalarVector2u size        = m_film->size(),
+                       crop_size   = m_film->crop_size(),
+                       crop_offset = m_film->crop_offset();
+        Point2u pixel = Point2u(crop_offset) + dr::minimum(
+            Vector2u(position_sample * ScalarVector2f(crop_size)), crop_size - 1u);
+        return pixel.y() * size.x() + pixel.x();
+    }
+
+    static std::vector<ScalarFloat> parse_list(const Properties &props,
+                                               const std::string &name) {
+        std::vector<std::string> tokens =
+            string::tokenize(props.string(name), " ,");
+        if (tokens.size() % 3 != 0)
+            Throw("The number of entries in '%s' must be a multiple of 3!", name);
+
+        std::vector<ScalarFloat> values;
+        values.reserve(tokens.size());
+        for (const std::string &token : tokens) {
+            try {
+                values.push_back(string::stof<ScalarFloat>(token));
+            } catch (...) {
+                Throw("Could not parse floating point value '%s'", token);
+            }
+        }
+        return values;
+    }
+
+private:
+    FloatStorage m_origins;
+    FloatStorage m_directions;
+    uint32_t m_count;
+    bool m_irradiance;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(MeterArray, Sensor)
+MI_EXPORT_PLUGIN(MeterArray, "MeterArray");
+NAMESPACE_END(mitsuba)
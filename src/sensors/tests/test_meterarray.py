@@ -0,0 +1,91 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def make_sensor(width, height=1, **kwargs):
+    d = {
+        'type': 'meterarray',
+        'film': {
+            'type': 'hdrfilm',
+            'width': width,
+            'height': height,
+            'pixel_format': 'rgb',
+            'rfilter': {'type': 'box'}
+        },
+        'sampler': {
+            'type': 'independent',
+            'sample_count': 16
+        }
+    }
+    d.update(kwargs)
+    return d
+
+
+def test01_construct(variant_scalar_rgb):
+    sensor = mi.load_dict(make_sensor(2, origins='0, 0, 0, 1, 0, 0',
+                                      directions='0, 0, 1, 0, 1, 0'))
+    assert not sensor.bbox().valid()
+    assert 'count = 2' in str(sensor)
+    assert not str(sensor).endswith(',\n]')
+
+    # Film size must match the number of meters
+    with pytest.raises(RuntimeError, match='film size'):
+        mi.load_dict(make_sensor(3, origins='0, 0, 0, 1, 0, 0',
+                                 directions='0, 0, 1, 0, 1, 0'))
+
+    # Origins and directions must be given together
+    with pytest.raises(RuntimeError):
+        mi.load_dict(make_sensor(1, origins='0, 0, 0'))
+
+    with pytest.raises(RuntimeError, match='mode'):
+        mi.load_dict(make_sensor(1, count=1, mode='foo'))
+
+    # Wide reconstruction filters would mix neighbouring meters
+    d = make_sensor(1, count=1)
+    d['film']['rfilter'] = {'type': 'gaussian'}
+    with pytest.raises(RuntimeError, match='reconstruction filter'):
+        mi.load_dict(d)
+
+
+def test02_sample_ray(variant_scalar_rgb):
+    sensor = mi.load_dict(make_sensor(2, 2, origins='0 0 0 1 0 0 0 1 0 0 0 1',
+                                      directions='1 0 0 0 2 0 0 0 3 -1 0 0'))
+
+    origins = [[0, 0, 0], [1, 0, 0], [0, 1, 0], [0, 0, 1]]
+    directions = [[1, 0, 0], [0, 1, 0], [0, 0, 1], [-1, 0, 0]]
+    positions = [[.1, .2], [.7, .4], [.3, .9], [.8, .6]]
+
+    for i in range(4):
+        ray, weight = sensor.sample_ray(0., .5, positions[i], [.5, .5], True)
+        assert dr.allclose(ray.o, origins[i], atol=1e-4)
+        assert dr.allclose(ray.d, directions[i])
+
+
+@pytest.mark.parametrize('mode', ['radiance', 'irradiance'])
+def test03_render(variants_vec_rgb, mode):
+    n = 8
+    radiance = 2.5
+
+    sensor = mi.load_dict(make_sensor(n, count=n, mode=mode))
+    params = mi.traverse(sensor)
+    params['origins'] = dr.ravel(mi.Point3f(dr.arange(mi.Float, n), 0, 0))
+    params['directions'] = dr.ravel(mi.Vector3f(0, 0, dr.ones(mi.Float, n)))
+    params.update()
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': { 'type': 'path' },
+        'sensor': sensor,
+        'emitter': {
+            'type': 'constant',
+            'radiance': { 'type': 'uniform', 'value': radiance }
+        }
+    })
+
+    image = mi.render(scene)
+    assert dr.shape(image) == [1, n, 3]
+
+    # An irradiance meter under a constant environment receives pi * L
+    expected = radiance * (dr.pi if mode == 'irradiance' else 1)
+    assert dr.allclose(image, expected)
@@ -18,7 +18,7 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
 -----------------------------------------
 
 .. pluginparameters::
- :extra-rows: 5
+ :extra-rows: 9
 
  * - filename
    - |string|
@@ -39,6 +39,37 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - compact_normals
+   - |bool|
+   - Store the vertex normals using a 32-bit octahedral encoding, which needs a third
+     of the memory at a maximum angular error of about 0.005 degrees. The
+     :monosp:`vertex_normals` parameter is then only populated when new values are
+     assigned to it, and compact normals are not differentiable. (Default: |false|)
+
+ * - compact_texcoords
+   - |bool|
+   - Store the texture coordinates in half precision, which needs half of the memory.
+     This is only suitable for coordinates of moderate magnitude (e.g. within
+     :math:`[0, 1]^2`), and compact texture coordinates are not differentiable.
+     (Default: |false|)
+
+ * - emitter_sampling
+   - |string|
+   - Strategy used to sample directions towards the mesh when it is attached to an
+     :ref:`area <emitter-area>` emitter: :monosp:`area` samples triangles uniformly by
+     area, :monosp:`solid_angle` samples the spherical triangle they subtend as seen
+     from the shading point [Arvo1995Stratified]_, and :monosp:`projected_solid_angle`
+     additionally approximates the cosine foreshortening at the shading point with a
+     bilinear warp. The latter two substantially reduce noise when large or nearby
+     emitters illuminate a scene. (Default: :monosp:`area`)
+
+ * - alias_sampling
+   - |bool|
+   - Sample triangles by area using an alias table, which replaces the binary search
+     over the cumulative distribution by a constant number of lookups. This speeds up
+     position sampling on large emitting meshes at the cost of 8 additional bytes of
+     memory per face. (Default: |false|)
+
  * - vertex_count
    - |int|
    - Total number of vertices
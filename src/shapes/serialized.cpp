@@ -1,10 +1,14 @@
 #include <mitsuba/render/mesh.h>
+#include <mitsuba/render/serialized.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/zstream.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
+#include <nanothread/nanothread.h>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -16,7 +20,7 @@ Serialized mesh loader (:monosp:`serialized`)
 ---------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 5
+ :extra-rows: 9
 
  * - filename
    - |string|
@@ -38,6 +42,37 @@ Serialized mesh loader (:monosp:`serialized`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - compact_normals
+   - |bool|
+   - Store the vertex normals using a 32-bit octahedral encoding, which needs a third
+     of the memory at a maximum angular error of about 0.005 degrees. The
+     :monosp:`vertex_normals` parameter is then only populated when new values are
+     assigned to it, and compact normals are not differentiable. (Default: |false|)
+
+ * - compact_texcoords
+   - |bool|
+   - Store the texture coordinates in half precision, which needs half of the memory.
+     This is only suitable for coordinates of moderate magnitude (e.g. within
+     :math:`[0, 1]^2`), and compact texture coordinates are not differentiable.
+     (Default: |false|)
+
+ * - emitter_sampling
+   - |string|
+   - Strategy used to sample directions towards the mesh when it is attached to an
+     :ref:`area <emitter-area>` emitter: :monosp:`area` samples triangles uniformly by
+     area, :monosp:`solid_angle` samples the spherical triangle they subtend as seen
+     from the shading point [Arvo1995Stratified]_, and :monosp:`projected_solid_angle`
+     additionally approximates the cosine foreshortening at the shading point with a
+     bilinear warp. The latter two substantially reduce noise when large or nearby
+     emitters illuminate a scene. (Default: :monosp:`area`)
+
+ * - alias_sampling
+   - |bool|
+   - Sample triangles by area using an alias table, which replaces the binary search
+     over the cumulative distribution by a constant number of lookups. This speeds up
+     position sampling on large emitting meshes at the cost of 8 additional bytes of
+     memory per face. (Default: |false|)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -85,6 +120,12 @@ with the internally used data structures. Loading such files is considerably
 faster than the :ref:`ply <shape-ply>` plugin and orders of magnitude faster than
 the :ref:`obj <shape-obj>` plugin.
 
+Version 5 of the format additionally splits every buffer into independently
+compressed chunks, which are decompressed in parallel, or stores it
+uncompressed so that it can be memory-mapped directly. Existing files can be
+converted using :code:`mi.convert_serialized(source, target, compress=True)`
+(see :ref:`below <serialized-v5>`).
+
 Format description
 ******************
 
@@ -104,7 +145,8 @@ follows:
         * - :monosp:`uint16`
           - File format identifier: :code:`0x041C`
         * - :monosp:`uint16`
-          - File version identifier. Currently set to :code:`0x0004`
+          - File version identifier: :code:`0x0004` (see :ref:`below <serialized-v5>`
+            for version :code:`0x0005`)
         * - :math:`\rightarrow`
           - From this point on, the stream is compressed by the :monosp:`DEFLATE` algorithm.
         * - :math:`\rightarrow`
@@ -142,6 +184,69 @@ follows:
             :monosp:`uint32` or in :monosp:`uint64` format (the latter is used when the number of
             vertices exceeds :code:`0xFFFFFFFF`).
 
+.. _serialized-v5:
+
+Chunked format (version 5)
+**************************
+
+Version 4 compresses each mesh as a single :monosp:`zlib` stream, which must be
+decompressed sequentially and in its entirety. Version 5 instead stores the
+header uncompressed and splits each buffer into chunks of a fixed uncompressed
+size that are compressed independently. The chunk sizes are listed in a chunk
+table, which allows decompressing the chunks in parallel and skipping buffers
+that are not needed. All values use single precision and indices are stored in
+:monosp:`uint32` format.
+
+.. figtable::
+    :label: table-serialized-format-v5
+
+    .. list-table::
+        :widths: 20 80
+        :header-rows: 1
+
+        * - Type
+          - Content
+        * - :monosp:`uint16`
+          - File format identifier: :code:`0x041C`
+        * - :monosp:`uint16`
+          - File version identifier: :code:`0x0005`
+        * - :monosp:`uint32`
+          - Flags as in version 4. :code:`0x1000` is always set, and :code:`0x4000`
+            indicates that the buffers are stored uncompressed. :code:`0x8000` and
+            :code:`0x10000` indicate that vertex normals and texture coordinates use
+            the compact encodings described below.
+        * - :monosp:`uint64`
+          - Number of vertices in the mesh
+        * - :monosp:`uint64`
+          - Number of triangles in the mesh
+        * - :monosp:`uint32`
+          - Uncompressed size of a chunk in bytes (the last chunk of a buffer may be
+            smaller)
+        * - :monosp:`uint64`
+          - File offset of the chunk table
+        * - :monosp:`string`
+          - A null-terminated string (utf-8), which denotes the name of the shape.
+        * - :math:`\rightarrow`
+          - The buffers (positions, normals, texture coordinates, colors and indices,
+            in this order and as indicated by the flags) follow, each as a sequence of
+            :monosp:`zlib` streams (one per chunk). Uncompressed buffers start at
+            multiples of 4096 bytes.
+
+The chunk table contains one entry per buffer, in the same order. Each entry
+consists of the :monosp:`uint64` file offset of the buffer, followed by the
+compressed size of each of its chunks (:monosp:`uint32`). The sizes are omitted
+when the buffers are uncompressed. In the latter case, the file is mapped into
+memory and scalar variants use the mapped pages as mesh buffers without copying
+them. The mapping is private, hence the file is never modified.
+
+Vertex normals and texture coordinates can optionally be stored using one
+:monosp:`uint32` per vertex (see the :monosp:`compact_normals` and
+:monosp:`compact_texcoords` arguments of :code:`mi.convert_serialized()`).
+Compact normals use the octahedral encoding with two 16-bit signed normalized
+components, and compact texture coordinates are pairs of half precision values.
+They are loaded without conversion when the corresponding plugin parameters are
+set.
+
 Multiple shapes
 ***************
 
@@ -195,16 +300,13 @@ at the end of the file, which specifies the starting position of each sub-mesh:
         }
  */
 
-#define MI_FILEFORMAT_HEADER     0x041C
-#define MI_FILEFORMAT_VERSION_V3 0x0003
-#define MI_FILEFORMAT_VERSION_V4 0x0004
-
 template <typename Float, typename Spectrum>
 class SerializedMesh final : public Mesh<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_positions, m_vertex_normals,
                     m_vertex_texcoords, m_faces, m_face_normals,
+                    m_vertex_normals_oct, m_vertex_texcoords_half,
                     has_vertex_normals, has_vertex_texcoords,
                     recompute_vertex_normals, vertex_position, vertex_normal,
                     initialize)
@@ -217,15 +319,7 @@ public:
     using typename Base::InputPoint3f;
     using typename Base::InputNormal3f;
 
-    enum class TriMeshFlags {
-        HasNormals      = 0x0001,
-        HasTexcoords    = 0x0002,
-        HasTangents     = 0x0004, // unused
-        HasColors       = 0x0008,
-        FaceNormals     = 0x0010,
-        SinglePrecision = 0x1000,
-        DoublePrecision = 0x2000
-    };
+    using TriMeshFlags = SerializedFlags;
 
     constexpr bool has_flag(TriMeshFlags flags, TriMeshFlags f) {
         return (static_cast<uint32_t>(flags) & static_cast<uint32_t>(f)) != 0;
@@ -235,10 +329,6 @@ public:
     }
 
     SerializedMesh(const Properties &props) : Base(props) {
-        auto fail = [&](const std::string &descr) {
-            Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
-        };
-
         auto fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
@@ -267,7 +357,8 @@ public:
             fail("encountered an invalid file format!");
 
         if (version != MI_FILEFORMAT_VERSION_V3 &&
-            version != MI_FILEFORMAT_VERSION_V4)
+            version != MI_FILEFORMAT_VERSION_V4 &&
+            version != MI_FILEFORMAT_VERSION_V5)
             fail("encountered an incompatible file version!");
 
         if (shape_index != 0) {
@@ -286,7 +377,7 @@ public:
                                  shape_index, count - 1));
 
             // Seek to the correct position
-            if (version == MI_FILEFORMAT_VERSION_V4) {
+            if (version != MI_FILEFORMAT_VERSION_V3) {
                 stream->seek(file_size -
                              sizeof(uint64_t) * (count - shape_index) -
                              sizeof(uint32_t));
@@ -294,7 +385,6 @@ public:
                 stream->read(offset);
                 stream->seek(offset);
             } else {
-                Assert(version == MI_FILEFORMAT_VERSION_V3);
                 stream->seek(file_size -
                              sizeof(uint32_t) * (count - shape_index + 1));
                 uint32_t offset = 0;
@@ -304,6 +394,12 @@ public:
             stream->skip(sizeof(short) * 2); // Skip the header
         }
 
+        if (version == MI_FILEFORMAT_VERSION_V5) {
+            bool has_normals = read_chunked(file_path, stream);
+            finalize(has_normals, timer);
+            return;
+        }
+
         stream = new ZStream(stream);
         stream->set_byte_order(Stream::ELittleEndian);
 
@@ -380,10 +476,220 @@ public:
         if (has_texcoords)
             m_vertex_texcoords = dr::load<FloatStorage>(vertex_texcoords.get(), m_vertex_count * 2);
 
+        finalize(has_normals, timer);
+    }
+
+    /**
+     * Load a mesh stored in version 5 of the format. The file is mapped into
+     * memory, and the chunks of every buffer are decompressed in parallel.
+     * Buffers that are not needed (e.g. vertex normals when face normals are
+     * requested) are never touched. Uncompressed files are mapped privately:
+     * scalar variants use the mapped pages directly as mesh buffers, and the
+     * transformation by \c to_world only copies the pages that it modifies.
+     * Returns whether the file provides vertex normals.
+     */
+    bool read_chunked(const fs::path &file_path, Stream *stream) {
+        if (Struct::host_byte_order() != Struct::ByteOrder::LittleEndian)
+            fail("version 5 files can only be loaded on little endian machines");
+
+        uint32_t flags = 0, chunk_size = 0;
+        uint64_t vertex_count = 0, face_count = 0, table_offset = 0;
+        stream->read(flags);
+        stream->read(vertex_count);
+        stream->read(face_count);
+        stream->read(chunk_size);
+        stream->read(table_offset);
+
+        char ch = 0;
+        m_name = "";
+        do {
+            stream->read(ch);
+            if (ch == 0)
+                break;
+            m_name += ch;
+        } while (true);
+
+        bool uncompressed   = has_flag(flags, TriMeshFlags::Uncompressed),
+             has_normals    = has_flag(flags, TriMeshFlags::HasNormals),
+             has_texcoords  = has_flag(flags, TriMeshFlags::HasTexcoords),
+             has_colors     = has_flag(flags, TriMeshFlags::HasColors),
+             oct_normals    = has_flag(flags, TriMeshFlags::OctahedralNormals),
+             half_texcoords = has_flag(flags, TriMeshFlags::HalfTexcoords);
+
+        if (!has_flag(flags, TriMeshFlags::SinglePrecision))
+            fail("version 5 files must use single precision");
+        if (!uncompressed && chunk_size == 0)
+            fail("invalid chunk size");
+        if (vertex_count > 0xFFFFFFFFull || face_count > 0xFFFFFFFFull)
+            fail("the mesh is too large");
+
+        m_vertex_count = (ScalarSize) vertex_count;
+        m_face_count   = (ScalarSize) face_count;
+
+        /* Buffers in the order in which they are listed in the chunk table.
+           Compact normals and texture coordinates use one word per vertex. */
+        ChunkedBuffer positions { m_vertex_count * 3 * sizeof(InputFloat) },
+                      normals   { m_vertex_count * (oct_normals ? sizeof(uint32_t)
+                                                                : 3 * sizeof(InputFloat)) },
+                      texcoords { m_vertex_count * (half_texcoords ? sizeof(uint32_t)
+                                                                   : 2 * sizeof(InputFloat)) },
+                      colors    { m_vertex_count * 3 * sizeof(InputFloat) },
+                      faces     { m_face_count * 3 * sizeof(ScalarIndex) };
+
+        std::vector<ChunkedBuffer *> buffers = { &positions };
+        if (has_normals)
+            buffers.push_back(&normals);
+        if (has_texcoords)
+            buffers.push_back(&texcoords);
+        if (has_colors)
+            buffers.push_back(&colors);
+        buffers.push_back(&faces);
+
+        size_t file_size = stream->size();
+        stream->seek(table_offset);
+        for (ChunkedBuffer *buf : buffers) {
+            uint64_t offset = 0;
+            stream->read(offset);
+
+            uint64_t end = offset;
+            if (uncompressed) {
+                /* Buffers are used in place, all of their elements (floats
+                   and indices) are 32-bit words */
+                if (offset % sizeof(uint32_t) != 0)
+                    fail("buffer offsets of uncompressed files must be "
+                         "multiples of 4 bytes");
+                if (offset > file_size)
+                    fail("the chunk table refers to data past the end of the file");
+                end += buf->size;
+            } else {
+                size_t chunk_count = (buf->size + chunk_size - 1) / chunk_size;
+                std::vector<uint32_t> sizes(chunk_count);
+                stream->read_array(sizes.data(), chunk_count);
+
+                buf->chunks.reserve(chunk_count + 1);
+                buf->chunks.push_back(offset);
+                for (uint32_t size : sizes)
+                    buf->chunks.push_back(end += size);
+            }
+            buf->offset = offset;
+
+            if (end > file_size)
+                fail("the chunk table refers to data past the end of the file");
+        }
+
+        ref<MemoryMappedFile> mmap;
+        if (uncompressed)
+            mmap = MemoryMappedFile::map_private(file_path);
+        else
+            mmap = new MemoryMappedFile(file_path);
+        uint8_t *base = (uint8_t *) mmap->data();
+
+        // Host memory holding the contents of a buffer
+        std::vector<std::unique_ptr<uint8_t[]>> staging;
+        auto fetch = [&](const ChunkedBuffer &buf) -> uint8_t * {
+            if (uncompressed)
+                return base + buf.offset;
+
+            staging.emplace_back(new uint8_t[buf.size]);
+            uint8_t *dst = staging.back().get();
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, buf.chunks.size() - 1, 1),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        size_t start = i * (size_t) chunk_size;
+                        ZStream::decompress(base + buf.chunks[i],
+                                            buf.chunks[i + 1] - buf.chunks[i],
+                                            dst + start,
+                                            std::min((size_t) chunk_size,
+                                                     buf.size - start));
+                    }
+                }
+            );
+
+            return dst;
+        };
+
+        InputFloat *position_ptr = (InputFloat *) fetch(positions);
+        void *normal_ptr = nullptr, *texcoord_ptr = nullptr;
+        if (has_normals && !m_face_normals)
+            normal_ptr = fetch(normals);
+        if (has_texcoords)
+            texcoord_ptr = fetch(texcoords);
+        ScalarIndex *face_ptr = (ScalarIndex *) fetch(faces);
+
+        // Post-processing
+        ScalarTransform4f to_world = m_to_world.scalar();
+        bool identity = to_world.matrix == dr::identity<ScalarMatrix4f>();
+        std::mutex mutex;
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, m_vertex_count, 65536),
+            [&](const dr::blocked_range<size_t> &range) {
+                ScalarBoundingBox3f bbox;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    InputPoint3f p = dr::load<InputPoint3f>(position_ptr + 3 * i);
+                    if (!identity) {
+                        p = to_world.transform_affine(p);
+                        dr::store(position_ptr + 3 * i, p);
+
+                        if (normal_ptr && oct_normals) {
+                            uint32_t *ptr = (uint32_t *) normal_ptr + i;
+                            InputNormal3f n = decode_octahedral(*ptr);
+                            *ptr = encode_octahedral(
+                                dr::normalize(to_world.transform_affine(n)));
+                        } else if (normal_ptr) {
+                            InputFloat *ptr = (InputFloat *) normal_ptr + 3 * i;
+                            InputNormal3f n = dr::load<InputNormal3f>(ptr);
+                            n = dr::normalize(to_world.transform_affine(n));
+                            dr::store(ptr, n);
+                        }
+                    }
+                    bbox.expand(p);
+                }
+
+                std::lock_guard<std::mutex> guard(mutex);
+                m_bbox.expand(bbox);
+            }
+        );
+
+        bool in_place = uncompressed && !dr::is_jit_v<Float>;
+        if (in_place)
+            m_mmap = mmap;
+
+        m_faces = upload<DynamicBuffer<UInt32>>(face_ptr, m_face_count * 3, in_place);
+        m_vertex_positions = upload<FloatStorage>(position_ptr, m_vertex_count * 3, in_place);
+
+        // Compact attributes are converted as needed by Mesh::initialize()
+        if (normal_ptr && oct_normals)
+            m_vertex_normals_oct = upload<DynamicBuffer<UInt32>>(normal_ptr, m_vertex_count, in_place);
+        else if (normal_ptr)
+            m_vertex_normals = upload<FloatStorage>(normal_ptr, m_vertex_count * 3, in_place);
+
+        if (texcoord_ptr && half_texcoords)
+            m_vertex_texcoords_half = upload<DynamicBuffer<UInt32>>(texcoord_ptr, m_vertex_count, in_place);
+        else if (texcoord_ptr)
+            m_vertex_texcoords = upload<FloatStorage>(texcoord_ptr, m_vertex_count * 2, in_place);
+
+        return has_normals;
+    }
+
+    /// Reference (scalar variants) or copy host memory into a mesh buffer
+    template <typename Storage>
+    Storage upload(void *ptr, size_t count, bool in_place) {
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (in_place)
+                return dr::map<Storage>(ptr, count);
+        }
+        return dr::load<Storage>(ptr, count);
+    }
+
+    /// Log statistics, compute missing vertex normals and initialize the mesh
+    void finalize(bool has_normals, const Timer &timer) {
         size_t vertex_data_bytes = 3 * sizeof(InputFloat);
         if (!m_face_normals)
             vertex_data_bytes += 3 * sizeof(InputFloat);
-        if (has_texcoords)
+        if (has_vertex_texcoords())
             vertex_data_bytes += 2 * sizeof(InputFloat);
 
         Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
@@ -395,6 +701,8 @@ public:
 
         if (!m_face_normals && !has_normals) {
             Timer timer2;
+            if (!has_vertex_normals())
+                m_vertex_normals = dr::zeros<FloatStorage>(m_vertex_count * 3);
             recompute_vertex_normals();
             Log(Debug, "\"%s\": computed vertex normals (took %s)", m_name,
                 util::time_string((float) timer2.value()));
@@ -403,6 +711,10 @@ public:
         initialize();
     }
 
+    void fail(const std::string &descr) const {
+        Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
+    }
+
     void read_helper(Stream *stream, bool dp, InputFloat* dst, size_t dim) {
         if (dp) {
             std::unique_ptr<double[]> values(new double[m_vertex_count * dim]);
@@ -432,6 +744,19 @@ public:
     }
 
     MI_DECLARE_CLASS()
+private:
+    /// Location of a buffer in a version 5 file
+    struct ChunkedBuffer {
+        /// Uncompressed size in bytes
+        size_t size;
+        /// File offset of the first byte (or chunk)
+        uint64_t offset = 0;
+        /// File offsets delimiting the compressed chunks
+        std::vector<uint64_t> chunks;
+    };
+
+    /// Memory-mapped file backing the mesh buffers (uncompressed files only)
+    ref<MemoryMappedFile> m_mmap;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(SerializedMesh, Mesh)
@@ -24,9 +24,29 @@ Irregular spectrum (:monosp:`irregular`)
    - Values of the spectral function at the specified wavelengths.
    - |exposed|, |differentiable|
 
+ * - bake
+   - |bool|
+   - Resample the spectrum into a regular lookup table at load time, so that evaluation becomes a
+     single interpolated lookup instead of a binary search over the wavelengths. (Default: |false|)
+
+ * - bake_resolution
+   - |float|
+   - Initial spacing of the lookup table entries in nanometers. (Default: 1)
+
+ * - bake_tolerance
+   - |float|
+   - Maximum deviation of the lookup table from the source data, relative to the largest value
+     of the spectrum. The spacing is halved until this tolerance is met. (Default: 1e-3)
+
 This spectrum returns linearly interpolated reflectance or emission values from *irregularly*
 placed samples.
 
+Evaluating such a spectrum requires a binary search over the wavelengths for every query. When
+:monosp:`bake` is enabled, the spectrum is instead resampled on a regular grid covering the same
+range, and the accuracy of the result is verified against the source data. The lookup table is
+rebuilt whenever the parameters change, and it is bypassed while the values are differentiated,
+since resampling on the host would not propagate derivatives.
+
 .. tabs::
     .. code-tab:: xml
         :name: irregular
@@ -48,6 +68,8 @@ class IrregularSpectrum final : public Texture<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(Texture)
 
+    using FloatStorage = DynamicBuffer<Float>;
+
 public:
     IrregularSpectrum(const Properties &props) : Texture(props) {
         if (props.type("values") == Properties::Type::String) {
@@ -97,6 +119,14 @@ public:
                     wavelengths.data(), values.data(), size);
             }
         }
+
+        m_bake = props.get<bool>("bake", false);
+        m_bake_resolution = props.get<ScalarFloat>("bake_resolution", 1.f);
+        m_bake_tolerance = props.get<ScalarFloat>("bake_tolerance", 1e-3f);
+        if (m_bake_resolution <= 0.f)
+            Throw("IrregularSpectrum: 'bake_resolution' must be positive!");
+
+        bake();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -106,13 +136,17 @@ public:
 
     void parameters_changed(const std::vector<std::string> &/*keys*/) override {
         m_distr.update();
+        bake();
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (!m_lut.empty())
+                return m_lut.eval_pdf(si.wavelengths, active);
             return m_distr.eval_pdf(si.wavelengths, active);
+        }
         else {
             DRJIT_MARK_USED(si);
             NotImplementedError("eval");
@@ -122,8 +156,11 @@ public:
     Wavelength pdf_spectrum(const SurfaceInteraction3f &si, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (!m_lut.empty())
+                return m_lut.eval_pdf_normalized(si.wavelengths, active);
             return m_distr.eval_pdf_normalized(si.wavelengths, active);
+        }
         else {
             DRJIT_MARK_USED(si);
             NotImplementedError("pdf");
@@ -135,8 +172,11 @@ public:
                                                       Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureSample, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (!m_lut.empty())
+                return { m_lut.sample(sample, active), m_lut.integral() };
             return { m_distr.sample(sample, active), m_distr.integral() };
+        }
         else {
             DRJIT_MARK_USED(sample);
             NotImplementedError("sample");
@@ -163,14 +203,95 @@ public:
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "IrregularSpectrum[" << std::endl
-            << "  distr = " << string::indent(m_distr) << std::endl
-            << "]";
+            << "  distr = " << string::indent(m_distr);
+        if (!m_lut.empty())
+            oss << "," << std::endl << "  lut_size = " << m_lut.size();
+        oss << std::endl << "]";
         return oss.str();
     }
 
     MI_DECLARE_CLASS()
 private:
+    /**
+     * \brief Resample the spectrum into \c m_lut (when enabled)
+     *
+     * The piecewise linear lookup table is exact at its own nodes, hence its
+     * largest deviation from the source data occurs at the source wavelengths.
+     * The resolution is refined until this deviation is within tolerance.
+     */
+    void bake() {
+        m_lut = ContinuousDistribution<Wavelength>();
+
+        // Resampling happens on the host and would not propagate derivatives
+        if (!is_spectral_v<Spectrum> || !m_bake ||
+            dr::grad_enabled(m_distr.nodes(), m_distr.pdf()))
+            return;
+
+        FloatStorage nodes_buf = m_distr.nodes(), values_buf = m_distr.pdf();
+        if constexpr (dr::is_jit_v<Float>) {
+            nodes_buf  = dr::migrate(nodes_buf, AllocType::Host);
+            values_buf = dr::migrate(values_buf, AllocType::Host);
+            dr::sync_thread();
+        }
+
+        const ScalarFloat *nodes = nodes_buf.data(), *values = values_buf.data();
+        size_t size = m_distr.size();
+
+        ScalarVector2f range = m_distr.range();
+        ScalarFloat width = range.y() - range.x(), max_value = 0.f;
+        for (size_t k = 0; k < size; ++k)
+            max_value = dr::maximum(max_value, dr::abs(values[k]));
+
+        size_t intervals = dr::minimum(
+            (size_t) dr::maximum(dr::ceil(width / m_bake_resolution), 1.f),
+            MaxBakeIntervals);
+
+        std::vector<ScalarFloat> lut;
+        while (true) {
+            lut.resize(intervals + 1);
+            for (size_t i = 0, j = 0; i <= intervals; ++i) {
+                ScalarFloat x = range.x() + width * i / intervals;
+                while (j + 2 < size && nodes[j + 1] < x)
+                    ++j;
+                ScalarFloat t = (x - nodes[j]) / (nodes[j + 1] - nodes[j]);
+                lut[i] = dr::lerp(values[j], values[j + 1], dr::clamp(t, 0.f, 1.f));
+            }
+
+            ScalarFloat error = 0.f, scale = intervals / width;
+            for (size_t k = 0; k < size; ++k) {
+                ScalarFloat x = (nodes[k] - range.x()) * scale;
+                size_t i = dr::minimum((size_t) x, intervals - 1);
+                error = dr::maximum(
+                    error, dr::abs(dr::lerp(lut[i], lut[i + 1], x - i) - values[k]));
+            }
+
+            if (error <= m_bake_tolerance * max_value)
+                break;
+
+            if (intervals >= MaxBakeIntervals) {
+                Log(Warn, "IrregularSpectrum: could not bake the spectrum into a "
+                          "lookup table within the requested tolerance (error = "
+                          "%g), evaluating it directly instead.", error);
+                return;
+            }
+
+            // The initial count need not be a power of two
+            intervals = dr::minimum(intervals * 2, MaxBakeIntervals);
+        }
+
+        m_lut = ContinuousDistribution<Wavelength>(range, lut.data(), lut.size());
+    }
+
+private:
+    static constexpr size_t MaxBakeIntervals = 1 << 16;
+
     IrregularContinuousDistribution<Wavelength> m_distr;
+
+    /// Optional regular resampling of \c m_distr used for evaluation
+    ContinuousDistribution<Wavelength> m_lut;
+    bool m_bake;
+    ScalarFloat m_bake_resolution;
+    ScalarFloat m_bake_tolerance;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(IrregularSpectrum, Texture)
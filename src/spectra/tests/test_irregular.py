@@ -41,3 +41,32 @@ def test02_sample_spectrum(variant_scalar_spectral, obj):
         obj.sample_spectrum(si, .5),
         [576.777, 212.5]
     )
+
+
+def test03_bake(variants_all_spectral):
+    d = {
+        "type" : "irregular",
+        "wavelengths" : "400, 432.7, 500.1, 501, 650, 700",
+        "values" : "1, 2.5, .5, 3, .25, 1"
+    }
+    ref = mi.load_dict(d)
+    d['bake'] = True
+    obj = mi.load_dict(d)
+    assert 'lut_size' in str(obj)
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 1000)
+    si.wavelengths = dr.linspace(mi.Float, 350, 750, 1000)
+    assert dr.allclose(obj.eval(si), ref.eval(si), atol=3e-3)
+    assert dr.allclose(obj.pdf_spectrum(si), ref.pdf_spectrum(si), rtol=1e-2, atol=1e-5)
+
+    # The lookup table is rebuilt when the parameters change
+    params = mi.traverse(obj)
+    params['values'] = [2, 5, 1, 6, .5, 2]
+    params.update()
+    assert dr.allclose(obj.eval(si), 2 * ref.eval(si), atol=6e-3)
+
+    # Baking is bypassed while differentiating the values
+    if dr.is_diff_v(mi.Float):
+        dr.enable_grad(params['values'])
+        params.update()
+        assert 'lut_size' not in str(obj)